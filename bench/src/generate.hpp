@@ -0,0 +1,171 @@
+#ifndef TATAMI_MTX_BENCH_GENERATE_HPP
+#define TATAMI_MTX_BENCH_GENERATE_HPP
+
+#include "byteme/byteme.hpp"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <memory>
+#include <cstdint>
+
+/*
+ * Deterministic generators for synthetic Matrix Market files.
+ * The same options and seed will always produce the same file.
+ */
+
+enum class Distribution : char { INTEGER, REAL, PATTERN };
+
+enum class Order : char { ROW, COLUMN, SHUFFLED };
+
+struct GenerateOptions {
+    int nrow = 10000;
+    int ncol = 1000;
+    double density = 0.1;
+    Distribution distribution = Distribution::INTEGER;
+    Order order = Order::COLUMN;
+    bool coordinate = true;
+    bool gzip = false;
+    std::uint64_t seed = 42;
+};
+
+struct Generated {
+    unsigned long long bytes = 0;
+    unsigned long long nnz = 0;
+};
+
+class TextSink {
+public:
+    TextSink(const std::string& path, bool gzip) {
+        if (gzip) {
+#if __has_include("zlib.h")
+            my_writer.reset(new byteme::GzipFileWriter(path.c_str(), {}));
+#else
+            throw std::runtime_error("gzip output requires zlib");
+#endif
+        } else {
+            my_writer.reset(new byteme::RawFileWriter(path.c_str(), {}));
+        }
+    }
+
+    void add(const char* ptr, std::size_t n) {
+        my_buffer.insert(my_buffer.end(), ptr, ptr + n);
+        my_bytes += n;
+        if (my_buffer.size() >= 65536) {
+            flush();
+        }
+    }
+
+    void add(const std::string& x) {
+        add(x.data(), x.size());
+    }
+
+    template<typename Number_>
+    void add_number(Number_ x) {
+        char buffer[64];
+        auto res = std::to_chars(buffer, buffer + sizeof(buffer), x);
+        add(buffer, res.ptr - buffer);
+    }
+
+    unsigned long long finish() {
+        flush();
+        my_writer->finish();
+        return my_bytes;
+    }
+
+private:
+    std::unique_ptr<byteme::Writer> my_writer;
+    std::string my_buffer;
+    unsigned long long my_bytes = 0;
+
+    void flush() {
+        my_writer->write(reinterpret_cast<const unsigned char*>(my_buffer.data()), my_buffer.size());
+        my_buffer.clear();
+    }
+};
+
+inline std::string field_name(Distribution distribution) {
+    switch (distribution) {
+        case Distribution::INTEGER: return "integer";
+        case Distribution::REAL: return "real";
+        default: return "pattern";
+    }
+}
+
+inline Generated generate_matrix_market(const std::string& path, const GenerateOptions& options) {
+    std::mt19937_64 rng(options.seed);
+    std::uniform_int_distribution<int> idist(1, 100);
+    std::uniform_real_distribution<double> rdist(0, 1);
+    const unsigned long long NR = options.nrow, NC = options.ncol;
+
+    Generated output;
+    TextSink sink(path, options.gzip);
+    sink.add("%%MatrixMarket matrix " + std::string(options.coordinate ? "coordinate " : "array ") + field_name(options.distribution) + " general\n");
+
+    if (!options.coordinate) {
+        if (options.distribution == Distribution::PATTERN) {
+            throw std::runtime_error("pattern fields are not supported for the array format");
+        }
+
+        sink.add(std::to_string(NR) + " " + std::to_string(NC) + "\n");
+        for (unsigned long long i = 0, end = NR * NC; i < end; ++i) {
+            if (rdist(rng) < options.density) {
+                if (options.distribution == Distribution::INTEGER) {
+                    sink.add_number(idist(rng));
+                } else {
+                    sink.add_number(rdist(rng));
+                }
+                ++output.nnz;
+            } else {
+                sink.add("0", 1);
+            }
+            sink.add("\n", 1);
+        }
+
+        output.bytes = sink.finish();
+        return output;
+    }
+
+    // Sampling the positions of the non-zero elements by skipping geometrically distributed gaps.
+    // Positions are generated in row-major order for ROW and column-major order otherwise.
+    const bool by_row = (options.order == Order::ROW);
+    const unsigned long long secondary = (by_row ? NC : NR), total = NR * NC;
+    std::vector<unsigned long long> positions;
+    if (options.density > 0) {
+        std::geometric_distribution<unsigned long long> gap(std::min(options.density, 1.0));
+        unsigned long long current = gap(rng);
+        while (current < total) {
+            positions.push_back(current);
+            current += gap(rng) + 1;
+        }
+    }
+
+    if (options.order == Order::SHUFFLED) {
+        std::shuffle(positions.begin(), positions.end(), rng);
+    }
+
+    output.nnz = positions.size();
+    sink.add(std::to_string(NR) + " " + std::to_string(NC) + " " + std::to_string(output.nnz) + "\n");
+    for (auto pos : positions) {
+        const auto p = pos / secondary, s = pos % secondary;
+        sink.add_number((by_row ? p : s) + 1);
+        sink.add(" ", 1);
+        sink.add_number((by_row ? s : p) + 1);
+        if (options.distribution == Distribution::INTEGER) {
+            sink.add(" ", 1);
+            sink.add_number(idist(rng));
+        } else if (options.distribution == Distribution::REAL) {
+            sink.add(" ", 1);
+            sink.add_number(rdist(rng));
+        }
+        sink.add("\n", 1);
+    }
+
+    output.bytes = sink.finish();
+    return output;
+}
+
+#endif
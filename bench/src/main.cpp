@@ -0,0 +1,297 @@
+#include "tatami_mtx/tatami_mtx.hpp"
+
+#include "generate.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <filesystem>
+
+/*
+ * Benchmarks for load_matrix() and write_matrix() on synthetic Matrix Market files.
+ * Results are printed to stdout as JSON, with one entry per combination of parameters.
+ *
+ * Usage: tatami_mtx_bench [--name value]...
+ * See parse_arguments() for the available options; lists are comma-separated.
+ */
+
+struct BenchOptions {
+    GenerateOptions generate;
+    int repeats = 3;
+    std::vector<int> threads { 1, 2, 4 };
+    std::vector<std::size_t> buffer_sizes { 65536, 1048576 };
+    bool load = true;
+    bool write = true;
+    std::string directory = std::filesystem::temp_directory_path().string();
+};
+
+template<typename Type_>
+std::vector<Type_> parse_list(const std::string& value) {
+    std::vector<Type_> output;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::stringstream converter(item);
+        Type_ x;
+        if (!(converter >> x)) {
+            throw std::runtime_error("failed to parse list element '" + item + "'");
+        }
+        output.push_back(x);
+    }
+    return output;
+}
+
+inline BenchOptions parse_arguments(int argc, char** argv) {
+    BenchOptions options;
+    auto& gen = options.generate;
+
+    std::map<std::string, std::function<void(const std::string&)> > handlers {
+        { "--nrow", [&](const std::string& x) { gen.nrow = std::stoi(x); } },
+        { "--ncol", [&](const std::string& x) { gen.ncol = std::stoi(x); } },
+        { "--density", [&](const std::string& x) { gen.density = std::stod(x); } },
+        { "--seed", [&](const std::string& x) { gen.seed = std::stoull(x); } },
+        { "--field", [&](const std::string& x) {
+            if (x == "integer") {
+                gen.distribution = Distribution::INTEGER;
+            } else if (x == "real") {
+                gen.distribution = Distribution::REAL;
+            } else if (x == "pattern") {
+                gen.distribution = Distribution::PATTERN;
+            } else {
+                throw std::runtime_error("unknown field '" + x + "'");
+            }
+        } },
+        { "--order", [&](const std::string& x) {
+            if (x == "row") {
+                gen.order = Order::ROW;
+            } else if (x == "column") {
+                gen.order = Order::COLUMN;
+            } else if (x == "shuffled") {
+                gen.order = Order::SHUFFLED;
+            } else {
+                throw std::runtime_error("unknown order '" + x + "'");
+            }
+        } },
+        { "--format", [&](const std::string& x) {
+            if (x != "coordinate" && x != "array") {
+                throw std::runtime_error("unknown format '" + x + "'");
+            }
+            gen.coordinate = (x == "coordinate");
+        } },
+        { "--gzip", [&](const std::string& x) { gen.gzip = (x == "true" || x == "1"); } },
+        { "--repeats", [&](const std::string& x) { options.repeats = std::max(1, std::stoi(x)); } },
+        { "--threads", [&](const std::string& x) { options.threads = parse_list<int>(x); } },
+        { "--buffer-sizes", [&](const std::string& x) { options.buffer_sizes = parse_list<std::size_t>(x); } },
+        { "--load", [&](const std::string& x) { options.load = (x == "true" || x == "1"); } },
+        { "--write", [&](const std::string& x) { options.write = (x == "true" || x == "1"); } },
+        { "--directory", [&](const std::string& x) { options.directory = x; } }
+    };
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string name(argv[i]);
+        auto it = handlers.find(name);
+        if (it == handlers.end()) {
+            throw std::runtime_error("unknown option '" + name + "'");
+        }
+        if (i + 1 >= argc) {
+            throw std::runtime_error("no value supplied for option '" + name + "'");
+        }
+        (it->second)(argv[i + 1]);
+    }
+
+    return options;
+}
+
+/*
+ * Minimal JSON output, as all keys and string values are known to be free of special characters.
+ */
+class JsonObject {
+public:
+    JsonObject& add(const std::string& key, const std::string& value) {
+        return add_raw(key, "\"" + value + "\"");
+    }
+
+    JsonObject& add(const std::string& key, bool value) {
+        return add_raw(key, value ? "true" : "false");
+    }
+
+    template<typename Number_>
+    JsonObject& add(const std::string& key, Number_ value) {
+        std::ostringstream stream;
+        stream.precision(9);
+        stream << value;
+        return add_raw(key, stream.str());
+    }
+
+    JsonObject& add_raw(const std::string& key, const std::string& value) {
+        my_contents += (my_contents.empty() ? "" : ", ");
+        my_contents += "\"" + key + "\": " + value;
+        return *this;
+    }
+
+    std::string str() const {
+        return "{ " + my_contents + " }";
+    }
+
+private:
+    std::string my_contents;
+};
+
+// Returns the fastest of the repeated runs, in seconds.
+template<class Function_>
+double time_fastest(int repeats, Function_ fun) {
+    double best = 0;
+    for (int r = 0; r < repeats; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        fun();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+inline void add_rates(JsonObject& result, double seconds, unsigned long long bytes, unsigned long long nnz) {
+    result.add("seconds", seconds);
+    result.add("mb_per_sec", seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+    result.add("nnz_per_sec", seconds > 0 ? nnz / seconds : 0.0);
+}
+
+template<typename StoredValue_, typename StoredIndex_>
+void bench_load(const std::string& path, const Generated& generated, const BenchOptions& options, const std::string& stored, std::vector<std::string>& results) {
+    for (auto nthreads : options.threads) {
+        for (auto bufsize : options.buffer_sizes) {
+            for (bool row : { true, false }) {
+                tatami_mtx::LoadStatistics stats;
+                tatami_mtx::LoadMatrixOptions lopt;
+                lopt.num_threads = nthreads;
+                lopt.compress_threads = nthreads;
+                lopt.buffer_size = bufsize;
+                lopt.row = row;
+                lopt.statistics = &stats;
+
+                const double seconds = time_fastest(options.repeats, [&]() -> void {
+                    tatami_mtx::load_matrix_from_some_file<double, int, StoredValue_, StoredIndex_>(path.c_str(), lopt);
+                });
+
+                JsonObject result;
+                result.add("benchmark", std::string("load"));
+                result.add("num_threads", nthreads);
+                result.add("buffer_size", bufsize);
+                result.add("row", row);
+                result.add("stored", stored);
+                add_rates(result, seconds, generated.bytes, generated.nnz);
+
+                // Phase breakdown from the last run.
+                result.add("preamble_time", stats.preamble_time);
+                result.add("read_time", stats.read_time);
+                result.add("parse_time", stats.parse_time);
+                result.add("compress_time", stats.compress_time);
+                result.add("construct_time", stats.construct_time);
+                result.add("temporary_bytes", stats.value_bytes + stats.primary_bytes + stats.secondary_bytes + stats.pointer_bytes);
+                results.push_back(result.str());
+            }
+        }
+    }
+}
+
+inline void bench_write(const std::string& path, const BenchOptions& options, std::vector<std::string>& results) {
+    tatami_mtx::LoadMatrixOptions lopt;
+    lopt.row = false;
+    auto mat = tatami_mtx::load_matrix_from_some_file<double, int>(path.c_str(), lopt);
+    const auto output = options.directory + "/tatami_mtx_bench_output";
+
+    std::vector<bool> compressions { false };
+#if __has_include("zlib.h")
+    compressions.push_back(true);
+#endif
+
+    for (auto nthreads : options.threads) {
+        for (bool by_row : { true, false }) {
+            for (bool gzip : compressions) {
+                tatami_mtx::WriteStatistics stats;
+                tatami_mtx::WriteMatrixOptions wopt;
+                wopt.coordinate = options.generate.coordinate;
+                wopt.by_row = by_row;
+                wopt.num_threads = nthreads;
+                wopt.compression_threads = nthreads;
+                wopt.statistics = &stats;
+
+                const double seconds = time_fastest(options.repeats, [&]() -> void {
+#if __has_include("zlib.h")
+                    if (gzip) {
+                        tatami_mtx::write_matrix_to_gzip_file(*mat, output.c_str(), wopt);
+                        return;
+                    }
+#endif
+                    tatami_mtx::write_matrix_to_text_file(*mat, output.c_str(), wopt);
+                });
+
+                JsonObject result;
+                result.add("benchmark", std::string("write"));
+                result.add("num_threads", nthreads);
+                result.add("by_row", by_row);
+                result.add("gzip", gzip);
+                result.add("coordinate", *(wopt.coordinate));
+                add_rates(result, seconds, stats.bytes_written, stats.lines_written);
+                result.add("count_time", stats.count_time);
+                results.push_back(result.str());
+            }
+        }
+    }
+
+    std::remove(output.c_str());
+}
+
+int main(int argc, char** argv) {
+    try {
+        const auto options = parse_arguments(argc, argv);
+        const auto& gen = options.generate;
+        const auto path = options.directory + "/tatami_mtx_bench_input.mtx" + (gen.gzip ? ".gz" : "");
+        const auto generated = generate_matrix_market(path, gen);
+
+        std::vector<std::string> results;
+        if (options.load) {
+            bench_load<tatami_mtx::Automatic, tatami_mtx::Automatic>(path, generated, options, "automatic", results);
+            bench_load<double, std::uint32_t>(path, generated, options, "double/uint32", results);
+        }
+        if (options.write) {
+            bench_write(path, options, results);
+        }
+        std::remove(path.c_str());
+
+        JsonObject input;
+        input.add("nrow", gen.nrow);
+        input.add("ncol", gen.ncol);
+        input.add("density", gen.density);
+        input.add("field", field_name(gen.distribution));
+        input.add("order", std::string(gen.order == Order::ROW ? "row" : (gen.order == Order::COLUMN ? "column" : "shuffled")));
+        input.add("coordinate", gen.coordinate);
+        input.add("gzip", gen.gzip);
+        input.add("seed", gen.seed);
+        input.add("bytes", generated.bytes);
+        input.add("nnz", generated.nnz);
+        input.add("repeats", options.repeats);
+
+        std::cout << "{\n  \"input\": " << input.str() << ",\n  \"results\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            std::cout << "    " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        std::cout << "  ]\n}" << std::endl;
+
+    } catch (std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,279 @@
+#ifndef TATAMI_MTX_BINARY_FORMAT_HPP
+#define TATAMI_MTX_BINARY_FORMAT_HPP
+
+#include "sanisizer/sanisizer.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+#include "utils.hpp"
+
+/**
+ * @file binary_format.hpp
+ * @brief Definition of the binary container format for sparse matrices.
+ *
+ * The binary container holds a compressed sparse matrix in a form that can be loaded without any text parsing.
+ * It consists of a 64-byte header, followed by the pointer, index and value arrays of the compressed sparse representation.
+ * All multi-byte values are stored in little-endian byte order.
+ *
+ * The header contains:
+ *
+ * - An 8-byte magic string, `TMTXBIN` followed by a null terminator.
+ * - A 32-bit unsigned integer specifying the format version.
+ * - A byte specifying the orientation, i.e., 1 for compressed sparse row and 0 for compressed sparse column.
+ * - A byte specifying the `BinaryDataType` of the values.
+ * - A byte specifying the `BinaryDataType` of the indices.
+ * - A byte specifying whether the arrays are compressed (1) or not (0).
+ * - 64-bit unsigned integers specifying the number of rows, the number of columns, the number of structural non-zero elements and the compression block size.
+ * - Zero padding up to 64 bytes.
+ *
+ * The pointer array always contains 64-bit unsigned integers, with length equal to the number of rows (for row orientation) or columns plus 1.
+ * For uncompressed files, each array is zero-padded to a multiple of 8 bytes so that all arrays are suitably aligned for memory mapping.
+ * For compressed files, each array is split into blocks of the specified block size (in uncompressed bytes),
+ * where each block is stored as a 64-bit unsigned integer containing the compressed size followed by the Zlib-compressed bytes.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * Data types for the values and indices in the binary container.
+ */
+enum class BinaryDataType : std::uint8_t { INT8, UINT8, INT16, UINT16, INT32, UINT32, INT64, UINT64, FLOAT32, FLOAT64 };
+
+/**
+ * @brief Header of the binary container.
+ */
+struct BinaryMatrixHeader {
+    /**
+     * Version of the format.
+     */
+    std::uint32_t version = 1;
+
+    /**
+     * Whether the matrix is stored in the compressed sparse row format.
+     * If false, the compressed sparse column format is used.
+     */
+    bool row = false;
+
+    /**
+     * Data type of the values.
+     */
+    BinaryDataType value_type = BinaryDataType::FLOAT64;
+
+    /**
+     * Data type of the indices.
+     */
+    BinaryDataType index_type = BinaryDataType::INT32;
+
+    /**
+     * Whether the arrays are compressed in blocks.
+     */
+    bool compressed = false;
+
+    /**
+     * Number of rows.
+     */
+    unsigned long long nrow = 0;
+
+    /**
+     * Number of columns.
+     */
+    unsigned long long ncol = 0;
+
+    /**
+     * Number of structural non-zero elements.
+     */
+    unsigned long long nnz = 0;
+
+    /**
+     * Number of uncompressed bytes in each compressed block.
+     * Only used if `compressed = true`.
+     */
+    unsigned long long block_size = 0;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+constexpr std::size_t binary_header_size = 64;
+constexpr char binary_magic[8] = { 'T', 'M', 'T', 'X', 'B', 'I', 'N', '\0' };
+constexpr std::uint32_t binary_version = 1;
+
+template<typename Type_>
+constexpr BinaryDataType binary_type_of() {
+    if constexpr(std::is_floating_point<Type_>::value) {
+        static_assert(sizeof(Type_) == 4 || sizeof(Type_) == 8, "unsupported floating-point type for the binary format");
+        return (sizeof(Type_) == 4 ? BinaryDataType::FLOAT32 : BinaryDataType::FLOAT64);
+    } else {
+        static_assert(std::is_integral<Type_>::value, "unsupported type for the binary format");
+        constexpr bool is_signed = std::is_signed<Type_>::value;
+        if constexpr(sizeof(Type_) == 1) {
+            return (is_signed ? BinaryDataType::INT8 : BinaryDataType::UINT8);
+        } else if constexpr(sizeof(Type_) == 2) {
+            return (is_signed ? BinaryDataType::INT16 : BinaryDataType::UINT16);
+        } else if constexpr(sizeof(Type_) == 4) {
+            return (is_signed ? BinaryDataType::INT32 : BinaryDataType::UINT32);
+        } else {
+            static_assert(sizeof(Type_) == 8, "unsupported integer type for the binary format");
+            return (is_signed ? BinaryDataType::INT64 : BinaryDataType::UINT64);
+        }
+    }
+}
+
+// Calls 'fun' with a null pointer of the type corresponding to 'type'.
+template<class Function_>
+void visit_binary_type(const BinaryDataType type, Function_ fun) {
+    switch (type) {
+        case BinaryDataType::INT8: fun(static_cast<std::int8_t*>(NULL)); break;
+        case BinaryDataType::UINT8: fun(static_cast<std::uint8_t*>(NULL)); break;
+        case BinaryDataType::INT16: fun(static_cast<std::int16_t*>(NULL)); break;
+        case BinaryDataType::UINT16: fun(static_cast<std::uint16_t*>(NULL)); break;
+        case BinaryDataType::INT32: fun(static_cast<std::int32_t*>(NULL)); break;
+        case BinaryDataType::UINT32: fun(static_cast<std::uint32_t*>(NULL)); break;
+        case BinaryDataType::INT64: fun(static_cast<std::int64_t*>(NULL)); break;
+        case BinaryDataType::UINT64: fun(static_cast<std::uint64_t*>(NULL)); break;
+        case BinaryDataType::FLOAT32: fun(static_cast<float*>(NULL)); break;
+        case BinaryDataType::FLOAT64: fun(static_cast<double*>(NULL)); break;
+        default: throw std::runtime_error("unknown data type in the binary matrix header");
+    }
+}
+
+inline std::size_t binary_type_size(const BinaryDataType type) {
+    std::size_t output = 0;
+    visit_binary_type(type, [&](auto ptr) -> void {
+        output = sizeof(*ptr);
+    });
+    return output;
+}
+
+inline bool is_little_endian() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+template<typename Type_>
+void swap_bytes(Type_* ptr, const std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        auto bytes = reinterpret_cast<unsigned char*>(ptr + i);
+        std::reverse(bytes, bytes + sizeof(Type_));
+    }
+}
+
+inline void encode_uint64(unsigned long long x, unsigned char* output) {
+    for (int i = 0; i < 8; ++i) {
+        output[i] = (x >> (8 * i)) & 0xff;
+    }
+}
+
+inline unsigned long long decode_uint64(const unsigned char* input) {
+    unsigned long long x = 0;
+    for (int i = 0; i < 8; ++i) {
+        x |= static_cast<unsigned long long>(input[i]) << (8 * i);
+    }
+    return x;
+}
+
+inline void serialize_binary_header(const BinaryMatrixHeader& header, unsigned char* output) {
+    std::fill_n(output, binary_header_size, 0);
+    std::memcpy(output, binary_magic, sizeof(binary_magic));
+    for (int i = 0; i < 4; ++i) {
+        output[8 + i] = (header.version >> (8 * i)) & 0xff;
+    }
+    output[12] = header.row;
+    output[13] = static_cast<unsigned char>(header.value_type);
+    output[14] = static_cast<unsigned char>(header.index_type);
+    output[15] = header.compressed;
+    encode_uint64(header.nrow, output + 16);
+    encode_uint64(header.ncol, output + 24);
+    encode_uint64(header.nnz, output + 32);
+    encode_uint64(header.block_size, output + 40);
+}
+
+inline BinaryMatrixHeader parse_binary_header(const unsigned char* input) {
+    if (std::memcmp(input, binary_magic, sizeof(binary_magic)) != 0) {
+        throw std::runtime_error("unrecognized magic string in the binary matrix header");
+    }
+
+    BinaryMatrixHeader header;
+    header.version = 0;
+    for (int i = 0; i < 4; ++i) {
+        header.version |= static_cast<std::uint32_t>(input[8 + i]) << (8 * i);
+    }
+    if (header.version != binary_version) {
+        throw std::runtime_error("unsupported version of the binary matrix format");
+    }
+
+    header.row = input[12];
+    header.value_type = static_cast<BinaryDataType>(input[13]);
+    header.index_type = static_cast<BinaryDataType>(input[14]);
+    if (binary_type_size(header.index_type) == 0 || header.index_type == BinaryDataType::FLOAT32 || header.index_type == BinaryDataType::FLOAT64) {
+        throw std::runtime_error("indices in the binary matrix should be integers");
+    }
+    binary_type_size(header.value_type); // throws if the type is unknown.
+
+    header.compressed = input[15];
+    header.nrow = decode_uint64(input + 16);
+    header.ncol = decode_uint64(input + 24);
+    header.nnz = decode_uint64(input + 32);
+    header.block_size = decode_uint64(input + 40);
+    if (header.compressed && header.block_size == 0) {
+        throw std::runtime_error("block size should be positive for compressed binary matrices");
+    }
+    return header;
+}
+
+inline unsigned long long pad_to_alignment(const unsigned long long offset) {
+    return sanisizer::sum<unsigned long long>(offset, (8 - offset % 8) % 8);
+}
+
+// Byte offsets of the arrays in an uncompressed file, along with the total file size.
+struct BinaryOffsets {
+    unsigned long long pointers, indices, values, end;
+};
+
+inline BinaryOffsets compute_binary_offsets(const BinaryMatrixHeader& header) {
+    BinaryOffsets output;
+    output.pointers = binary_header_size;
+    const auto num_pointers = sanisizer::sum<unsigned long long>(header.row ? header.nrow : header.ncol, 1);
+    output.indices = pad_to_alignment(sanisizer::sum<unsigned long long>(output.pointers, sanisizer::product<unsigned long long>(num_pointers, 8)));
+    output.values = pad_to_alignment(sanisizer::sum<unsigned long long>(output.indices, sanisizer::product<unsigned long long>(header.nnz, binary_type_size(header.index_type))));
+    output.end = pad_to_alignment(sanisizer::sum<unsigned long long>(output.values, sanisizer::product<unsigned long long>(header.nnz, binary_type_size(header.value_type))));
+    return output;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Read the header of a binary matrix file, e.g., to determine its dimensions and data types before loading.
+ *
+ * @param filepath Path to a binary matrix file, created by `write_binary_matrix()`.
+ * @return The file header.
+ */
+inline BinaryMatrixHeader read_binary_matrix_header(const char* filepath) {
+    std::ifstream input(filepath, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("failed to open the binary matrix file at '" + std::string(filepath) + "'");
+    }
+    unsigned char buffer[internal::binary_header_size];
+    if (!input.read(reinterpret_cast<char*>(buffer), internal::binary_header_size)) {
+        throw std::runtime_error("binary matrix file is too small to contain a header");
+    }
+    return internal::parse_binary_header(buffer);
+}
+
+}
+
+#endif
@@ -0,0 +1,649 @@
+#ifndef TATAMI_MTX_DELTA_VARINT_SPARSE_MATRIX_HPP
+#define TATAMI_MTX_DELTA_VARINT_SPARSE_MATRIX_HPP
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+#include "utils.hpp"
+
+/**
+ * @file delta_varint_sparse_matrix.hpp
+ * @brief Compressed sparse matrix with delta-encoded variable-length indices.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Delta-encoded variable-length indices for a compressed sparse matrix.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * Within each primary slice (i.e., row for compressed sparse row matrices, column otherwise), the secondary indices are sorted,
+ * so the gaps between consecutive indices are usually small.
+ * Each gap is stored as a byte-aligned variable-length integer where the lower 7 bits of each byte contain data and the high bit indicates whether more bytes follow.
+ * Small gaps are thus stored in a single byte, regardless of the size of the index type.
+ *
+ * To support random access within a slice, every `skip_interval`-th element is the start of a group for which a skip pointer is stored.
+ * Each skip pointer records the last index of the preceding group and the byte offset at the start of the group,
+ * such that decoding can start from any group without decoding the preceding elements.
+ */
+template<typename Index_>
+struct DeltaVarintIndices {
+    /**
+     * Concatenated variable-length gaps for all slices.
+     */
+    std::vector<unsigned char> bytes;
+
+    /**
+     * Offsets of the start of each slice in `bytes`, of length equal to the number of slices plus 1.
+     */
+    std::vector<std::size_t> byte_pointers;
+
+    /**
+     * Offsets of the start of each slice in the value array, of length equal to the number of slices plus 1.
+     */
+    std::vector<std::size_t> pointers;
+
+    /**
+     * Number of elements in each group.
+     */
+    std::size_t skip_interval = 64;
+
+    /**
+     * For each group (except the first in each slice), the last index in the preceding group.
+     */
+    std::vector<Index_> skip_bases;
+
+    /**
+     * For each group (except the first in each slice), the offset of the start of the group in `bytes`.
+     */
+    std::vector<std::size_t> skip_offsets;
+
+    /**
+     * Offsets of the start of each slice's groups in `skip_bases` and `skip_offsets`, of length equal to the number of slices plus 1.
+     */
+    std::vector<std::size_t> skip_pointers;
+};
+
+/**
+ * Encode the indices of a compressed sparse matrix with delta encoding and variable-length integers.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ * @tparam Pointers_ Random-access container of pointers.
+ * @tparam Indices_ Random-access container of indices.
+ *
+ * @param num_primary Number of primary slices.
+ * @param pointers Offsets of the start of each slice in `indices`, of length equal to `num_primary + 1`.
+ * @param indices Secondary indices for each slice, which should be sorted within each slice.
+ * Repeated indices are allowed and are encoded as zero gaps, consistent with the unchecked `tatami::CompressedSparseMatrix` created by `load_matrix()` for files with duplicate coordinates.
+ * @param skip_interval Number of elements between skip pointers.
+ * Smaller values improve the speed of random access at the cost of memory usage.
+ * This should be positive.
+ *
+ * @return The encoded indices.
+ */
+template<typename Index_, class Pointers_, class Indices_>
+DeltaVarintIndices<Index_> encode_delta_varint_indices(const Index_ num_primary, const Pointers_& pointers, const Indices_& indices, const std::size_t skip_interval = 64) {
+    if (skip_interval == 0) {
+        throw std::runtime_error("skip interval should be positive");
+    }
+
+    DeltaVarintIndices<Index_> output;
+    output.skip_interval = skip_interval;
+    sanisizer::resize(output.byte_pointers, sanisizer::sum<std::size_t>(num_primary, 1));
+    sanisizer::resize(output.pointers, output.byte_pointers.size());
+    sanisizer::resize(output.skip_pointers, output.byte_pointers.size());
+    output.bytes.reserve(indices.size());
+
+    for (Index_ p = 0; p < num_primary; ++p) {
+        const std::size_t start = pointers[p], end = pointers[p + 1];
+        Index_ previous = 0;
+        for (std::size_t i = start; i < end; ++i) {
+            const Index_ current = indices[i];
+            if (i > start && current < previous) {
+                throw std::runtime_error("indices should be sorted within each slice");
+            }
+
+            const auto position = i - start;
+            if (position > 0 && position % skip_interval == 0) {
+                output.skip_bases.push_back(previous);
+                output.skip_offsets.push_back(output.bytes.size());
+            }
+
+            unsigned long long gap = current - (i > start ? previous : 0);
+            while (gap >= 128) {
+                output.bytes.push_back(static_cast<unsigned char>((gap & 127) | 128));
+                gap >>= 7;
+            }
+            output.bytes.push_back(static_cast<unsigned char>(gap));
+            previous = current;
+        }
+
+        output.pointers[p + 1] = end;
+        output.byte_pointers[p + 1] = output.bytes.size();
+        output.skip_pointers[p + 1] = output.skip_bases.size();
+    }
+
+    output.bytes.shrink_to_fit();
+    return output;
+}
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline unsigned long long decode_varint(const unsigned char*& ptr) {
+    unsigned long long value = 0;
+    int shift = 0;
+    while (1) {
+        const auto byte = *ptr;
+        ++ptr;
+        value |= static_cast<unsigned long long>(byte & 127) << shift;
+        if (!(byte & 128)) {
+            break;
+        }
+        shift += 7;
+    }
+    return value;
+}
+
+// Position of a decoder within a primary slice, pointing to the element at 'position' with index 'current'.
+template<typename Index_>
+struct DeltaVarintCursor {
+    const unsigned char* next = NULL;
+    std::size_t position = 0;
+    std::size_t end = 0;
+    Index_ current = 0;
+};
+
+template<typename Index_>
+class DeltaVarintDecoder {
+public:
+    DeltaVarintDecoder(const DeltaVarintIndices<Index_>& indices) : my_indices(indices) {}
+
+private:
+    const DeltaVarintIndices<Index_>& my_indices;
+
+public:
+    DeltaVarintCursor<Index_> start(const Index_ p) const {
+        DeltaVarintCursor<Index_> cursor;
+        cursor.next = my_indices.bytes.data() + my_indices.byte_pointers[p];
+        cursor.position = my_indices.pointers[p];
+        cursor.end = my_indices.pointers[p + 1];
+        if (cursor.position < cursor.end) {
+            cursor.current = decode_varint(cursor.next);
+        }
+        return cursor;
+    }
+
+    static void advance(DeltaVarintCursor<Index_>& cursor) {
+        ++cursor.position;
+        if (cursor.position < cursor.end) {
+            cursor.current += decode_varint(cursor.next);
+        }
+    }
+
+    // Moves the cursor to the first element with index no less than 'target', using the skip pointers to jump over groups.
+    // All elements before the cursor should have indices less than 'target', i.e., targets should be increasing between restarts.
+    void seek(const Index_ p, DeltaVarintCursor<Index_>& cursor, const Index_ target) const {
+        if (cursor.position >= cursor.end || cursor.current >= target) {
+            return;
+        }
+
+        const auto slice_start = my_indices.pointers[p];
+        const auto interval = my_indices.skip_interval;
+        const auto skip_start = my_indices.skip_bases.begin() + my_indices.skip_pointers[p];
+        const auto skip_end = my_indices.skip_bases.begin() + my_indices.skip_pointers[p + 1];
+
+        // Only considering groups after the one containing the cursor.
+        const auto current_group = (cursor.position - slice_start) / interval;
+        auto search_start = skip_start + std::min(current_group, static_cast<std::size_t>(skip_end - skip_start));
+        const auto found = std::lower_bound(search_start, skip_end, target);
+        if (found != search_start) {
+            const auto entry = (found - 1) - my_indices.skip_bases.begin();
+            const auto group = (found - 1) - skip_start + 1;
+            cursor.next = my_indices.bytes.data() + my_indices.skip_offsets[entry];
+            cursor.position = slice_start + group * interval;
+            cursor.current = my_indices.skip_bases[entry] + decode_varint(cursor.next);
+        }
+
+        while (cursor.position < cursor.end && cursor.current < target) {
+            advance(cursor);
+        }
+    }
+};
+
+template<typename Index_>
+struct DeltaVarintSelection {
+    bool block = false;
+    Index_ block_start = 0, block_length = 0;
+    tatami::VectorPtr<Index_> indices;
+    Index_ length = 0;
+};
+
+template<bool oracle_, typename Index_>
+class DeltaVarintPredictor {
+public:
+    DeltaVarintPredictor(tatami::MaybeOracle<oracle_, Index_> oracle) : my_oracle(std::move(oracle)) {}
+
+private:
+    tatami::MaybeOracle<oracle_, Index_> my_oracle;
+    tatami::PredictionIndex my_counter = 0;
+
+public:
+    Index_ get(const Index_ i) {
+        if constexpr(oracle_) {
+            return my_oracle->get(my_counter++);
+        } else {
+            return i;
+        }
+    }
+};
+
+template<typename Value_, typename StoredValue_>
+const Value_* copy_values(const StoredValue_* values, const std::size_t n, Value_* buffer) {
+    if constexpr(std::is_same<Value_, StoredValue_>::value) {
+        (void)buffer;
+        return values;
+    } else {
+        std::copy_n(values, n, buffer);
+        return buffer;
+    }
+}
+
+/*
+ * Extraction along the primary dimension, where the indices of each slice are decoded on the fly.
+ * For blocks and index subsets, the skip pointers are used to jump to the first relevant group.
+ */
+template<bool oracle_, bool sparse_, typename Value_, typename Index_, class ValueStorage_>
+class DeltaVarintPrimaryExtractor final : public std::conditional<sparse_, tatami::SparseExtractor<oracle_, Value_, Index_>, tatami::DenseExtractor<oracle_, Value_, Index_> >::type {
+public:
+    DeltaVarintPrimaryExtractor(
+        const DeltaVarintIndices<Index_>& indices,
+        const ValueStorage_& values,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        DeltaVarintSelection<Index_> selection,
+        const tatami::Options& opt
+    ) :
+        my_decoder(indices),
+        my_values(values),
+        my_predictor(std::move(oracle)),
+        my_selection(std::move(selection)),
+        my_extract_value(opt.sparse_extract_value),
+        my_extract_index(opt.sparse_extract_index)
+    {}
+
+private:
+    DeltaVarintDecoder<Index_> my_decoder;
+    const ValueStorage_& my_values;
+    DeltaVarintPredictor<oracle_, Index_> my_predictor;
+    DeltaVarintSelection<Index_> my_selection;
+    bool my_extract_value, my_extract_index;
+
+    // Calls 'store(position, index, k)' for each selected element in slice 'p', where 'k' is the position of the index in the selection.
+    template<class Store_>
+    void scan(const Index_ p, Store_ store) {
+        if (my_selection.indices) {
+            const auto& subset = *(my_selection.indices);
+            auto cursor = my_decoder.start(p);
+            for (Index_ k = 0; k < my_selection.length; ++k) {
+                my_decoder.seek(p, cursor, subset[k]);
+                if (cursor.position >= cursor.end) {
+                    break;
+                }
+                if (cursor.current == subset[k]) {
+                    store(cursor.position, cursor.current, k);
+                }
+            }
+            return;
+        }
+
+        auto cursor = my_decoder.start(p);
+        Index_ offset = 0;
+        Index_ limit;
+        if (my_selection.block) {
+            my_decoder.seek(p, cursor, my_selection.block_start);
+            offset = my_selection.block_start;
+            limit = my_selection.block_start + my_selection.block_length;
+        } else {
+            limit = my_selection.length;
+        }
+        while (cursor.position < cursor.end && cursor.current < limit) {
+            store(cursor.position, cursor.current, cursor.current - offset);
+            DeltaVarintDecoder<Index_>::advance(cursor);
+        }
+    }
+
+public:
+    const Value_* fetch(const Index_ i, Value_* buffer) {
+        static_assert(!sparse_);
+        const Index_ p = my_predictor.get(i);
+        std::fill_n(buffer, my_selection.length, 0);
+        scan(p, [&](const std::size_t position, const Index_, const Index_ k) -> void {
+            buffer[k] = my_values[position];
+        });
+        return buffer;
+    }
+
+    tatami::SparseRange<Value_, Index_> fetch(const Index_ i, Value_* vbuffer, Index_* ibuffer) {
+        static_assert(sparse_);
+        const Index_ p = my_predictor.get(i);
+        tatami::SparseRange<Value_, Index_> output(0, NULL, NULL);
+
+        std::size_t first = 0;
+        bool contiguous = !my_selection.indices;
+        scan(p, [&](const std::size_t position, const Index_ index, const Index_) -> void {
+            if (output.number == 0) {
+                first = position;
+            }
+            if (my_extract_index) {
+                ibuffer[output.number] = index;
+            }
+            if (my_extract_value && !contiguous) {
+                vbuffer[output.number] = my_values[position];
+            }
+            ++output.number;
+        });
+
+        if (my_extract_index) {
+            output.index = ibuffer;
+        }
+        if (my_extract_value) {
+            if (contiguous) {
+                output.value = copy_values(my_values.data() + first, output.number, vbuffer);
+            } else {
+                output.value = vbuffer;
+            }
+        }
+        return output;
+    }
+};
+
+/*
+ * Extraction along the secondary dimension, where each selected primary slice keeps its own cursor.
+ * Cursors are moved forward for increasing requests so that consecutive access does not repeatedly decode each slice from the start.
+ */
+template<bool oracle_, bool sparse_, typename Value_, typename Index_, class ValueStorage_>
+class DeltaVarintSecondaryExtractor final : public std::conditional<sparse_, tatami::SparseExtractor<oracle_, Value_, Index_>, tatami::DenseExtractor<oracle_, Value_, Index_> >::type {
+public:
+    DeltaVarintSecondaryExtractor(
+        const DeltaVarintIndices<Index_>& indices,
+        const ValueStorage_& values,
+        tatami::MaybeOracle<oracle_, Index_> oracle,
+        DeltaVarintSelection<Index_> selection,
+        const tatami::Options& opt
+    ) :
+        my_decoder(indices),
+        my_values(values),
+        my_predictor(std::move(oracle)),
+        my_selection(std::move(selection)),
+        my_extract_value(opt.sparse_extract_value),
+        my_extract_index(opt.sparse_extract_index)
+    {
+        my_cursors.reserve(my_selection.length);
+        for (Index_ k = 0; k < my_selection.length; ++k) {
+            my_cursors.push_back(my_decoder.start(primary(k)));
+        }
+    }
+
+private:
+    DeltaVarintDecoder<Index_> my_decoder;
+    const ValueStorage_& my_values;
+    DeltaVarintPredictor<oracle_, Index_> my_predictor;
+    DeltaVarintSelection<Index_> my_selection;
+    bool my_extract_value, my_extract_index;
+    std::vector<DeltaVarintCursor<Index_> > my_cursors;
+    Index_ my_last = 0;
+
+    Index_ primary(const Index_ k) const {
+        if (my_selection.indices) {
+            return (*my_selection.indices)[k];
+        } else {
+            return my_selection.block_start + k;
+        }
+    }
+
+    template<class Store_>
+    void scan(const Index_ target, Store_ store) {
+        if (target < my_last) {
+            for (Index_ k = 0; k < my_selection.length; ++k) {
+                my_cursors[k] = my_decoder.start(primary(k));
+            }
+        }
+        my_last = target;
+
+        for (Index_ k = 0; k < my_selection.length; ++k) {
+            auto& cursor = my_cursors[k];
+            const auto p = primary(k);
+            my_decoder.seek(p, cursor, target);
+            if (cursor.position < cursor.end && cursor.current == target) {
+                store(cursor.position, p, k);
+            }
+        }
+    }
+
+public:
+    const Value_* fetch(const Index_ i, Value_* buffer) {
+        static_assert(!sparse_);
+        const Index_ target = my_predictor.get(i);
+        std::fill_n(buffer, my_selection.length, 0);
+        scan(target, [&](const std::size_t position, const Index_, const Index_ k) -> void {
+            buffer[k] = my_values[position];
+        });
+        return buffer;
+    }
+
+    tatami::SparseRange<Value_, Index_> fetch(const Index_ i, Value_* vbuffer, Index_* ibuffer) {
+        static_assert(sparse_);
+        const Index_ target = my_predictor.get(i);
+        tatami::SparseRange<Value_, Index_> output(0, NULL, NULL);
+        scan(target, [&](const std::size_t position, const Index_ p, const Index_) -> void {
+            if (my_extract_value) {
+                vbuffer[output.number] = my_values[position];
+            }
+            if (my_extract_index) {
+                ibuffer[output.number] = p;
+            }
+            ++output.number;
+        });
+        if (my_extract_value) {
+            output.value = vbuffer;
+        }
+        if (my_extract_index) {
+            output.index = ibuffer;
+        }
+        return output;
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Compressed sparse matrix with delta-encoded variable-length indices.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Data type of the stored values.
+ * @tparam ValueStorage_ Vector class used to store the values, e.g., a `std::vector` with a custom allocator.
+ * This should have `size()`, `data()` and `operator[]` methods.
+ *
+ * This is similar to a `tatami::CompressedSparseMatrix`, except that the secondary indices are stored in a `DeltaVarintIndices`.
+ * For long slices with small gaps between indices, this typically uses 2-4 times less memory than storing the indices directly,
+ * at the cost of decoding the indices during extraction.
+ * Extraction of blocks or index subsets along the primary dimension uses the skip pointers to avoid decoding the entire slice,
+ * while extraction along the secondary dimension caches the decoding position in each slice to efficiently handle consecutive accesses.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Value_, class ValueStorage_ = std::vector<StoredValue_> >
+class DeltaVarintSparseMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    /**
+     * @param nrow Number of rows.
+     * @param ncol Number of columns.
+     * @param values Values of the structural non-zero elements, ordered by slice and then by index within each slice.
+     * @param indices Encoded indices, typically created by `encode_delta_varint_indices()`.
+     * @param csr Whether the matrix is in the compressed sparse row format.
+     * If false, the compressed sparse column format is assumed.
+     */
+    DeltaVarintSparseMatrix(const Index_ nrow, const Index_ ncol, ValueStorage_ values, DeltaVarintIndices<Index_> indices, const bool csr) :
+        my_nrow(nrow),
+        my_ncol(ncol),
+        my_values(std::move(values)),
+        my_indices(std::move(indices)),
+        my_csr(csr)
+    {
+        const auto num_primary = (my_csr ? my_nrow : my_ncol);
+        if (
+            !sanisizer::is_equal(my_indices.pointers.size(), sanisizer::sum<std::size_t>(num_primary, 1)) ||
+            my_indices.byte_pointers.size() != my_indices.pointers.size() ||
+            my_indices.skip_pointers.size() != my_indices.pointers.size()
+        ) {
+            throw std::runtime_error("length of pointer vectors should be equal to the number of rows/columns plus 1");
+        }
+        if (my_indices.pointers.back() != my_values.size()) {
+            throw std::runtime_error("last pointer should be equal to the number of values");
+        }
+        if (my_indices.skip_bases.size() != my_indices.skip_offsets.size()) {
+            throw std::runtime_error("skip vectors should have the same length");
+        }
+    }
+
+private:
+    Index_ my_nrow, my_ncol;
+    ValueStorage_ my_values;
+    DeltaVarintIndices<Index_> my_indices;
+    bool my_csr;
+
+public:
+    Index_ nrow() const {
+        return my_nrow;
+    }
+
+    Index_ ncol() const {
+        return my_ncol;
+    }
+
+    bool is_sparse() const {
+        return true;
+    }
+
+    double is_sparse_proportion() const {
+        return 1;
+    }
+
+    bool prefer_rows() const {
+        return my_csr;
+    }
+
+    double prefer_rows_proportion() const {
+        return static_cast<double>(my_csr);
+    }
+
+    bool uses_oracle(const bool) const {
+        return false;
+    }
+
+    /**
+     * @return Encoded indices.
+     */
+    const DeltaVarintIndices<Index_>& get_indices() const {
+        return my_indices;
+    }
+
+private:
+    internal::DeltaVarintSelection<Index_> full_selection(const bool row) const {
+        internal::DeltaVarintSelection<Index_> selection;
+        selection.block_length = (row ? my_ncol : my_nrow);
+        selection.length = selection.block_length;
+        return selection;
+    }
+
+    static internal::DeltaVarintSelection<Index_> block_selection(const Index_ block_start, const Index_ block_length) {
+        internal::DeltaVarintSelection<Index_> selection;
+        selection.block = true;
+        selection.block_start = block_start;
+        selection.block_length = block_length;
+        selection.length = block_length;
+        return selection;
+    }
+
+    static internal::DeltaVarintSelection<Index_> index_selection(tatami::VectorPtr<Index_> indices_ptr) {
+        internal::DeltaVarintSelection<Index_> selection;
+        selection.length = indices_ptr->size();
+        selection.indices = std::move(indices_ptr);
+        return selection;
+    }
+
+    template<bool oracle_, bool sparse_>
+    std::unique_ptr<typename std::conditional<sparse_, tatami::SparseExtractor<oracle_, Value_, Index_>, tatami::DenseExtractor<oracle_, Value_, Index_> >::type>
+    populate(const bool row, tatami::MaybeOracle<oracle_, Index_> oracle, internal::DeltaVarintSelection<Index_> selection, const tatami::Options& opt) const {
+        if (row == my_csr) {
+            return std::make_unique<internal::DeltaVarintPrimaryExtractor<oracle_, sparse_, Value_, Index_, ValueStorage_> >(my_indices, my_values, std::move(oracle), std::move(selection), opt);
+        } else {
+            return std::make_unique<internal::DeltaVarintSecondaryExtractor<oracle_, sparse_, Value_, Index_, ValueStorage_> >(my_indices, my_values, std::move(oracle), std::move(selection), opt);
+        }
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(const bool row, const tatami::Options& opt) const {
+        return populate<false, false>(row, false, full_selection(row), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(const bool row, const Index_ block_start, const Index_ block_length, const tatami::Options& opt) const {
+        return populate<false, false>(row, false, block_selection(block_start, block_length), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(const bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return populate<false, false>(row, false, index_selection(std::move(indices_ptr)), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(const bool row, const tatami::Options& opt) const {
+        return populate<false, true>(row, false, full_selection(row), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(const bool row, const Index_ block_start, const Index_ block_length, const tatami::Options& opt) const {
+        return populate<false, true>(row, false, block_selection(block_start, block_length), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(const bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return populate<false, true>(row, false, index_selection(std::move(indices_ptr)), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return populate<true, false>(row, std::move(oracle), full_selection(row), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const Index_ block_start, const Index_ block_length, const tatami::Options& opt) const {
+        return populate<true, false>(row, std::move(oracle), block_selection(block_start, block_length), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return populate<true, false>(row, std::move(oracle), index_selection(std::move(indices_ptr)), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return populate<true, true>(row, std::move(oracle), full_selection(row), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const Index_ block_start, const Index_ block_length, const tatami::Options& opt) const {
+        return populate<true, true>(row, std::move(oracle), block_selection(block_start, block_length), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return populate<true, true>(row, std::move(oracle), index_selection(std::move(indices_ptr)), opt);
+    }
+};
+
+}
+
+#endif
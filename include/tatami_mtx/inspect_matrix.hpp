@@ -0,0 +1,390 @@
+#ifndef TATAMI_MTX_INSPECT_MATRIX_HPP
+#define TATAMI_MTX_INSPECT_MATRIX_HPP
+
+#include "eminem/eminem.hpp"
+#include "byteme/byteme.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "utils.hpp"
+#include "load_matrix.hpp"
+#include "binary_format.hpp"
+
+/**
+ * @file inspect_matrix.hpp
+ * @brief Inspect the header of a Matrix Market file without loading its contents.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Details of a Matrix Market file, as reported by `inspect_matrix()`.
+ */
+struct MatrixInspection {
+    /**
+     * Format of the file, i.e., coordinate or array.
+     */
+    eminem::Format format = eminem::Format::COORDINATE;
+
+    /**
+     * Field of the file, e.g., integer or real.
+     */
+    eminem::Field field = eminem::Field::REAL;
+
+    /**
+     * Symmetry of the file.
+     */
+    eminem::Symmetry symmetry = eminem::Symmetry::GENERAL;
+
+    /**
+     * Number of rows.
+     */
+    unsigned long long nrow = 0;
+
+    /**
+     * Number of columns.
+     */
+    unsigned long long ncol = 0;
+
+    /**
+     * Number of data lines.
+     * For coordinate files, this is the number of lines in the file body, which may be less than the number of non-zero elements for symmetric matrices.
+     * For array files, this is the product of the dimensions.
+     */
+    unsigned long long nlines = 0;
+
+    /**
+     * Type of the values that would be stored in memory by `load_matrix()`.
+     */
+    BinaryDataType value_type = BinaryDataType::FLOAT64;
+
+    /**
+     * Type of the indices that would be stored in memory by `load_matrix()`.
+     * Only used for coordinate files.
+     */
+    BinaryDataType index_type = BinaryDataType::INT32;
+
+    /**
+     * Type of the temporary primary indices that would be used by `load_matrix()` before compression.
+     * Only used for coordinate files.
+     */
+    BinaryDataType temporary_index_type = BinaryDataType::UINT32;
+
+    /**
+     * Number of bytes in the triplet vectors that are allocated by `load_matrix()` while parsing a coordinate file.
+     * This is zero for array files.
+     */
+    unsigned long long triplet_bytes = 0;
+
+    /**
+     * Number of bytes in the pointer vector (`indptr`) of the compressed sparse matrix.
+     * If `LoadMatrixOptions::tiled = true`, this is instead an upper bound on the total size of the pointers of all tiles, assuming that every tile is non-empty.
+     * This is zero for array files.
+     */
+    unsigned long long pointer_bytes = 0;
+
+    /**
+     * Number of bytes in the final storage of the loaded matrix,
+     * i.e., the values, indices and pointers for sparse matrices or the values for dense matrices.
+     */
+    unsigned long long final_bytes = 0;
+
+    /**
+     * Peak number of bytes allocated by `load_matrix()`.
+     * For coordinate files, this is the sum of `triplet_bytes` and `pointer_bytes`, as the final storage is moved from the triplet vectors.
+     * If `LoadMatrixOptions::compress_threads > 1`, this also includes the sorted copies of the values and secondary indices and the per-thread histograms used by the parallel counting sort.
+     * If `LoadMatrixOptions::first_touch_threads > 1`, this also includes the copy of the largest of the values, indices or pointers, as each array is copied in turn before its original is released.
+     * Note that this does not include any workspace used by `tatami::compress_sparse_triplets()` to sort unordered triplets.
+     *
+     * If `LoadMatrixOptions::tiled = true`, this is instead the sum of `triplet_bytes`, `pointer_bytes`, the per-tile offsets used to bucket the triplets,
+     * and a per-thread workspace that can hold the triplets of one tile, assuming that no coordinates are duplicated within a tile.
+     * For array files, this is equal to `final_bytes`.
+     */
+    unsigned long long peak_bytes = 0;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline BinaryDataType choose_index_type(const unsigned long long extent) {
+    if (extent <= std::numeric_limits<std::uint8_t>::max()) {
+        return BinaryDataType::UINT8;
+    } else if (extent <= std::numeric_limits<std::uint16_t>::max()) {
+        return BinaryDataType::UINT16;
+    } else {
+        return BinaryDataType::UINT32;
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Inspect a Matrix Market file by only parsing its preamble, i.e., the banner and the size line.
+ * This reports the dimensions, the storage types and the memory usage of `load_matrix()` without parsing the body of the file,
+ * e.g., so that loading jobs can be scheduled according to their memory footprint.
+ * The reported types and memory usage assume that the default `tatami::CompressedSparseMatrix` is constructed for coordinate files,
+ * i.e., `LoadMatrixOptions::delta_varint_indices` is ignored.
+ *
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param reader A `byteme::Reader` instance containing bytes from a Matrix Market file.
+ * @param options Options for loading the matrix.
+ * Only `LoadMatrixOptions::row`, `LoadMatrixOptions::buffer_size`, `LoadMatrixOptions::num_threads`, `LoadMatrixOptions::compress_threads`, `LoadMatrixOptions::first_touch_threads`,
+ * `LoadMatrixOptions::tiled`, `LoadMatrixOptions::tile_nrow` and `LoadMatrixOptions::tile_ncol` are used.
+ *
+ * @return Details of the file.
+ */
+template<typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+MatrixInspection inspect_matrix(byteme::Reader& reader, const LoadMatrixOptions& options) {
+    eminem::Parser<byteme::Reader*, Index_> parser(&reader, [&]{
+        eminem::ParserOptions eopt;
+        eopt.buffer_size = options.buffer_size;
+        return eopt;
+    }());
+    parser.scan_preamble();
+
+    MatrixInspection output;
+    const auto& banner = parser.get_banner();
+    output.format = banner.format;
+    output.field = banner.field;
+    output.symmetry = banner.symmetry;
+    output.nrow = parser.get_nrows();
+    output.ncol = parser.get_ncols();
+    output.nlines = parser.get_nlines();
+
+    const bool coordinate = (output.format == eminem::Format::COORDINATE);
+    if constexpr(std::is_same<StoredValue_, Automatic>::value) {
+        if (output.field == eminem::Field::REAL || output.field == eminem::Field::DOUBLE) {
+            output.value_type = BinaryDataType::FLOAT64;
+        } else if (output.field == eminem::Field::INTEGER || (coordinate && output.field == eminem::Field::PATTERN)) {
+            output.value_type = internal::binary_type_of<int>();
+        } else {
+            throw std::runtime_error("unsupported Matrix Market field type");
+        }
+    } else {
+        output.value_type = internal::binary_type_of<StoredValue_>();
+    }
+    const auto value_size = internal::binary_type_size(output.value_type);
+
+    if (!coordinate) {
+        output.final_bytes = sanisizer::product<unsigned long long>(sanisizer::product<unsigned long long>(output.nrow, output.ncol), value_size);
+        output.peak_bytes = output.final_bytes;
+        return output;
+    }
+
+    const auto num_primary = (options.row ? output.nrow : output.ncol);
+    const auto num_secondary = (options.row ? output.ncol : output.nrow);
+    output.temporary_index_type = internal::choose_index_type(num_primary);
+    if constexpr(std::is_same<StoredIndex_, Automatic>::value) {
+        output.index_type = internal::choose_index_type(num_secondary);
+    } else {
+        output.index_type = internal::binary_type_of<StoredIndex_>();
+    }
+
+    // Mirroring the reservation in load_matrix(), where symmetric matrices store each off-diagonal element twice.
+    const bool mirror = (output.symmetry == eminem::Symmetry::SYMMETRIC || output.symmetry == eminem::Symmetry::SKEW_SYMMETRIC || output.symmetry == eminem::Symmetry::HERMITIAN);
+    const auto reserved = (mirror ? sanisizer::product<unsigned long long>(output.nlines, 2) : output.nlines);
+
+    const auto temp_size = internal::binary_type_size(output.temporary_index_type);
+    const auto index_size = internal::binary_type_size(output.index_type);
+    output.triplet_bytes = sanisizer::product<unsigned long long>(reserved, temp_size + index_size + value_size);
+    const auto value_bytes = sanisizer::product<unsigned long long>(reserved, value_size);
+    const auto index_bytes = sanisizer::product<unsigned long long>(reserved, index_size);
+
+    if (options.tiled) {
+        // Mirroring build_sparse_matrix(), where tiles larger than the matrix are truncated.
+        auto choose_tile = [](const unsigned long long requested, const unsigned long long extent) -> unsigned long long {
+            return std::max<unsigned long long>(std::min(requested, extent), 1);
+        };
+        auto count_tiles = [](const unsigned long long extent, const unsigned long long tile_extent) -> unsigned long long {
+            return (extent == 0 ? 1 : extent / tile_extent + (extent % tile_extent > 0));
+        };
+        const auto tile_nrow = choose_tile(options.tile_nrow, output.nrow), tile_ncol = choose_tile(options.tile_ncol, output.ncol);
+        const auto tile_primary = (options.row ? tile_nrow : tile_ncol), tile_secondary = (options.row ? tile_ncol : tile_nrow);
+        const auto num_tiles = sanisizer::product<unsigned long long>(count_tiles(num_primary, tile_primary), count_tiles(num_secondary, tile_secondary));
+
+        // Each non-empty tile has its own 32-bit pointers, plus the single array of zero pointers shared by the empty tiles.
+        const auto tile_pointer_bytes = sanisizer::product<unsigned long long>(tile_primary + 1, sizeof(std::uint32_t));
+        output.pointer_bytes = sanisizer::product<unsigned long long>(sanisizer::sum<unsigned long long>(num_tiles, 1), tile_pointer_bytes);
+        output.final_bytes = sanisizer::sum<unsigned long long>(sanisizer::sum<unsigned long long>(value_bytes, index_bytes), output.pointer_bytes);
+
+        // Bucketing needs the start and next position of each tile, while each thread sorts one tile at a time in its own workspace.
+        const auto bucket_bytes = sanisizer::product<unsigned long long>(sanisizer::sum<unsigned long long>(num_tiles, 1), 2 * sizeof(std::size_t));
+        const auto num_workers = std::min<unsigned long long>(std::max(options.num_threads, 1), num_tiles);
+        const auto tile_triplets = std::min<unsigned long long>(reserved, sanisizer::product<unsigned long long>(tile_nrow, tile_ncol));
+        const auto worker_bytes = sanisizer::sum<unsigned long long>(
+            sanisizer::product<unsigned long long>(tile_triplets, value_size + index_size + sizeof(Index_)),
+            sanisizer::product<unsigned long long>(tile_nrow + tile_ncol + 2, sizeof(std::size_t))
+        );
+        output.peak_bytes = sanisizer::sum<unsigned long long>(
+            sanisizer::sum<unsigned long long>(output.triplet_bytes, output.pointer_bytes),
+            sanisizer::sum<unsigned long long>(bucket_bytes, sanisizer::product<unsigned long long>(num_workers, worker_bytes))
+        );
+        return output;
+    }
+
+    output.pointer_bytes = sanisizer::product<unsigned long long>(sanisizer::sum<unsigned long long>(num_primary, 1), sizeof(std::size_t));
+    output.final_bytes = sanisizer::sum<unsigned long long>(sanisizer::sum<unsigned long long>(value_bytes, index_bytes), output.pointer_bytes);
+    output.peak_bytes = sanisizer::sum<unsigned long long>(output.triplet_bytes, output.pointer_bytes);
+
+    // The counting sort in parallel_compress_sparse_triplets() holds the sorted copies and the histograms alongside the triplets.
+    if (options.compress_threads > 1) {
+        const auto histogram_bytes = sanisizer::product<unsigned long long>(sanisizer::product<unsigned long long>(options.compress_threads, num_primary), sizeof(std::size_t));
+        const auto sorting_bytes = sanisizer::sum<unsigned long long>(sanisizer::sum<unsigned long long>(value_bytes, index_bytes), histogram_bytes);
+        output.peak_bytes = sanisizer::sum<unsigned long long>(output.peak_bytes, sorting_bytes);
+    }
+
+    // The temporary primary indices are released after compression, and then first_touch_copy() is applied to the values, indices and pointers in turn,
+    // releasing each original before the next copy.
+    if (options.first_touch_threads > 1) {
+        const auto largest_bytes = std::max({ value_bytes, index_bytes, output.pointer_bytes });
+        const auto touch_bytes = sanisizer::sum<unsigned long long>(sanisizer::sum<unsigned long long>(value_bytes, index_bytes), sanisizer::sum<unsigned long long>(output.pointer_bytes, largest_bytes));
+        output.peak_bytes = std::max(output.peak_bytes, touch_bytes);
+    }
+
+    return output;
+}
+
+/**
+ * Inspect an uncompressed Matrix Market file, see `inspect_matrix()` for details.
+ *
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param filepath Path to a Matrix Market file.
+ * @param options Options for loading the matrix.
+ *
+ * @return Details of the file.
+ */
+template<typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+MatrixInspection inspect_matrix_from_text_file(const char* filepath, const LoadMatrixOptions& options) {
+    byteme::RawFileReader reader(filepath, {});
+    return inspect_matrix<Index_, StoredValue_, StoredIndex_>(reader, options);
+}
+
+/**
+ * Inspect a buffer containing an uncompressed Matrix Market file, see `inspect_matrix()` for details.
+ *
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param buffer Array containing the contents of an uncompressed Matrix Market file.
+ * @param n Length of the array.
+ * @param options Options for loading the matrix.
+ *
+ * @return Details of the file.
+ */
+template<typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+MatrixInspection inspect_matrix_from_text_buffer(const unsigned char* buffer, const std::size_t n, const LoadMatrixOptions& options) {
+    byteme::RawBufferReader reader(buffer, n);
+    return inspect_matrix<Index_, StoredValue_, StoredIndex_>(reader, options);
+}
+
+#if __has_include("zlib.h")
+
+/**
+ * Inspect a Gzip-compressed Matrix Market file, see `inspect_matrix()` for details.
+ * Only the start of the file is decompressed.
+ *
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param filepath Path to a Matrix Market file.
+ * @param options Options for loading the matrix.
+ *
+ * @return Details of the file.
+ */
+template<typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+MatrixInspection inspect_matrix_from_gzip_file(const char* filepath, const LoadMatrixOptions& options) {
+    byteme::GzipFileReader reader(filepath, {});
+    return inspect_matrix<Index_, StoredValue_, StoredIndex_>(reader, options);
+}
+
+/**
+ * Inspect a possibly Gzip-compressed Matrix Market file, see `inspect_matrix()` for details.
+ *
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param filepath Path to a Matrix Market file.
+ * @param options Options for loading the matrix.
+ *
+ * @return Details of the file.
+ */
+template<typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+MatrixInspection inspect_matrix_from_some_file(const char* filepath, const LoadMatrixOptions& options) {
+    std::unique_ptr<byteme::Reader> ptr;
+    if (byteme::is_gzip(filepath)) {
+        ptr.reset(new byteme::GzipFileReader(filepath, {}));
+    } else  {
+        ptr.reset(new byteme::RawFileReader(filepath, {}));
+    }
+    return inspect_matrix<Index_, StoredValue_, StoredIndex_>(*ptr, options);
+}
+
+/**
+ * Inspect a buffer containing a Gzip/Zlib-compressed Matrix Market file, see `inspect_matrix()` for details.
+ *
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param buffer Array containing the contents of a Matrix Market file after Gzip/Zlib compression.
+ * @param n Length of the array.
+ * @param options Options for loading the matrix.
+ *
+ * @return Details of the file.
+ */
+template<typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+MatrixInspection inspect_matrix_from_zlib_buffer(const unsigned char* buffer, const std::size_t n, const LoadMatrixOptions& options) {
+    byteme::ZlibBufferReader reader(buffer, n, {});
+    return inspect_matrix<Index_, StoredValue_, StoredIndex_>(reader, options);
+}
+
+/**
+ * Inspect a buffer containing a possibly Gzip/Zlib-compressed Matrix Market file, see `inspect_matrix()` for details.
+ *
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param buffer Array containing the contents of a Matrix Market file, possibly after Gzip/Zlib compression.
+ * @param n Length of the array.
+ * @param options Options for loading the matrix.
+ *
+ * @return Details of the file.
+ */
+template<typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+MatrixInspection inspect_matrix_from_some_buffer(const unsigned char* buffer, const std::size_t n, const LoadMatrixOptions& options) {
+    std::unique_ptr<byteme::Reader> ptr;
+    if (byteme::is_zlib_or_gzip(buffer, n)) {
+        ptr.reset(new byteme::ZlibBufferReader(buffer, n, {}));
+    } else  {
+        ptr.reset(new byteme::RawBufferReader(buffer, n));
+    }
+    return inspect_matrix<Index_, StoredValue_, StoredIndex_>(*ptr, options);
+}
+
+#endif
+
+}
+
+#endif
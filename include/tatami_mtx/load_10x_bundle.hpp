@@ -0,0 +1,312 @@
+#ifndef TATAMI_MTX_LOAD_10X_BUNDLE_HPP
+#define TATAMI_MTX_LOAD_10X_BUNDLE_HPP
+
+#include "tatami/tatami.hpp"
+#include "eminem/eminem.hpp"
+#include "byteme/byteme.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <optional>
+#include <fstream>
+#include <limits>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+#include <initializer_list>
+
+#include "utils.hpp"
+#include "load_matrix.hpp"
+
+/**
+ * @file load_10x_bundle.hpp
+ * @brief Load a 10x Genomics matrix directory.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Options for `load_10x_bundle()`.
+ */
+struct Load10xBundleOptions {
+    /**
+     * Feature types to retain, e.g., `"Gene Expression"`.
+     * Rows for all other features are discarded while the matrix is being parsed, so they are never stored in memory.
+     * If unset, all features are retained.
+     * If set, the features file should contain a third column with the feature types, and the matrix should have general symmetry.
+     */
+    std::optional<std::vector<std::string> > feature_types;
+
+    /**
+     * Number of threads for reading the matrix, feature and barcode files concurrently.
+     * If `feature_types` is set, the feature file must be read before the matrix, so at most 2 threads are used.
+     */
+    int num_threads = 1;
+
+    /**
+     * Options for loading the matrix, see `load_matrix()` for details.
+     * All options are supported, including `LoadMatrixOptions::statistics`.
+     * The reordering options, `LoadMatrixOptions::ordering` and `LoadMatrixOptions::summaries` refer to the rows that remain after filtering by `feature_types`.
+     * If the rows or columns are reordered, the feature annotations and barcodes in `Loaded10xBundle` are reordered to match.
+     */
+    LoadMatrixOptions load;
+};
+
+/**
+ * @brief Contents of a 10x Genomics matrix directory.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ */
+template<typename Value_, typename Index_>
+struct Loaded10xBundle {
+    /**
+     * Sparse matrix where rows are features and columns are cells.
+     */
+    std::shared_ptr<tatami::Matrix<Value_, Index_> > matrix;
+
+    /**
+     * Identifier for each feature (row) of `matrix`, e.g., Ensembl identifiers.
+     */
+    std::vector<std::string> feature_ids;
+
+    /**
+     * Name of each feature (row) of `matrix`, e.g., gene symbols.
+     */
+    std::vector<std::string> feature_names;
+
+    /**
+     * Type of each feature (row) of `matrix`.
+     * This is empty if the features file does not contain a third column, e.g., for the older `genes.tsv` files.
+     */
+    std::vector<std::string> feature_types;
+
+    /**
+     * Barcode for each cell (column) of `matrix`.
+     */
+    std::vector<std::string> barcodes;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline std::string find_10x_file(const std::string& directory, std::initializer_list<const char*> candidates) {
+    for (auto c : candidates) {
+        std::string path = directory + "/" + c;
+        if (std::ifstream(path)) {
+            return path;
+        }
+    }
+    throw std::runtime_error("failed to find '" + std::string(*(candidates.begin())) + "' in '" + directory + "'");
+}
+
+inline std::unique_ptr<byteme::Reader> open_10x_file(const std::string& path) {
+    std::unique_ptr<byteme::Reader> ptr;
+#if __has_include("zlib.h")
+    if (byteme::is_gzip(path.c_str())) {
+        ptr.reset(new byteme::GzipFileReader(path.c_str(), {}));
+        return ptr;
+    }
+#endif
+    ptr.reset(new byteme::RawFileReader(path.c_str(), {}));
+    return ptr;
+}
+
+// Reads a tab-separated file into columns, where the first 'max_columns' fields of each line are retained.
+inline std::vector<std::vector<std::string> > read_10x_table(const std::string& path, const std::size_t max_columns, const std::size_t buffer_size) {
+    auto reader = open_10x_file(path);
+    byteme::SerialBufferedReader<char, byteme::Reader*> pb(reader.get(), buffer_size);
+
+    std::vector<std::vector<std::string> > columns(max_columns);
+    std::size_t num_lines = 0;
+    std::size_t field = 0;
+    std::string current;
+    bool empty_line = true;
+
+    auto add_field = [&]() -> void {
+        if (!current.empty() && current.back() == '\r') {
+            current.pop_back();
+        }
+        if (field < max_columns) {
+            auto& col = columns[field];
+            col.resize(num_lines); // in case the previous line had fewer fields.
+            col.push_back(std::move(current));
+        }
+        current.clear();
+        ++field;
+    };
+
+    bool okay = pb.valid();
+    while (okay) {
+        const char x = pb.get();
+        if (x == '\n') {
+            if (!empty_line) {
+                add_field();
+                ++num_lines;
+            }
+            field = 0;
+            empty_line = true;
+        } else if (x == '\t') {
+            add_field();
+            empty_line = false;
+        } else {
+            current += x;
+            empty_line = false;
+        }
+        okay = pb.advance();
+    }
+    if (!empty_line) {
+        add_field();
+        ++num_lines;
+    }
+
+    for (auto& col : columns) {
+        if (!col.empty()) {
+            col.resize(num_lines);
+        }
+    }
+    return columns;
+}
+
+// The matrix is loaded through the usual load_matrix() machinery, with the remapping used to discard rows while parsing.
+template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, template<typename> class Allocator_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_10x_matrix(const std::string& path, const RowRemapping<Index_>* remapping, const LoadMatrixOptions& options) {
+    auto reader = open_10x_file(path);
+    auto output = load_matrix_remapped<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(*reader, options, remapping);
+    if (!output->is_sparse()) {
+        throw std::runtime_error("10x matrix should be in the coordinate format");
+    }
+    return output;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Load a 10x Genomics matrix directory, typically produced by CellRanger.
+ * This contains a `matrix.mtx` file, a `features.tsv` file (or `genes.tsv` for older versions) and a `barcodes.tsv` file, any of which may be Gzip-compressed with a `.gz` suffix.
+ * The three files are read concurrently, and features can be filtered by type while the matrix is being parsed.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam Allocator_ Allocator for the stored vectors, see `load_matrix()` for details.
+ *
+ * @param directory Path to the directory.
+ * @param options Options for loading the directory.
+ *
+ * @return Contents of the directory, after filtering by feature type.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Value_, typename StoredIndex_ = Index_, template<typename> class Allocator_ = std::allocator>
+Loaded10xBundle<Value_, Index_> load_10x_bundle(const std::string& directory, const Load10xBundleOptions& options) {
+    const auto matrix_path = internal::find_10x_file(directory, { "matrix.mtx.gz", "matrix.mtx" });
+    const auto features_path = internal::find_10x_file(directory, { "features.tsv.gz", "features.tsv", "genes.tsv.gz", "genes.tsv" });
+    const auto barcodes_path = internal::find_10x_file(directory, { "barcodes.tsv.gz", "barcodes.tsv" });
+
+    Loaded10xBundle<Value_, Index_> output;
+    const bool filter = options.feature_types.has_value();
+    const auto buffer_size = options.load.buffer_size;
+
+    auto read_features = [&]() -> void {
+        auto columns = internal::read_10x_table(features_path, 3, buffer_size);
+        output.feature_ids.swap(columns[0]);
+        output.feature_names.swap(columns[1]);
+        output.feature_types.swap(columns[2]);
+    };
+
+    // The ordering is always needed to reorder the annotations, even if the caller did not ask for it.
+    auto load_options = options.load;
+    LoadOrdering ordering;
+    const bool reorder_rows = (load_options.reorder_rows != ReorderMode::NONE), reorder_columns = (load_options.reorder_columns != ReorderMode::NONE);
+    if ((reorder_rows || reorder_columns) && !load_options.ordering) {
+        load_options.ordering = &ordering;
+    }
+
+    std::vector<Index_> remapping;
+    auto read_matrix = [&]() -> void {
+        if (!filter) {
+            output.matrix = internal::load_10x_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(matrix_path, NULL, load_options);
+            return;
+        }
+
+        // Features must be available to determine which rows to discard.
+        read_features();
+        if (output.feature_types.empty()) {
+            throw std::runtime_error("features file should contain feature types for filtering");
+        }
+        const std::unordered_set<std::string> wanted(options.feature_types->begin(), options.feature_types->end());
+        const auto num_features = output.feature_types.size();
+        sanisizer::resize(remapping, num_features);
+        std::size_t kept = 0;
+        for (std::size_t f = 0; f < num_features; ++f) {
+            if (wanted.find(output.feature_types[f]) == wanted.end()) {
+                remapping[f] = std::numeric_limits<Index_>::max();
+            } else {
+                remapping[f] = kept;
+                if (kept != f) {
+                    output.feature_ids[kept] = std::move(output.feature_ids[f]);
+                    output.feature_names[kept] = std::move(output.feature_names[f]);
+                    output.feature_types[kept] = std::move(output.feature_types[f]);
+                }
+                ++kept;
+            }
+        }
+        output.feature_ids.resize(kept);
+        output.feature_names.resize(kept);
+        output.feature_types.resize(kept);
+        internal::RowRemapping<Index_> details;
+        details.rows = &remapping;
+        details.num_kept = sanisizer::cast<Index_>(kept);
+        output.matrix = internal::load_10x_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(matrix_path, &details, load_options);
+    };
+
+    auto read_barcodes = [&]() -> void {
+        auto columns = internal::read_10x_table(barcodes_path, 1, buffer_size);
+        output.barcodes.swap(columns[0]);
+    };
+
+    const int num_jobs = (filter ? 2 : 3);
+    tatami::parallelize([&](int, int start, int length) -> void {
+        for (int j = start, end = start + length; j < end; ++j) {
+            if (j == 0) {
+                read_matrix();
+            } else if (j == 1) {
+                read_barcodes();
+            } else {
+                read_features();
+            }
+        }
+    }, num_jobs, options.num_threads);
+
+    if (!sanisizer::is_equal(output.feature_ids.size(), output.matrix->nrow())) {
+        throw std::runtime_error("number of features should be equal to the number of rows in the 10x matrix");
+    }
+    if (!sanisizer::is_equal(output.barcodes.size(), output.matrix->ncol())) {
+        throw std::runtime_error("number of barcodes should be equal to the number of columns in the 10x matrix");
+    }
+
+    if (reorder_rows) {
+        const auto& rows = load_options.ordering->rows;
+        internal::permute_vector(output.feature_ids, rows);
+        internal::permute_vector(output.feature_names, rows);
+        if (!output.feature_types.empty()) {
+            internal::permute_vector(output.feature_types, rows);
+        }
+    }
+    if (reorder_columns) {
+        internal::permute_vector(output.barcodes, load_options.ordering->columns);
+    }
+    return output;
+}
+
+}
+
+#endif
@@ -0,0 +1,341 @@
+#ifndef TATAMI_MTX_LOAD_BINARY_MATRIX_HPP
+#define TATAMI_MTX_LOAD_BINARY_MATRIX_HPP
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#if __has_include("zlib.h")
+#include "zlib.h"
+#endif
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "utils.hpp"
+#include "binary_format.hpp"
+
+/**
+ * @file load_binary_matrix.hpp
+ * @brief Load a **tatami** matrix from the binary container format.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Options for `load_binary_matrix_from_file()`.
+ */
+struct LoadBinaryMatrixOptions {
+    /**
+     * Whether to memory-map the file, if possible.
+     * This is only possible for uncompressed files on little-endian systems where the stored types are the same as those in the file.
+     * If true, the returned matrix directly references the mapped arrays without any copies, and only the pages that are accessed are read from disk.
+     * If false or memory mapping is not possible, the arrays are read into memory.
+     */
+    bool memory_map = true;
+
+    /**
+     * Whether to check the validity of the indices in `tatami::CompressedSparseMatrix`.
+     * This requires a full pass over the indices, which defeats the purpose of memory mapping.
+     * The pointers are always checked regardless of this setting.
+     */
+    bool check = false;
+
+    /**
+     * Number of threads for decompressing blocks in compressed files.
+     * This should be positive.
+     */
+    int num_threads = 1;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+#if __has_include(<sys/mman.h>)
+class MappedFile {
+public:
+    MappedFile(const char* filepath) {
+        const int fd = ::open(filepath, O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open the binary matrix file at '" + std::string(filepath) + "'");
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("failed to determine the size of '" + std::string(filepath) + "'");
+        }
+        my_size = info.st_size;
+
+        if (my_size) {
+            void* ptr = ::mmap(NULL, my_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("failed to memory-map '" + std::string(filepath) + "'");
+            }
+            my_data = static_cast<const unsigned char*>(ptr);
+        }
+
+        // The mapping remains valid after the file descriptor is closed.
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (my_data) {
+            ::munmap(const_cast<unsigned char*>(my_data), my_size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    const unsigned char* my_data = NULL;
+    std::size_t my_size = 0;
+
+public:
+    const unsigned char* data() const {
+        return my_data;
+    }
+
+    std::size_t size() const {
+        return my_size;
+    }
+};
+#endif
+
+template<typename Pointer_>
+void check_binary_pointers(const Pointer_& pointers, const unsigned long long nnz) {
+    if (pointers[0] != 0 || pointers[pointers.size() - 1] != nnz) {
+        throw std::runtime_error("first and last pointers should be equal to zero and the number of non-zero elements, respectively");
+    }
+    for (std::size_t p = 1, end = pointers.size(); p < end; ++p) {
+        if (pointers[p] < pointers[p - 1]) {
+            throw std::runtime_error("pointers should be sorted in the binary matrix");
+        }
+    }
+}
+
+inline void read_binary_bytes(std::istream& input, unsigned char* buffer, const std::size_t n) {
+    if (!input.read(reinterpret_cast<char*>(buffer), n)) {
+        throw std::runtime_error("binary matrix file is truncated");
+    }
+}
+
+// Reads the next array from 'input', converting each element from 'type' to 'Target_'.
+template<typename Target_>
+void read_binary_array(std::istream& input, const BinaryMatrixHeader& header, const BinaryDataType type, const std::size_t n, std::vector<Target_>& output, const int num_threads) {
+    sanisizer::resize(output, n);
+    const auto nbytes = sanisizer::product<std::size_t>(n, binary_type_size(type));
+    const bool same_type = (type == binary_type_of<Target_>());
+    const bool swap = !is_little_endian();
+
+    std::vector<unsigned char> raw;
+    unsigned char* destination;
+    if (same_type) {
+        destination = reinterpret_cast<unsigned char*>(output.data());
+    } else {
+        sanisizer::resize(raw, nbytes);
+        destination = raw.data();
+    }
+
+    if (!header.compressed) {
+        read_binary_bytes(input, destination, nbytes);
+        input.ignore((8 - nbytes % 8) % 8);
+
+    } else {
+#if __has_include("zlib.h")
+        // Reading all blocks first so that they can be decompressed in parallel.
+        const auto block_size = sanisizer::cast<std::size_t>(header.block_size);
+        const std::size_t num_blocks = nbytes / block_size + (nbytes % block_size > 0);
+        auto blocks = sanisizer::create<std::vector<std::vector<unsigned char> > >(num_blocks);
+        for (auto& block : blocks) {
+            unsigned char size_buffer[8];
+            read_binary_bytes(input, size_buffer, 8);
+            sanisizer::resize(block, decode_uint64(size_buffer));
+            read_binary_bytes(input, block.data(), block.size());
+        }
+
+        tatami::parallelize([&](int, std::size_t start, std::size_t length) -> void {
+            for (std::size_t b = start, end = start + length; b < end; ++b) {
+                const auto offset = b * block_size;
+                const auto expected = std::min(block_size, nbytes - offset);
+                uLongf decompressed = expected;
+                if (uncompress(destination + offset, &decompressed, blocks[b].data(), blocks[b].size()) != Z_OK || decompressed != expected) {
+                    throw std::runtime_error("failed to decompress block in the binary matrix");
+                }
+            }
+        }, num_blocks, num_threads);
+#else
+        throw std::runtime_error("Zlib is required to load compressed binary matrices");
+#endif
+    }
+
+    if (same_type) {
+        if (swap) {
+            swap_bytes(output.data(), n);
+        }
+        return;
+    }
+
+    visit_binary_type(type, [&](auto tag) -> void {
+        typedef std::remove_pointer_t<decltype(tag)> Stored;
+        for (std::size_t i = 0; i < n; ++i) {
+            Stored current;
+            std::memcpy(&current, raw.data() + i * sizeof(Stored), sizeof(Stored));
+            if (swap) {
+                swap_bytes(&current, 1);
+            }
+            output[i] = current;
+        }
+    });
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Compressed sparse matrix that references a memory-mapped binary matrix file.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Type of the values in the file.
+ * @tparam StoredIndex_ Type of the indices in the file.
+ *
+ * This holds a reference to the mapping to ensure that the arrays remain valid for the lifetime of the matrix.
+ * Otherwise, it behaves exactly like a `tatami::CompressedSparseMatrix`.
+ */
+template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_>
+class MappedCompressedSparseMatrix final : public tatami::CompressedSparseMatrix<
+    Value_,
+    Index_,
+    tatami::ArrayView<StoredValue_>,
+    tatami::ArrayView<StoredIndex_>,
+    tatami::ArrayView<std::uint64_t>
+> {
+public:
+    /**
+     * @param mapping Shared pointer to the mapped file, which should be kept alive while the arrays are in use.
+     * @param nrow Number of rows.
+     * @param ncol Number of columns.
+     * @param values View into the mapped value array.
+     * @param indices View into the mapped index array.
+     * @param pointers View into the mapped pointer array.
+     * @param row Whether the matrix is stored in the compressed sparse row format.
+     * @param check Whether to check the validity of the arrays.
+     */
+    MappedCompressedSparseMatrix(
+        std::shared_ptr<const void> mapping,
+        const Index_ nrow,
+        const Index_ ncol,
+        tatami::ArrayView<StoredValue_> values,
+        tatami::ArrayView<StoredIndex_> indices,
+        tatami::ArrayView<std::uint64_t> pointers,
+        const bool row,
+        const bool check
+    ) :
+        tatami::CompressedSparseMatrix<Value_, Index_, tatami::ArrayView<StoredValue_>, tatami::ArrayView<StoredIndex_>, tatami::ArrayView<std::uint64_t> >(
+            nrow, ncol, std::move(values), std::move(indices), std::move(pointers), row, check
+        ),
+        my_mapping(std::move(mapping))
+    {}
+
+private:
+    std::shared_ptr<const void> my_mapping;
+};
+
+/**
+ * Load a `tatami::Matrix` from a binary container file created by `write_binary_matrix()`.
+ * If possible, the file is memory-mapped and the returned matrix references the mapped arrays directly, see `LoadBinaryMatrixOptions::memory_map`.
+ * Otherwise, the arrays are read (and decompressed, if necessary) into a `tatami::CompressedSparseMatrix`,
+ * where each value/index is converted from the type in the file to `StoredValue_`/`StoredIndex_`.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory.
+ * @tparam StoredIndex_ Index data type that is stored in memory.
+ *
+ * @param filepath Path to the binary matrix file.
+ * @param options Options for loading the matrix.
+ *
+ * @return Pointer to a `tatami::Matrix` instance containing data from the binary matrix file.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Value_, typename StoredIndex_ = Index_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_binary_matrix_from_file(const char* filepath, const LoadBinaryMatrixOptions& options) {
+    static_assert(std::is_integral<StoredIndex_>::value, "indices should be stored as integers");
+    const auto header = read_binary_matrix_header(filepath);
+    const auto NR = sanisizer::cast<Index_>(header.nrow);
+    const auto NC = sanisizer::cast<Index_>(header.ncol);
+    const auto num_pointers = sanisizer::sum<std::size_t>(header.row ? NR : NC, 1);
+    const auto nnz = sanisizer::cast<std::size_t>(header.nnz);
+
+#if __has_include(<sys/mman.h>)
+    if (
+        options.memory_map &&
+        !header.compressed &&
+        internal::is_little_endian() &&
+        header.value_type == internal::binary_type_of<StoredValue_>() &&
+        header.index_type == internal::binary_type_of<StoredIndex_>()
+    ) {
+        const auto offsets = internal::compute_binary_offsets(header);
+        auto mapping = std::make_shared<const internal::MappedFile>(filepath);
+        if (sanisizer::is_less_than(mapping->size(), offsets.end)) {
+            throw std::runtime_error("binary matrix file is truncated");
+        }
+
+        // Offsets are multiples of 8 and the mapping is page-aligned, so all arrays are suitably aligned.
+        const auto base = mapping->data();
+        tatami::ArrayView<std::uint64_t> pointers(reinterpret_cast<const std::uint64_t*>(base + offsets.pointers), num_pointers);
+        internal::check_binary_pointers(pointers, header.nnz);
+        tatami::ArrayView<StoredIndex_> indices(reinterpret_cast<const StoredIndex_*>(base + offsets.indices), nnz);
+        tatami::ArrayView<StoredValue_> values(reinterpret_cast<const StoredValue_*>(base + offsets.values), nnz);
+
+        return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
+            new MappedCompressedSparseMatrix<Value_, Index_, StoredValue_, StoredIndex_>(
+                std::move(mapping), NR, NC, std::move(values), std::move(indices), std::move(pointers), header.row, options.check
+            )
+        );
+    }
+#endif
+
+    std::ifstream input(filepath, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("failed to open the binary matrix file at '" + std::string(filepath) + "'");
+    }
+    input.ignore(internal::binary_header_size);
+
+    std::vector<std::uint64_t> pointers;
+    internal::read_binary_array(input, header, BinaryDataType::UINT64, num_pointers, pointers, options.num_threads);
+    internal::check_binary_pointers(pointers, header.nnz);
+    std::vector<StoredIndex_> indices;
+    internal::read_binary_array(input, header, header.index_type, nnz, indices, options.num_threads);
+    std::vector<StoredValue_> values;
+    internal::read_binary_array(input, header, header.value_type, nnz, values, options.num_threads);
+
+    return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
+        new tatami::CompressedSparseMatrix<Value_, Index_, I<decltype(values)>, I<decltype(indices)>, I<decltype(pointers)> >(
+            NR, NC, std::move(values), std::move(indices), std::move(pointers), header.row, options.check
+        )
+    );
+}
+
+}
+
+#endif
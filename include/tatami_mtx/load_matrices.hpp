@@ -0,0 +1,214 @@
+#ifndef TATAMI_MTX_LOAD_MATRICES_HPP
+#define TATAMI_MTX_LOAD_MATRICES_HPP
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+
+#include "utils.hpp"
+#include "load_matrix.hpp"
+
+/**
+ * @file load_matrices.hpp
+ * @brief Load and combine multiple Matrix Market files into a single **tatami** matrix.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Options for `load_matrices()`.
+ */
+struct LoadMatricesOptions {
+    /**
+     * Whether to combine the matrices by row, i.e., the rows of all files are concatenated.
+     * If false, the matrices are combined by column.
+     * The combined matrix is stored in the compressed sparse row format if true, and in the compressed sparse column format otherwise.
+     */
+    bool row = false;
+
+    /**
+     * Number of threads for loading files concurrently.
+     * Each thread loads a different file.
+     * Note that each file is loaded with `LoadMatrixOptions::num_threads` from `load`, so up to `num_threads * load.num_threads` threads may be active at once;
+     * users should typically leave `load.num_threads` at 1 when loading many files concurrently.
+     */
+    int num_threads = 1;
+
+    /**
+     * Options for loading each file, see `load_matrix()` for details.
+     * `LoadMatrixOptions::row` is ignored and set to `LoadMatricesOptions::row` so that each file can be directly copied into the combined matrix.
+     * `LoadMatrixOptions::delta_varint_indices`, `LoadMatrixOptions::statistics`, `LoadMatrixOptions::compress_threads`, `LoadMatrixOptions::first_touch_threads`, `LoadMatrixOptions::summaries`, `LoadMatrixOptions::tiled` and the reordering options are also ignored.
+     */
+    LoadMatrixOptions load;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+// Calls 'fun(range)' for each primary slice of 'matrix', where 'range' only contains the structural non-zero elements.
+// If 'contents = false', only 'range.number' is guaranteed to be set, which avoids copying the contents of sparse matrices.
+// Both settings report the same number of elements for each slice, so one call can be used to count and the other to copy.
+template<typename Value_, typename Index_, class Function_>
+void visit_nonzero_slices(const tatami::Matrix<Value_, Index_>& matrix, const bool row, const bool contents, Function_ fun) {
+    const Index_ num_primary = (row ? matrix.nrow() : matrix.ncol());
+    const Index_ num_secondary = (row ? matrix.ncol() : matrix.nrow());
+    auto vbuffer = sanisizer::create<std::vector<Value_> >(num_secondary);
+    auto ibuffer = sanisizer::create<std::vector<Index_> >(num_secondary);
+
+    if (matrix.is_sparse()) {
+        tatami::Options opt;
+        opt.sparse_extract_value = contents;
+        opt.sparse_extract_index = contents;
+        auto ext = tatami::consecutive_extractor<true>(matrix, row, static_cast<Index_>(0), num_primary, opt);
+        for (Index_ p = 0; p < num_primary; ++p) {
+            fun(ext->fetch(vbuffer.data(), ibuffer.data()));
+        }
+
+    } else {
+        auto ext = tatami::consecutive_extractor<false>(matrix, row, static_cast<Index_>(0), num_primary);
+        auto dbuffer = sanisizer::create<std::vector<Value_> >(num_secondary);
+        for (Index_ p = 0; p < num_primary; ++p) {
+            auto ptr = ext->fetch(dbuffer.data());
+            tatami::SparseRange<Value_, Index_> range(0, vbuffer.data(), ibuffer.data());
+            for (Index_ s = 0; s < num_secondary; ++s) {
+                if (ptr[s] != 0) {
+                    vbuffer[range.number] = ptr[s];
+                    ibuffer[range.number] = s;
+                    ++range.number;
+                }
+            }
+            fun(range);
+        }
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Load multiple Matrix Market files and combine them into a single compressed sparse matrix.
+ * This is typically used to combine per-sample count matrices with the same features (rows) into a single matrix.
+ *
+ * Files are loaded concurrently, and their contents are copied into the combined matrix at precomputed offsets.
+ * Unlike a `tatami::DelayedBind` of the individual matrices, this avoids any indirection during extraction from the combined matrix.
+ * The number of structural non-zero elements in each row/column of each loaded matrix is counted without copying its contents,
+ * so each matrix only needs to be extracted once.
+ * The combined arrays are allocated without initialization and each individual matrix is released once its contents have been copied,
+ * so the peak memory usage is not much more than the size of the combined matrix on systems that lazily commit memory.
+ * All elements of coordinate files are stored in the combined matrix, including explicit zeros, while zeros in array files are not stored.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory.
+ * @tparam StoredIndex_ Index data type that is stored in memory.
+ *
+ * @param paths Paths to Matrix Market files, possibly Gzip-compressed if Zlib is available.
+ * All files should have the same number of rows (if `LoadMatricesOptions::row = false`) or columns (otherwise).
+ * @param options Options for loading the matrices.
+ *
+ * @return Pointer to a `tatami::Matrix` instance containing the combined data.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Value_, typename StoredIndex_ = Index_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrices(const std::vector<std::string>& paths, const LoadMatricesOptions& options) {
+    if (paths.empty()) {
+        throw std::runtime_error("at least one path should be supplied");
+    }
+
+    const bool row = options.row;
+    auto load_options = options.load;
+    load_options.row = row;
+    load_options.delta_varint_indices = false;
+    load_options.statistics = NULL;
+    load_options.compress_threads = 1;
+    load_options.first_touch_threads = 1;
+    load_options.summaries = NULL;
+    load_options.reorder_rows = ReorderMode::NONE;
+    load_options.reorder_columns = ReorderMode::NONE;
+    load_options.ordering = NULL;
+    load_options.tiled = false;
+
+    const auto num_files = paths.size();
+    std::vector<std::shared_ptr<tatami::Matrix<Value_, Index_> > > loaded(num_files);
+    std::vector<std::vector<std::size_t> > counts(num_files);
+
+    // First pass to load each file and count the elements in each primary slice.
+    // The counts must come from the same extraction as the copy, as the parsed values may be converted to zero when cast to Value_.
+    tatami::parallelize([&](int, std::size_t start, std::size_t length) -> void {
+        for (std::size_t f = start, end = start + length; f < end; ++f) {
+            const char* path = paths[f].c_str();
+#if __has_include("zlib.h")
+            loaded[f] = load_matrix_from_some_file<Value_, Index_, StoredValue_, StoredIndex_>(path, load_options);
+#else
+            loaded[f] = load_matrix_from_text_file<Value_, Index_, StoredValue_, StoredIndex_>(path, load_options);
+#endif
+
+            auto& current = counts[f];
+            current.reserve(row ? loaded[f]->nrow() : loaded[f]->ncol());
+            internal::visit_nonzero_slices(*(loaded[f]), row, false, [&](const tatami::SparseRange<Value_, Index_>& range) -> void {
+                current.push_back(range.number);
+            });
+        }
+    }, num_files, options.num_threads);
+
+    // Checking dimensions and computing the offsets of each file in the combined matrix.
+    const Index_ num_secondary = (row ? loaded.front()->ncol() : loaded.front()->nrow());
+    std::vector<Index_> primary_offsets(num_files + 1);
+    for (std::size_t f = 0; f < num_files; ++f) {
+        const auto& mat = loaded[f];
+        if ((row ? mat->ncol() : mat->nrow()) != num_secondary) {
+            throw std::runtime_error("all matrices should have the same number of " + std::string(row ? "columns" : "rows") + " (see '" + paths[f] + "')");
+        }
+        primary_offsets[f + 1] = sanisizer::sum<Index_>(primary_offsets[f], row ? mat->nrow() : mat->ncol());
+    }
+
+    const Index_ num_primary = primary_offsets.back();
+    auto pointers = sanisizer::create<std::vector<std::size_t> >(sanisizer::sum<std::size_t>(num_primary, 1));
+    for (std::size_t f = 0; f < num_files; ++f) {
+        auto& current = counts[f];
+        std::copy(current.begin(), current.end(), pointers.begin() + primary_offsets[f] + 1);
+        std::vector<std::size_t>().swap(current);
+    }
+    for (Index_ p = 0; p < num_primary; ++p) {
+        pointers[p + 1] = sanisizer::sum<std::size_t>(pointers[p + 1], pointers[p]);
+    }
+
+    // Pages of the combined arrays are only committed as they are filled, while each individual matrix is released after copying.
+    const auto total_nnz = pointers.back();
+    internal::FirstTouchStorage<std::vector<StoredValue_> > values(total_nnz);
+    internal::FirstTouchStorage<std::vector<StoredIndex_> > indices(total_nnz);
+
+    // Second pass to copy each file into its own region of the combined arrays.
+    tatami::parallelize([&](int, std::size_t start, std::size_t length) -> void {
+        for (std::size_t f = start, end = start + length; f < end; ++f) {
+            auto position = pointers[primary_offsets[f]];
+            internal::visit_nonzero_slices(*(loaded[f]), row, true, [&](const tatami::SparseRange<Value_, Index_>& range) -> void {
+                std::copy_n(range.value, range.number, values.begin() + position);
+                std::copy_n(range.index, range.number, indices.begin() + position);
+                position += range.number;
+            });
+            loaded[f].reset();
+        }
+    }, num_files, options.num_threads);
+
+    const Index_ NR = (row ? num_primary : num_secondary);
+    const Index_ NC = (row ? num_secondary : num_primary);
+    return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
+        new tatami::CompressedSparseMatrix<Value_, Index_, I<decltype(values)>, I<decltype(indices)>, I<decltype(pointers)> >(
+            NR, NC, std::move(values), std::move(indices), std::move(pointers), row, false
+        )
+    );
+}
+
+}
+
+#endif
@@ -6,6 +6,12 @@
 #include <limits>
 #include <type_traits>
 #include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <numeric>
+#include <stdexcept>
+#include <optional>
+#include <memory>
 
 #include "tatami/tatami.hpp"
 #include "eminem/eminem.hpp"
@@ -13,6 +19,9 @@
 #include "sanisizer/sanisizer.hpp"
 
 #include "utils.hpp"
+#include "delta_varint_sparse_matrix.hpp"
+#include "tiled_sparse_matrix.hpp"
+#include "statistics.hpp"
 
 /**
  * @file load_matrix.hpp
@@ -28,6 +37,61 @@ namespace tatami_mtx {
  */
 struct Automatic {};
 
+/**
+ * @brief Per-row and per-column summaries computed by `load_matrix()`.
+ *
+ * An instance of this class can be supplied via `LoadMatrixOptions::summaries`, in which case its vectors are filled as the file is parsed.
+ * This avoids an extra pass over the loaded matrix to compute these statistics.
+ */
+struct LoadSummaries {
+    /**
+     * Sum of values in each row.
+     */
+    std::vector<double> row_sums;
+
+    /**
+     * Sum of values in each column.
+     */
+    std::vector<double> column_sums;
+
+    /**
+     * Number of non-zero values in each row.
+     * Explicit zeros in the coordinate format are not counted.
+     */
+    std::vector<std::size_t> row_detected;
+
+    /**
+     * Number of non-zero values in each column.
+     * Explicit zeros in the coordinate format are not counted.
+     */
+    std::vector<std::size_t> column_detected;
+};
+
+/**
+ * Reordering of the rows or columns of a matrix during loading.
+ *
+ * - `NONE`: the order in the Matrix Market file is preserved.
+ * - `NNZ`: rows/columns are sorted by decreasing number of structural non-zero elements, with ties broken by the original order.
+ *   This places the most densely populated rows/columns next to each other.
+ * - `CUSTOM`: rows/columns are ordered according to a user-supplied permutation.
+ */
+enum class ReorderMode : char { NONE, NNZ, CUSTOM };
+
+/**
+ * @brief Ordering of rows and columns in a matrix created by `load_matrix()`.
+ */
+struct LoadOrdering {
+    /**
+     * Index of the row in the Matrix Market file for each row of the loaded matrix.
+     */
+    std::vector<std::size_t> rows;
+
+    /**
+     * Index of the column in the Matrix Market file for each column of the loaded matrix.
+     */
+    std::vector<std::size_t> columns;
+};
+
 /**
  * @brief Options for `load_matrix()` and friends.
  */
@@ -49,6 +113,102 @@ struct LoadMatrixOptions {
      * If greater than 1, chunks of the file are read (and decompressed) in one thread while the contents are parsed in another thread.
      */
     int num_threads = 1;
+
+    /**
+     * Number of threads to use for sorting the triplets of a coordinate file into a compressed sparse matrix.
+     * If greater than 1, a parallel counting sort is used instead of `tatami::compress_sparse_triplets()`.
+     * This requires an additional copy of the values and secondary indices, plus a histogram of length equal to the number of rows (if `row = true`) or columns (otherwise) for each thread,
+     * so it should only be enabled when there is enough memory to spare, see `inspect_matrix()` to estimate the peak usage.
+     */
+    int compress_threads = 1;
+
+    /**
+     * Whether to store the indices of a sparse matrix with delta encoding and variable-length integers, see `DeltaVarintSparseMatrix` for details.
+     * This reduces memory usage for large sparse matrices at the cost of some extraction speed.
+     * If true, `StoredIndex_` in `load_matrix()` is only used for the temporary storage of indices during loading.
+     * Ignored for array formats.
+     */
+    bool delta_varint_indices = false;
+
+    /**
+     * Pointer to a `LoadStatistics` instance in which to record timings and memory usage for each phase of the load.
+     * If NULL, no statistics are collected.
+     * The pointed-to object should not be accessed by other threads during the load, except via `LoadStatistics::progress`.
+     */
+    LoadStatistics* statistics = NULL;
+
+    /**
+     * Number of threads to use for the first touch of the final arrays of the matrix.
+     * If greater than 1, each array is allocated without initialization and then filled in parallel, where each thread handles a contiguous block of rows (if `row = true`) or columns (otherwise).
+     * On NUMA systems, this places the memory for each block close to the thread that first touched it.
+     * This should be set to the number of threads in later calls to `tatami::parallelize()` on the loaded matrix, so that each block is processed by the same partition of threads.
+     * For sparse matrices with `delta_varint_indices = true`, only the values are placed in this manner.
+     */
+    int first_touch_threads = 1;
+
+    /**
+     * Pointer to a `LoadSummaries` instance in which to store the per-row and per-column sums and counts of non-zero values.
+     * Any existing contents of its vectors are replaced.
+     * For symmetric matrices, the mirrored elements are also included.
+     * If NULL, no summaries are computed.
+     */
+    LoadSummaries* summaries = NULL;
+
+    /**
+     * How to reorder the rows of the matrix.
+     * Reordering is applied to the triplets before the compressed sparse matrix is constructed, so no extra copy of the matrix is required.
+     * Only the coordinate format is supported.
+     */
+    ReorderMode reorder_rows = ReorderMode::NONE;
+
+    /**
+     * How to reorder the columns of the matrix, see `reorder_rows` for details.
+     */
+    ReorderMode reorder_columns = ReorderMode::NONE;
+
+    /**
+     * Permutation of rows when `reorder_rows = ReorderMode::CUSTOM`.
+     * Each entry contains the index of the row in the Matrix Market file that should be used for the corresponding row of the loaded matrix.
+     */
+    std::vector<std::size_t> custom_row_order;
+
+    /**
+     * Permutation of columns when `reorder_columns = ReorderMode::CUSTOM`, see `custom_row_order` for details.
+     */
+    std::vector<std::size_t> custom_column_order;
+
+    /**
+     * Pointer to a `LoadOrdering` instance in which to store the ordering of the rows and columns of the loaded matrix.
+     * This is useful for mapping the loaded rows/columns back to their annotations, e.g., when `ReorderMode::NNZ` is used.
+     * If `LoadMatrixOptions::summaries` is provided, its vectors are also reported in the order of the loaded matrix.
+     * If NULL, the ordering is not reported.
+     */
+    LoadOrdering* ordering = NULL;
+
+    /**
+     * Whether to return a sparse matrix as a `TiledSparseMatrix`, where each tile is a compressed sparse matrix of `tile_nrow` by `tile_ncol`.
+     * Each tile is compressed by row if `row = true` and by column otherwise.
+     * This provides balanced performance for row and column access, at the cost of some speed when accessing the full extent of either dimension.
+     * The triplets are bucketed into tiles in place and all tiles share the same arrays of values and indices, so no copy of the matrix is made.
+     * However, each tile stores its own pointers, i.e., `tile_nrow + 1` (if `row = true`) or `tile_ncol + 1` (otherwise) 32-bit integers for each tile that contains at least one element;
+     * if all tiles are non-empty, this is roughly `ncol / tile_ncol` (if `row = true`) or `nrow / tile_nrow` (otherwise) times the size of the pointers of a single compressed sparse matrix.
+     * Empty tiles share a single array of zero pointers.
+     * If true, `delta_varint_indices`, `compress_threads` and `first_touch_threads` are ignored, and the tiles are constructed in parallel with `num_threads`.
+     * Only the coordinate format is supported.
+     */
+    bool tiled = false;
+
+    /**
+     * Number of rows in each tile when `tiled = true`.
+     * This should be positive.
+     */
+    std::size_t tile_nrow = 1024;
+
+    /**
+     * Number of columns in each tile when `tiled = true`.
+     * This should be positive.
+     */
+    std::size_t tile_ncol = 1024;
 };
 
 /**
@@ -59,166 +219,632 @@ typedef LoadMatrixOptions Options;
 
 namespace internal {
 
-template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, typename TempIndex_, typename Parser_>
-std::shared_ptr<tatami::Matrix<Value_, Index_> > load_sparse_matrix_basic(Parser_& parser, const eminem::Field field, const Index_ NR, const Index_ NC, const eminem::LineIndex NL, const bool row) {
-    std::vector<TempIndex_> primary;
-    primary.reserve(NL);
-    std::vector<StoredIndex_> secondary;
-    secondary.reserve(NL);
-    std::vector<StoredValue_> values;
-    values.reserve(NL);
+template<typename Index_>
+void reset_summaries(LoadSummaries& summaries, const Index_ NR, const Index_ NC) {
+    summaries.row_sums.clear();
+    sanisizer::resize(summaries.row_sums, NR);
+    summaries.column_sums.clear();
+    sanisizer::resize(summaries.column_sums, NC);
+    summaries.row_detected.clear();
+    sanisizer::resize(summaries.row_detected, NR);
+    summaries.column_detected.clear();
+    sanisizer::resize(summaries.column_detected, NC);
+}
 
-    if (field == eminem::Field::INTEGER) {
-        typedef typename std::conditional<std::is_integral<StoredValue_>::value, StoredValue_, int>::type ParseType;
-        parser.template scan_integer<ParseType>([&](const Index_ r, const Index_ c, const ParseType v) -> void {
+// Indices should be 1-based, as provided by the Matrix Market parser.
+template<typename Index_, typename Number_>
+void add_summary(LoadSummaries& summaries, const Index_ r, const Index_ c, const Number_ v) {
+    if (v != 0) {
+        summaries.row_sums[r - 1] += v;
+        summaries.column_sums[c - 1] += v;
+        ++summaries.row_detected[r - 1];
+        ++summaries.column_detected[c - 1];
+    }
+}
+
+// Computes the new order of a dimension and remaps the indices in-place, where 'order[i]' is the original index of the new index 'i'.
+template<typename Index_, class Indices_>
+std::vector<std::size_t> reorder_indices(const ReorderMode mode, const std::vector<std::size_t>& custom, const Index_ extent, Indices_& indices) {
+    auto order = sanisizer::create<std::vector<std::size_t> >(extent);
+    if (mode == ReorderMode::NONE) {
+        std::iota(order.begin(), order.end(), static_cast<std::size_t>(0));
+        return order;
+    }
+
+    if (mode == ReorderMode::CUSTOM) {
+        if (!sanisizer::is_equal(custom.size(), extent)) {
+            throw std::runtime_error("length of the custom order should be equal to the extent of its dimension");
+        }
+        std::vector<unsigned char> found(custom.size());
+        for (auto o : custom) {
+            if (o >= custom.size() || found[o]) {
+                throw std::runtime_error("custom order should be a permutation of the row/column indices");
+            }
+            found[o] = 1;
+        }
+        std::copy(custom.begin(), custom.end(), order.begin());
+
+    } else {
+        auto counts = sanisizer::create<std::vector<std::size_t> >(extent);
+        for (auto i : indices) {
+            ++counts[i];
+        }
+        std::iota(order.begin(), order.end(), static_cast<std::size_t>(0));
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t left, std::size_t right) -> bool { return counts[left] > counts[right]; });
+    }
+
+    auto remap = sanisizer::create<std::vector<Index_> >(extent);
+    for (Index_ i = 0; i < extent; ++i) {
+        remap[order[i]] = i;
+    }
+    for (auto& i : indices) {
+        i = remap[i];
+    }
+    return order;
+}
+
+template<typename Index_>
+void set_identity_ordering(LoadOrdering& ordering, const Index_ NR, const Index_ NC) {
+    sanisizer::resize(ordering.rows, NR);
+    std::iota(ordering.rows.begin(), ordering.rows.end(), static_cast<std::size_t>(0));
+    sanisizer::resize(ordering.columns, NC);
+    std::iota(ordering.columns.begin(), ordering.columns.end(), static_cast<std::size_t>(0));
+}
+
+template<typename Type_>
+void permute_vector(std::vector<Type_>& x, const std::vector<std::size_t>& order) {
+    std::vector<Type_> permuted;
+    permuted.reserve(order.size());
+    for (auto o : order) {
+        permuted.push_back(std::move(x[o]));
+    }
+    x.swap(permuted);
+}
+
+template<typename Index_, class TempIndexStorage_, class IndexStorage_>
+void reorder_triplets(const Index_ NR, const Index_ NC, TempIndexStorage_& primary, IndexStorage_& secondary, const LoadMatrixOptions& options) {
+    const bool no_rows = (options.reorder_rows == ReorderMode::NONE), no_columns = (options.reorder_columns == ReorderMode::NONE);
+    if (no_rows && no_columns) {
+        if (options.ordering) {
+            set_identity_ordering(*(options.ordering), NR, NC);
+        }
+        return;
+    }
+
+    const bool row = options.row;
+    std::vector<std::size_t> row_order, column_order;
+    if (row) {
+        row_order = reorder_indices(options.reorder_rows, options.custom_row_order, NR, primary);
+        column_order = reorder_indices(options.reorder_columns, options.custom_column_order, NC, secondary);
+    } else {
+        row_order = reorder_indices(options.reorder_rows, options.custom_row_order, NR, secondary);
+        column_order = reorder_indices(options.reorder_columns, options.custom_column_order, NC, primary);
+    }
+
+    if (options.summaries) {
+        auto& summaries = *(options.summaries);
+        if (!no_rows) {
+            permute_vector(summaries.row_sums, row_order);
+            permute_vector(summaries.row_detected, row_order);
+        }
+        if (!no_columns) {
+            permute_vector(summaries.column_sums, column_order);
+            permute_vector(summaries.column_detected, column_order);
+        }
+    }
+
+    if (options.ordering) {
+        options.ordering->rows.swap(row_order);
+        options.ordering->columns.swap(column_order);
+    }
+}
+
+// Allocator adaptor that default-initializes elements instead of value-initializing them.
+// This means that creating a vector of arithmetic types does not touch the allocated memory.
+template<typename Type_, class Base_ = std::allocator<Type_> >
+class DefaultInitAllocator : public Base_ {
+    typedef std::allocator_traits<Base_> BaseTraits;
+
+public:
+    typedef Type_ value_type;
+
+    template<typename Other_>
+    struct rebind {
+        typedef DefaultInitAllocator<Other_, typename BaseTraits::template rebind_alloc<Other_> > other;
+    };
+
+    DefaultInitAllocator() = default;
+
+    template<typename Other_, class OtherBase_>
+    DefaultInitAllocator(const DefaultInitAllocator<Other_, OtherBase_>& other) : Base_(static_cast<const OtherBase_&>(other)) {}
+
+    template<typename Other_>
+    void construct(Other_* ptr) {
+        ::new(static_cast<void*>(ptr)) Other_;
+    }
+
+    template<typename Other_, typename ... Args_>
+    void construct(Other_* ptr, Args_&& ... args) {
+        BaseTraits::construct(static_cast<Base_&>(*this), ptr, std::forward<Args_>(args)...);
+    }
+
+    template<typename Other_, class OtherBase_>
+    bool operator==(const DefaultInitAllocator<Other_, OtherBase_>& other) const {
+        return static_cast<const Base_&>(*this) == static_cast<const OtherBase_&>(other);
+    }
+
+    template<typename Other_, class OtherBase_>
+    bool operator!=(const DefaultInitAllocator<Other_, OtherBase_>& other) const {
+        return !(*this == other);
+    }
+};
+
+template<class Storage_>
+using FirstTouchStorage = std::vector<typename Storage_::value_type, DefaultInitAllocator<typename Storage_::value_type, typename Storage_::allocator_type> >;
+
+// Copies the contents of each primary slice on the thread that will process it in tatami::parallelize().
+// 'offset(p)' should return the position of the start of slice 'p' in 'input'.
+template<class Storage_, typename Index_, class Offset_>
+FirstTouchStorage<Storage_> first_touch_copy(const Storage_& input, const Index_ num_primary, const int num_threads, Offset_ offset) {
+    FirstTouchStorage<Storage_> output(input.size());
+    tatami::parallelize([&](int, const Index_ start, const Index_ length) -> void {
+        const auto first = offset(start), last = offset(start + length);
+        std::copy(input.begin() + first, input.begin() + last, output.begin() + first);
+    }, num_primary, num_threads);
+    return output;
+}
+
+template<typename Value_, typename Index_, class ValueStorage_, class IndexStorage_, class PointerStorage_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > create_sparse_matrix(const Index_ NR, const Index_ NC, ValueStorage_ values, IndexStorage_ indices, PointerStorage_ pointers, const LoadMatrixOptions& options) {
+    const bool row = options.row;
+    if (options.delta_varint_indices) {
+        auto encoded = encode_delta_varint_indices<Index_>((row ? NR : NC), pointers, indices);
+        return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
+            new DeltaVarintSparseMatrix<Value_, Index_, typename ValueStorage_::value_type, ValueStorage_>(NR, NC, std::move(values), std::move(encoded), row)
+        );
+    }
+
+    return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
+        new tatami::CompressedSparseMatrix<Value_, Index_, ValueStorage_, IndexStorage_, PointerStorage_>(
+            NR, NC, std::move(values), std::move(indices), std::move(pointers), row, false
+        )
+    );
+}
+
+// Parallel counting sort of the triplets by their primary indices, followed by sorting of the secondary indices within each primary slice.
+// Each chunk of triplets is counted and scattered by a single thread, so the original order is preserved for duplicate indices.
+// On return, 'values' and 'secondary' are replaced by their sorted counterparts and 'primary' is cleared to release its memory.
+template<class ValueStorage_, class TempIndexStorage_, class IndexStorage_>
+std::vector<std::size_t> parallel_compress_sparse_triplets(const std::size_t num_primary, ValueStorage_& values, TempIndexStorage_& primary, IndexStorage_& secondary, const int num_threads) {
+    const std::size_t num_triplets = values.size();
+    const std::size_t num_chunks = num_threads;
+    const std::size_t chunk_size = num_triplets / num_chunks + (num_triplets % num_chunks > 0);
+
+    // Per-chunk histograms, which are then converted into each chunk's starting offset for each primary slice.
+    std::vector<std::vector<std::size_t> > offsets(num_chunks);
+    tatami::parallelize([&](int, const std::size_t first, const std::size_t length) -> void {
+        for (std::size_t c = first, end = first + length; c < end; ++c) {
+            auto& current = offsets[c];
+            sanisizer::resize(current, num_primary);
+            const auto start = std::min(num_triplets, c * chunk_size), finish = std::min(num_triplets, start + chunk_size);
+            for (std::size_t i = start; i < finish; ++i) {
+                ++current[primary[i]];
+            }
+        }
+    }, num_chunks, num_threads);
+
+    auto pointers = sanisizer::create<std::vector<std::size_t> >(sanisizer::sum<std::size_t>(num_primary, 1));
+    std::size_t running = 0;
+    for (std::size_t p = 0; p < num_primary; ++p) {
+        for (auto& current : offsets) {
+            const auto count = current[p];
+            current[p] = running;
+            running += count;
+        }
+        pointers[p + 1] = running;
+    }
+
+    ValueStorage_ sorted_values(num_triplets);
+    IndexStorage_ sorted_indices(num_triplets);
+    tatami::parallelize([&](int, const std::size_t first, const std::size_t length) -> void {
+        for (std::size_t c = first, end = first + length; c < end; ++c) {
+            auto& current = offsets[c];
+            const auto start = std::min(num_triplets, c * chunk_size), finish = std::min(num_triplets, start + chunk_size);
+            for (std::size_t i = start; i < finish; ++i) {
+                auto& pos = current[primary[i]];
+                sorted_values[pos] = values[i];
+                sorted_indices[pos] = secondary[i];
+                ++pos;
+            }
+        }
+    }, num_chunks, num_threads);
+
+    values.swap(sorted_values);
+    ValueStorage_().swap(sorted_values);
+    secondary.swap(sorted_indices);
+    IndexStorage_().swap(sorted_indices);
+    TempIndexStorage_().swap(primary);
+
+    tatami::parallelize([&](int, const std::size_t start, const std::size_t length) -> void {
+        std::vector<std::size_t> order;
+        std::vector<typename ValueStorage_::value_type> vbuffer;
+        std::vector<typename IndexStorage_::value_type> ibuffer;
+
+        for (std::size_t p = start, end = start + length; p < end; ++p) {
+            const auto ibegin = secondary.begin() + pointers[p], iend = secondary.begin() + pointers[p + 1];
+            if (std::is_sorted(ibegin, iend)) {
+                continue;
+            }
+
+            order.resize(iend - ibegin);
+            std::iota(order.begin(), order.end(), static_cast<std::size_t>(0));
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t left, std::size_t right) -> bool { return ibegin[left] < ibegin[right]; });
+
+            const auto vbegin = values.begin() + pointers[p];
+            vbuffer.clear();
+            ibuffer.clear();
+            for (auto o : order) {
+                vbuffer.push_back(vbegin[o]);
+                ibuffer.push_back(ibegin[o]);
+            }
+            std::copy(vbuffer.begin(), vbuffer.end(), vbegin);
+            std::copy(ibuffer.begin(), ibuffer.end(), ibegin);
+        }
+    }, num_primary, num_threads);
+
+    return pointers;
+}
+
+template<typename Value_, typename Index_, class ValueStorage_, class TempIndexStorage_, class IndexStorage_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > build_sparse_matrix(const Index_ NR, const Index_ NC, ValueStorage_ values, TempIndexStorage_& primary, IndexStorage_ secondary, const LoadMatrixOptions& options) {
+    const bool row = options.row;
+    const Index_ num_primary = (row ? NR : NC);
+    const auto stats = options.statistics;
+    if (stats) {
+        stats->value_bytes = sizeof(typename ValueStorage_::value_type) * values.capacity();
+        stats->primary_bytes = sizeof(typename TempIndexStorage_::value_type) * primary.capacity();
+        stats->secondary_bytes = sizeof(typename IndexStorage_::value_type) * secondary.capacity();
+    }
+
+    Stopwatch watch;
+    if (options.tiled) {
+        // Tiles larger than the matrix are truncated so that they fit in Index_.
+        auto choose_tile = [](const std::size_t requested, const Index_ extent) -> Index_ {
+            if (requested >= static_cast<std::size_t>(extent)) {
+                return std::max(extent, static_cast<Index_>(1));
+            }
+            return requested;
+        };
+
+        std::size_t tile_pointer_bytes = 0;
+        auto output = create_tiled_sparse_matrix<Value_, Index_>(
+            NR,
+            NC,
+            std::move(values),
+            primary,
+            std::move(secondary),
+            row,
+            choose_tile(options.tile_nrow, NR),
+            choose_tile(options.tile_ncol, NC),
+            options.num_threads,
+            tile_pointer_bytes
+        );
+
+        if (stats) {
+            stats->compress_time = watch.lap();
+            stats->pointer_bytes = tile_pointer_bytes;
+        }
+        return output;
+    }
+
+    std::vector<std::size_t> indptr;
+    if (options.compress_threads > 1) {
+        indptr = parallel_compress_sparse_triplets(num_primary, values, primary, secondary, options.compress_threads);
+    } else {
+        indptr = tatami::compress_sparse_triplets(num_primary, values, primary, secondary);
+        TempIndexStorage_().swap(primary);
+    }
+
+    if (stats) {
+        stats->compress_time = watch.lap();
+        stats->pointer_bytes = sizeof(typename I<decltype(indptr)>::value_type) * indptr.capacity();
+    }
+
+    std::shared_ptr<tatami::Matrix<Value_, Index_> > output;
+    const int nthreads = options.first_touch_threads;
+    if (nthreads > 1) {
+        auto get_pointer = [&](const Index_ p) -> std::size_t { return indptr[p]; };
+        auto touched_values = first_touch_copy(values, num_primary, nthreads, get_pointer);
+        I<decltype(values)>().swap(values);
+        auto touched_indices = first_touch_copy(secondary, num_primary, nthreads, get_pointer);
+        I<decltype(secondary)>().swap(secondary);
+
+        // Each thread also touches the pointers for its slices, with the first thread handling the leading zero.
+        auto touched_pointers = first_touch_copy(indptr, num_primary, nthreads, [&](const Index_ p) -> std::size_t { return static_cast<std::size_t>(p) + (p > 0); });
+        if (num_primary == 0) {
+            touched_pointers[0] = 0;
+        }
+        output = create_sparse_matrix<Value_, Index_>(NR, NC, std::move(touched_values), std::move(touched_indices), std::move(touched_pointers), options);
+    } else {
+        output = create_sparse_matrix<Value_, Index_>(NR, NC, std::move(values), std::move(secondary), std::move(indptr), options);
+    }
+
+    if (stats) {
+        stats->construct_time = watch.lap();
+    }
+    return output;
+}
+
+// Mapping from each row of the file to a row of the loaded matrix, where discarded rows are mapped to the maximum value of Index_.
+// This is used to filter rows while parsing, e.g., by feature type in load_10x_bundle().
+template<typename Index_>
+struct RowRemapping {
+    const std::vector<Index_>* rows;
+    Index_ num_kept;
+};
+
+template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, typename TempIndex_, template<typename> class Allocator_, typename Parser_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_sparse_matrix_basic(Parser_& parser, const eminem::Field field, const eminem::Symmetry symmetry, const Index_ NR, const Index_ NC, const eminem::LineIndex NL, const LoadMatrixOptions& options, const RowRemapping<Index_>* remapping) {
+    const bool row = options.row;
+
+    // For symmetric matrices, each off-diagonal element is also stored at its mirrored position.
+    const bool mirror = (symmetry == eminem::Symmetry::SYMMETRIC || symmetry == eminem::Symmetry::SKEW_SYMMETRIC || symmetry == eminem::Symmetry::HERMITIAN);
+    const bool negate = (symmetry == eminem::Symmetry::SKEW_SYMMETRIC);
+    const auto reserved = (mirror ? sanisizer::product<I<decltype(NL)> >(NL, 2) : NL);
+
+    std::vector<TempIndex_, Allocator_<TempIndex_> > primary;
+    std::vector<StoredIndex_, Allocator_<StoredIndex_> > secondary;
+    std::vector<StoredValue_, Allocator_<StoredValue_> > values;
+    if (!remapping) {
+        // Only reserving if all rows are retained, otherwise we might overallocate when most rows are discarded.
+        primary.reserve(reserved);
+        secondary.reserve(reserved);
+        values.reserve(reserved);
+    }
+
+    const auto summaries = options.summaries;
+    unsigned long long lines_parsed = 0;
+    auto store = [&](Index_ r, const Index_ c, const StoredValue_ v) -> void {
+        ++lines_parsed; // counting before any filtering, as the line was still parsed.
+        if (remapping) {
+            const auto target = (*(remapping->rows))[r - 1];
+            if (target == std::numeric_limits<Index_>::max()) {
+                return;
+            }
+            r = target + 1;
+        }
+
+        if (row) {
+            values.push_back(v);
+            primary.push_back(r - 1);
+            secondary.push_back(c - 1);
+        } else {
+            values.push_back(v);
+            primary.push_back(c - 1);
+            secondary.push_back(r - 1);
+        }
+        if (summaries) {
+            add_summary(*summaries, r, c, v);
+        }
+
+        if (mirror && r != c) {
+            const StoredValue_ mirrored = (negate ? -v : v);
+            if (summaries) {
+                add_summary(*summaries, c, r, mirrored);
+            }
+            values.push_back(mirrored);
             if (row) {
-                values.push_back(v);
-                primary.push_back(r - 1);
-                secondary.push_back(c - 1);
-            } else {
-                values.push_back(v);
                 primary.push_back(c - 1);
                 secondary.push_back(r - 1);
+            } else {
+                primary.push_back(r - 1);
+                secondary.push_back(c - 1);
             }
+        }
+    };
+
+    Stopwatch watch;
+    if (field == eminem::Field::INTEGER) {
+        typedef typename std::conditional<std::is_integral<StoredValue_>::value, StoredValue_, int>::type ParseType;
+        parser.template scan_integer<ParseType>([&](const Index_ r, const Index_ c, const ParseType v) -> void {
+            store(r, c, v);
         });
 
     } else if (field == eminem::Field::REAL || field == eminem::Field::DOUBLE) {
         typedef typename std::conditional<std::is_floating_point<StoredValue_>::value, StoredValue_, double>::type ParseType;
         parser.template scan_real<ParseType>([&](const Index_ r, const Index_ c, const ParseType v) -> void {
-            if (row) {
-                values.push_back(v);
-                primary.push_back(r - 1);
-                secondary.push_back(c - 1);
-            } else {
-                values.push_back(v);
-                primary.push_back(c - 1);
-                secondary.push_back(r - 1);
-            }
+            store(r, c, v);
+        });
+
+    } else if (field == eminem::Field::PATTERN) {
+        parser.scan_pattern([&](const Index_ r, const Index_ c, bool) -> void {
+            store(r, c, 1);
         });
 
     } else {
         throw std::runtime_error("unsupported Matrix Market field type");
     }
 
-    auto indptr = tatami::compress_sparse_triplets((row ? NR : NC), values, primary, secondary);
-    return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
-        new tatami::CompressedSparseMatrix<Value_, Index_, I<decltype(values)>, I<decltype(secondary)>, I<decltype(indptr)> >(
-            NR, NC, std::move(values), std::move(secondary), std::move(indptr), row, false
-        )
-    );
+    if (options.statistics) {
+        options.statistics->parse_time = watch.lap();
+        options.statistics->lines_parsed = lines_parsed;
+    }
+
+    reorder_triplets(NR, NC, primary, secondary, options);
+
+    return build_sparse_matrix<Value_, Index_>(NR, NC, std::move(values), primary, std::move(secondary), options);
 }
 
-template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, typename TempIndex_, typename Parser_>
-std::shared_ptr<tatami::Matrix<Value_, Index_> > load_sparse_matrix_data(Parser_& parser, const eminem::Field field, const Index_ NR, const Index_ NC, const eminem::LineIndex NL, const bool row) {
+template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, typename TempIndex_, template<typename> class Allocator_, typename Parser_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_sparse_matrix_data(Parser_& parser, const eminem::Field field, const eminem::Symmetry symmetry, const Index_ NR, const Index_ NC, const eminem::LineIndex NL, const LoadMatrixOptions& options, const RowRemapping<Index_>* remapping) {
     if constexpr(std::is_same<StoredValue_, Automatic>::value) {
         if (field == eminem::Field::REAL || field == eminem::Field::DOUBLE) {
-            return load_sparse_matrix_basic<Value_, Index_, double, StoredIndex_, TempIndex_>(parser, field, NR, NC, NL, row);
+            return load_sparse_matrix_basic<Value_, Index_, double, StoredIndex_, TempIndex_, Allocator_>(parser, field, symmetry, NR, NC, NL, options, remapping);
         }
-        if (field != eminem::Field::INTEGER) {
+        if (field != eminem::Field::INTEGER && field != eminem::Field::PATTERN) {
             throw std::runtime_error("unsupported Matrix Market field type");
         }
-        return load_sparse_matrix_basic<Value_, Index_, int, StoredIndex_, TempIndex_>(parser, field, NR, NC, NL, row);
+        return load_sparse_matrix_basic<Value_, Index_, int, StoredIndex_, TempIndex_, Allocator_>(parser, field, symmetry, NR, NC, NL, options, remapping);
     } else {
-        return load_sparse_matrix_basic<Value_, Index_, StoredValue_, StoredIndex_, TempIndex_>(parser, field, NR, NC, NL, row);
+        return load_sparse_matrix_basic<Value_, Index_, StoredValue_, StoredIndex_, TempIndex_, Allocator_>(parser, field, symmetry, NR, NC, NL, options, remapping);
     }
 }
 
-template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, typename TempIndex_, typename Parser_>
-std::shared_ptr<tatami::Matrix<Value_, Index_> > load_sparse_matrix_index(Parser_& parser, const eminem::Field field, const Index_ NR, const Index_ NC, const eminem::LineIndex NL, const bool row) {
+template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, typename TempIndex_, template<typename> class Allocator_, typename Parser_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_sparse_matrix_index(Parser_& parser, const eminem::Field field, const eminem::Symmetry symmetry, const Index_ NR, const Index_ NC, const eminem::LineIndex NL, const LoadMatrixOptions& options, const RowRemapping<Index_>* remapping) {
     if constexpr(std::is_same<StoredIndex_, Automatic>::value) {
         // Automatically choosing a smaller integer type, if it fits.
         constexpr Index_ limit8 = std::numeric_limits<std::uint8_t>::max(), limit16 = std::numeric_limits<std::uint16_t>::max();
-        const auto target = (row ? NC : NR);
+        const auto target = (options.row ? NC : NR);
 
         if (target <= limit8) {
-            return load_sparse_matrix_data<Value_, Index_, StoredValue_, std::uint8_t, TempIndex_>(parser, field, NR, NC, NL, row);
+            return load_sparse_matrix_data<Value_, Index_, StoredValue_, std::uint8_t, TempIndex_, Allocator_>(parser, field, symmetry, NR, NC, NL, options, remapping);
         } else if (target <= limit16) {
-            return load_sparse_matrix_data<Value_, Index_, StoredValue_, std::uint16_t, TempIndex_>(parser, field, NR, NC, NL, row);
+            return load_sparse_matrix_data<Value_, Index_, StoredValue_, std::uint16_t, TempIndex_, Allocator_>(parser, field, symmetry, NR, NC, NL, options, remapping);
         } else {
-            return load_sparse_matrix_data<Value_, Index_, StoredValue_, std::uint32_t, TempIndex_>(parser, field, NR, NC, NL, row);
+            return load_sparse_matrix_data<Value_, Index_, StoredValue_, std::uint32_t, TempIndex_, Allocator_>(parser, field, symmetry, NR, NC, NL, options, remapping);
         }
 
     } else {
-        return load_sparse_matrix_data<Value_, Index_, StoredValue_, StoredIndex_, TempIndex_>(parser, field, NR, NC, NL, row);
+        return load_sparse_matrix_data<Value_, Index_, StoredValue_, StoredIndex_, TempIndex_, Allocator_>(parser, field, symmetry, NR, NC, NL, options, remapping);
     }
 }
 
-template<typename Value_, typename Index_, typename StoredValue_, typename Parser_>
-std::shared_ptr<tatami::Matrix<Value_, Index_> > load_dense_matrix_basic(Parser_& parser, const eminem::Field field, const Index_ NR, const Index_ NC, const bool row) {
-    std::vector<StoredValue_> values;
-    const auto full_size = sanisizer::product<I<decltype(values.size())> >(NR, NC);
-    if (row) {
-        values.resize(full_size);
-    } else {
-        values.reserve(full_size);
-    }
+// If 'values' is empty, column-major values are appended as they are parsed, as the Matrix Market ARRAY format is already column-major.
+// Otherwise, 'values' should already be allocated to the full size of the matrix.
+template<typename Value_, typename Index_, typename StoredValue_, class Storage_, typename Parser_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > fill_dense_matrix(Parser_& parser, const eminem::Field field, const Index_ NR, const Index_ NC, const LoadMatrixOptions& options, Storage_ values) {
+    const bool row = options.row;
+    const bool append = values.empty();
 
+    const auto summaries = options.summaries;
+    unsigned long long lines_parsed = 0;
+    auto store = [&](const Index_ r, const Index_ c, const StoredValue_ v) -> void {
+        ++lines_parsed;
+        if (summaries) {
+            add_summary(*summaries, r, c, v);
+        }
+        if (row) {
+            values[sanisizer::nd_offset<I<decltype(values.size())> >(c - 1, NC, r - 1)] = v;
+        } else if (append) {
+            values.push_back(v);
+        } else {
+            values[sanisizer::nd_offset<I<decltype(values.size())> >(r - 1, NR, c - 1)] = v;
+        }
+    };
+
+    Stopwatch watch;
     if (field == eminem::Field::INTEGER) {
         typedef typename std::conditional<std::is_integral<StoredValue_>::value, StoredValue_, int>::type ParseType;
         parser.template scan_integer<ParseType>([&](const Index_ r, const Index_ c, const ParseType v) -> void {
-            if (row) {
-                values[sanisizer::nd_offset<I<decltype(values.size())> >(c - 1, NC, r - 1)] = v;
-            } else {
-                values.push_back(v); // Matrix Market ARRAY format is already column-major
-            }
+            store(r, c, v);
         });
 
     } else if (field == eminem::Field::REAL || field == eminem::Field::DOUBLE) {
         typedef typename std::conditional<std::is_floating_point<StoredValue_>::value, StoredValue_, double>::type ParseType;
         parser.template scan_real<ParseType>([&](const Index_ r, const Index_ c, const ParseType v) -> void {
-            if (row) {
-                values[sanisizer::nd_offset<I<decltype(values.size())> >(c - 1, NC, r - 1)] = v;
-            } else {
-                values.push_back(v);
-            }
+            store(r, c, v);
         });
 
     } else {
         throw std::runtime_error("unsupported Matrix Market field type");
     }
 
-    return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
+    const auto stats = options.statistics;
+    if (stats) {
+        stats->parse_time = watch.lap();
+        stats->lines_parsed = lines_parsed;
+        stats->value_bytes = sizeof(StoredValue_) * values.capacity();
+    }
+
+    std::shared_ptr<tatami::Matrix<Value_, Index_> > output(
         new tatami::DenseMatrix<Value_, Index_, I<decltype(values)> >(NR, NC, std::move(values), row)
     );
+
+    if (stats) {
+        stats->construct_time = watch.lap();
+    }
+    return output;
 }
 
+template<typename Value_, typename Index_, typename StoredValue_, template<typename> class Allocator_, typename Parser_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_dense_matrix_basic(Parser_& parser, const eminem::Field field, const Index_ NR, const Index_ NC, const LoadMatrixOptions& options) {
+    typedef std::vector<StoredValue_, Allocator_<StoredValue_> > Storage;
+    const auto full_size = sanisizer::product<typename Storage::size_type>(NR, NC);
+    const bool row = options.row;
+
+    const int nthreads = options.first_touch_threads;
+    if (nthreads > 1) {
+        // Zeroing the contents on the threads that will later process each block of rows/columns, before the parser fills them in.
+        FirstTouchStorage<Storage> values(full_size);
+        const Index_ num_primary = (row ? NR : NC), num_secondary = (row ? NC : NR);
+        tatami::parallelize([&](int, const Index_ start, const Index_ length) -> void {
+            const auto first = sanisizer::product_unsafe<std::size_t>(start, num_secondary);
+            const auto last = sanisizer::product_unsafe<std::size_t>(start + length, num_secondary);
+            std::fill(values.begin() + first, values.begin() + last, static_cast<StoredValue_>(0));
+        }, num_primary, nthreads);
+        return fill_dense_matrix<Value_, Index_, StoredValue_>(parser, field, NR, NC, options, std::move(values));
+    }
+
+    Storage values;
+    if (row) {
+        values.resize(full_size);
+    } else {
+        values.reserve(full_size);
+    }
+    return fill_dense_matrix<Value_, Index_, StoredValue_>(parser, field, NR, NC, options, std::move(values));
 }
-/**
- * @endcond
- */
 
-/**
- * Load a `tatami::Matrix` from a Matrix Market file.
- * Coordinate formats will yield a sparse matrix, while array formats will yield a dense matrix.
- * The storage types depend on the Matrix Market field type as well as the settings of `StoredValue_` and `StoredIndex_`.
- *
- * @tparam Value_ Data type for the `tatami::Matrix` interface.
- * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
- * @tparam StoredValue_ Matrix data type that is stored in memory.
- * If set to `Automatic`, it defaults to `double` for real/double fields and `int` for integer fields.
- * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices.
- * If set to `Automatic`, it defaults to `uint8_t` if no dimension is greater than 255; `uint16_t` if no dimension is greater than 65536; and `int` otherwise.
- *
- * @param reader A `byteme::Reader` instance containing bytes from a Matrix Market file.
- * @param options Options for loading the matrix.
- *
- * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
- */
-template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
-std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix(byteme::Reader& reader, const LoadMatrixOptions& options) {
-    eminem::Parser<byteme::Reader*, Index_> parser(&reader, [&]{
+template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_, template<typename> class Allocator_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_remapped(byteme::Reader& reader, const LoadMatrixOptions& options, const RowRemapping<Index_>* remapping) {
+    // Only wrapping the reader when statistics are requested, to avoid the extra indirection otherwise.
+    byteme::Reader* rptr = &reader;
+    std::optional<ObservedReader> observed;
+    const auto stats = options.statistics;
+    if (stats) {
+        auto progress = std::move(stats->progress);
+        *stats = LoadStatistics();
+        stats->progress = std::move(progress);
+        observed.emplace(reader, *stats);
+        rptr = &(*observed);
+    }
+
+    eminem::Parser<byteme::Reader*, Index_> parser(rptr, [&]{
         eminem::ParserOptions eopt;
         eopt.buffer_size = options.buffer_size;
         eopt.num_threads = options.num_threads;
         return eopt;
     }());
 
+    Stopwatch watch;
     parser.scan_preamble();
+    if (stats) {
+        stats->preamble_time = watch.lap();
+    }
+
     const auto& banner = parser.get_banner();
     const auto field = banner.field;
     const auto format = banner.format;
-    const auto NR = parser.get_nrows(), NC = parser.get_ncols();
+    const auto NC = parser.get_ncols();
     const auto NL = parser.get_nlines();
+    auto NR = parser.get_nrows();
+    if (remapping) {
+        if (!sanisizer::is_equal(remapping->rows->size(), NR)) {
+            throw std::runtime_error("length of the row remapping should be equal to the number of rows in the file");
+        }
+        if (format != eminem::Format::COORDINATE || banner.symmetry != eminem::Symmetry::GENERAL) {
+            throw std::runtime_error("row filtering is only supported for general matrices in the coordinate format");
+        }
+        NR = remapping->num_kept;
+    }
+
+    if (options.summaries) {
+        reset_summaries(*(options.summaries), NR, NC);
+    }
+
+    if (options.tiled && (options.tile_nrow == 0 || options.tile_ncol == 0)) {
+        throw std::runtime_error("tile dimensions should be positive");
+    }
 
     if (format == eminem::Format::COORDINATE) {
         // Automatically choosing a smaller integer type for the temporary index.
@@ -227,29 +853,71 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix(byteme::Reader& rea
         const auto primary = (options.row ? NR : NC);
 
         if (sanisizer::is_less_than_or_equal(primary, limit8)) {
-            return internal::load_sparse_matrix_index<Value_, Index_, StoredValue_, StoredIndex_, std::uint8_t>(parser, field, NR, NC, NL, options.row);
+            return load_sparse_matrix_index<Value_, Index_, StoredValue_, StoredIndex_, std::uint8_t, Allocator_>(parser, field, banner.symmetry, NR, NC, NL, options, remapping);
         } else if (sanisizer::is_less_than_or_equal(primary, limit16)) {
-            return internal::load_sparse_matrix_index<Value_, Index_, StoredValue_, StoredIndex_, std::uint16_t>(parser, field, NR, NC, NL, options.row);
+            return load_sparse_matrix_index<Value_, Index_, StoredValue_, StoredIndex_, std::uint16_t, Allocator_>(parser, field, banner.symmetry, NR, NC, NL, options, remapping);
         } else {
-            return internal::load_sparse_matrix_index<Value_, Index_, StoredValue_, StoredIndex_, std::uint32_t>(parser, field, NR, NC, NL, options.row);
+            return load_sparse_matrix_index<Value_, Index_, StoredValue_, StoredIndex_, std::uint32_t, Allocator_>(parser, field, banner.symmetry, NR, NC, NL, options, remapping);
         }
 
     } else {
+        if (options.reorder_rows != ReorderMode::NONE || options.reorder_columns != ReorderMode::NONE) {
+            throw std::runtime_error("reordering is only supported for the coordinate format");
+        }
+        if (options.tiled) {
+            throw std::runtime_error("tiled output is only supported for the coordinate format");
+        }
+        if (options.ordering) {
+            set_identity_ordering(*(options.ordering), NR, NC);
+        }
+
         if constexpr(std::is_same<StoredValue_, Automatic>::value) {
             if (field == eminem::Field::REAL || field == eminem::Field::DOUBLE) {
-                return internal::load_dense_matrix_basic<Value_, Index_, double>(parser, field, NR, NC, options.row);
+                return load_dense_matrix_basic<Value_, Index_, double, Allocator_>(parser, field, NR, NC, options);
             }
             if (field != eminem::Field::INTEGER) {
                 throw std::runtime_error("unsupported Matrix Market field type");
             }
-            return internal::load_dense_matrix_basic<Value_, Index_, int>(parser, field, NR, NC, options.row);
+            return load_dense_matrix_basic<Value_, Index_, int, Allocator_>(parser, field, NR, NC, options);
 
         } else {
-            return internal::load_dense_matrix_basic<Value_, Index_, StoredValue_>(parser, field, NR, NC, options.row);
+            return load_dense_matrix_basic<Value_, Index_, StoredValue_, Allocator_>(parser, field, NR, NC, options);
         }
     }
 }
 
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Load a `tatami::Matrix` from a Matrix Market file.
+ * Coordinate formats will yield a sparse matrix, while array formats will yield a dense matrix.
+ * The storage types depend on the Matrix Market field type as well as the settings of `StoredValue_` and `StoredIndex_`.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory.
+ * If set to `Automatic`, it defaults to `double` for real/double fields and `int` for integer fields.
+ * For pattern fields in the coordinate format, all elements are stored as 1 and the type defaults to `int`.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices.
+ * If set to `Automatic`, it defaults to `uint8_t` if no dimension is greater than 255; `uint16_t` if no dimension is greater than 65536; and `int` otherwise.
+ * @tparam Allocator_ Allocator class template for the vectors of values and indices, e.g., to use huge pages or a memory pool.
+ * The returned `tatami::DenseMatrix` or `tatami::CompressedSparseMatrix` holds `std::vector`s with this allocator directly.
+ * Each allocator is default-constructed, so any state (e.g., an arena that is reused across loads) should be referenced through a global or thread-local variable.
+ * The vector of pointers for sparse matrices always uses the default allocator.
+ *
+ * @param reader A `byteme::Reader` instance containing bytes from a Matrix Market file.
+ * @param options Options for loading the matrix.
+ *
+ * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic, template<typename> class Allocator_ = std::allocator>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix(byteme::Reader& reader, const LoadMatrixOptions& options) {
+    return internal::load_matrix_remapped<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(reader, options, NULL);
+}
+
 /**
  * Load a `tatami::Matrix` from a Matrix Market text file, see `load_matrix()` for details.
  *
@@ -257,16 +925,17 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix(byteme::Reader& rea
  * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
  * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
  * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices,  see `load_matrix()` for details.
+ * @tparam Allocator_ Allocator for the stored vectors, see `load_matrix()` for details.
  *
  * @param filepath Path to a Matrix Market file.
  * @param options Options for loading the matrix.
  *
  * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
  */
-template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic, template<typename> class Allocator_ = std::allocator>
 std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_text_file(const char* filepath, const LoadMatrixOptions& options) {
     byteme::RawFileReader reader(filepath, {});
-    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(reader, options);
+    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(reader, options);
 }
 
 #if __has_include("zlib.h")
@@ -278,16 +947,17 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_text_file(cons
  * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
  * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
  * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices,  see `load_matrix()` for details.
+ * @tparam Allocator_ Allocator for the stored vectors, see `load_matrix()` for details.
  *
  * @param filepath Path to a Matrix Market file.
  * @param options Options for loading the matrix.
  *
  * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
  */
-template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic, template<typename> class Allocator_ = std::allocator>
 std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_gzip_file(const char* filepath, const LoadMatrixOptions& options) {
     byteme::GzipFileReader reader(filepath, {});
-    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(reader, options);
+    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(reader, options);
 }
 
 /**
@@ -297,13 +967,14 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_gzip_file(cons
  * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
  * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
  * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices,  see `load_matrix()` for details.
+ * @tparam Allocator_ Allocator for the stored vectors, see `load_matrix()` for details.
  *
  * @param filepath Path to a Matrix Market file.
  * @param options Options for loading the matrix.
  *
  * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
  */
-template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic, template<typename> class Allocator_ = std::allocator>
 std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_some_file(const char* filepath, const LoadMatrixOptions& options) {
     std::unique_ptr<byteme::Reader> ptr;
     if (byteme::is_gzip(filepath)) {
@@ -311,7 +982,7 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_some_file(cons
     } else  {
         ptr.reset(new byteme::RawFileReader(filepath, {}));
     }
-    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(*ptr, options);
+    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(*ptr, options);
 }
 
 #endif
@@ -323,6 +994,7 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_some_file(cons
  * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
  * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
  * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices,  see `load_matrix()` for details.
+ * @tparam Allocator_ Allocator for the stored vectors, see `load_matrix()` for details.
  *
  * @param buffer Array containing the contents of an uncompressed Matrix Market file.
  * @param n Length of the array.
@@ -330,10 +1002,10 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_some_file(cons
  * 
  * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
  */
-template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic, template<typename> class Allocator_ = std::allocator>
 std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_text_buffer(const unsigned char* buffer, const std::size_t n, const LoadMatrixOptions& options) {
     byteme::RawBufferReader reader(buffer, n);
-    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(reader, options);
+    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(reader, options);
 }
 
 #if __has_include("zlib.h")
@@ -345,6 +1017,7 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_text_buffer(co
  * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
  * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
  * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices,  see `load_matrix()` for details.
+ * @tparam Allocator_ Allocator for the stored vectors, see `load_matrix()` for details.
  *
  * @param buffer Array containing the contents of a Matrix Market file after Gzip/Zlib compression.
  * @param n Length of the array.
@@ -352,10 +1025,10 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_text_buffer(co
  * 
  * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
  */
-template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic, template<typename> class Allocator_ = std::allocator>
 std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_zlib_buffer(const unsigned char* buffer, const std::size_t n, const LoadMatrixOptions& options) {
     byteme::ZlibBufferReader reader(buffer, n, {});
-    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(reader, options);
+    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(reader, options);
 }
 
 /**
@@ -365,6 +1038,7 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_zlib_buffer(co
  * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
  * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
  * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices,  see `load_matrix()` for details.
+ * @tparam Allocator_ Allocator for the stored vectors, see `load_matrix()` for details.
  *
  * @param buffer Array containing the contents of a Matrix Market file, possibly after Gzip/Zlib compression.
  * @param n Length of the array.
@@ -372,7 +1046,7 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_zlib_buffer(co
  * 
  * @return Pointer to a `tatami::Matrix` instance containing data from the Matrix Market file.
  */
-template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic, template<typename> class Allocator_ = std::allocator>
 std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_some_buffer(const unsigned char* buffer, const std::size_t n, const LoadMatrixOptions& options) {
     std::unique_ptr<byteme::Reader> ptr;
     if (byteme::is_zlib_or_gzip(buffer, n)) {
@@ -380,7 +1054,7 @@ std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_from_some_buffer(co
     } else  {
         ptr.reset(new byteme::RawBufferReader(buffer, n));
     }
-    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(*ptr, options);
+    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_, Allocator_>(*ptr, options);
 }
 
 #endif
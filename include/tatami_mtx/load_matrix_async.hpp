@@ -0,0 +1,255 @@
+#ifndef TATAMI_MTX_LOAD_MATRIX_ASYNC_HPP
+#define TATAMI_MTX_LOAD_MATRIX_ASYNC_HPP
+
+#include "tatami/tatami.hpp"
+#include "byteme/byteme.hpp"
+
+#include <memory>
+#include <string>
+#include <future>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <stdexcept>
+
+#include "load_matrix.hpp"
+
+/**
+ * @file load_matrix_async.hpp
+ * @brief Load a **tatami** matrix asynchronously.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Exception thrown when an asynchronous load is cancelled.
+ */
+class LoadCancelled : public std::runtime_error {
+public:
+    /**
+     * @cond
+     */
+    LoadCancelled() : std::runtime_error("loading of the Matrix Market file was cancelled") {}
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @brief Control over an asynchronous load.
+ *
+ * This can be used to poll the progress of the load or to cancel it from another thread.
+ */
+class LoadControl {
+public:
+    /**
+     * @cond
+     */
+    LoadControl(unsigned long long total) : my_total(total) {}
+    /**
+     * @endcond
+     */
+
+    /**
+     * Request cancellation of the load.
+     * This is checked whenever more bytes are requested from the underlying `byteme::Reader`,
+     * after which the future will throw a `LoadCancelled` exception.
+     */
+    void cancel() {
+        my_cancelled = true;
+    }
+
+    /**
+     * @return Whether cancellation was requested.
+     */
+    bool is_cancelled() const {
+        return my_cancelled;
+    }
+
+    /**
+     * @return Number of (uncompressed) bytes that have been read so far.
+     */
+    unsigned long long bytes_read() const {
+        return my_read;
+    }
+
+    /**
+     * @return Total number of bytes to be read.
+     * This is zero if the total is not known in advance, e.g., for compressed files.
+     */
+    unsigned long long total_bytes() const {
+        return my_total;
+    }
+
+    /**
+     * @cond
+     */
+    void add_bytes(unsigned long long n) {
+        my_read += n;
+    }
+    /**
+     * @endcond
+     */
+
+private:
+    std::atomic<bool> my_cancelled = false;
+    std::atomic<unsigned long long> my_read = 0;
+    unsigned long long my_total;
+};
+
+/**
+ * @brief Result of an asynchronous load.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ */
+template<typename Value_, typename Index_>
+struct AsyncLoad {
+    /**
+     * Future containing the loaded matrix.
+     * Any errors during loading (including cancellation) are rethrown upon calling `std::future::get()`.
+     */
+    std::future<std::shared_ptr<tatami::Matrix<Value_, Index_> > > result;
+
+    /**
+     * Control over the load, for polling its progress or cancelling it.
+     */
+    std::shared_ptr<LoadControl> control;
+};
+
+/**
+ * @brief Options for `load_matrix_async()`.
+ */
+struct LoadMatrixAsyncOptions {
+    /**
+     * Options for loading the matrix, see `load_matrix()` for details.
+     */
+    LoadMatrixOptions load;
+
+    /**
+     * Executor to run the load, e.g., by submitting the task to a thread pool.
+     * This should eventually call the supplied function exactly once.
+     * If not provided, the load is run on a new thread via `std::async()`,
+     * in which case the destructor of `AsyncLoad::result` will block until the load is complete (or cancelled).
+     */
+    std::function<void(std::function<void()>)> executor;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+class MonitoredReader final : public byteme::Reader {
+public:
+    MonitoredReader(std::unique_ptr<byteme::Reader> reader, std::shared_ptr<LoadControl> control) : my_reader(std::move(reader)), my_control(std::move(control)) {}
+
+    std::size_t read(unsigned char* buffer, std::size_t n) {
+        if (my_control->is_cancelled()) {
+            throw LoadCancelled();
+        }
+        const auto available = my_reader->read(buffer, n);
+        my_control->add_bytes(available);
+        return available;
+    }
+
+private:
+    std::unique_ptr<byteme::Reader> my_reader;
+    std::shared_ptr<LoadControl> my_control;
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Load a `tatami::Matrix` from a Matrix Market file without blocking the calling thread.
+ * Progress can be polled and the load can be cancelled via `AsyncLoad::control`.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param open Function that accepts no arguments and returns a `std::unique_ptr<byteme::Reader>` for the Matrix Market file.
+ * This is called in the executor.
+ * @param total_bytes Total number of bytes that will be read from the reader, for reporting progress.
+ * This may be zero if unknown.
+ * @param options Options for loading the matrix.
+ *
+ * @return Future and control for the load.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+AsyncLoad<Value_, Index_> load_matrix_async(std::function<std::unique_ptr<byteme::Reader>()> open, const unsigned long long total_bytes, const LoadMatrixAsyncOptions& options) {
+    AsyncLoad<Value_, Index_> output;
+    output.control = std::make_shared<LoadControl>(total_bytes);
+
+    auto run = [open = std::move(open), control = output.control, load = options.load]() -> std::shared_ptr<tatami::Matrix<Value_, Index_> > {
+        if (control->is_cancelled()) {
+            throw LoadCancelled();
+        }
+        internal::MonitoredReader reader(open(), control);
+        return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(reader, load);
+    };
+
+    if (!options.executor) {
+        output.result = std::async(std::launch::async, std::move(run));
+        return output;
+    }
+
+    auto task = std::make_shared<std::packaged_task<std::shared_ptr<tatami::Matrix<Value_, Index_> >()> >(std::move(run));
+    output.result = task->get_future();
+    options.executor([task]() -> void {
+        (*task)();
+    });
+    return output;
+}
+
+/**
+ * Load a `tatami::Matrix` from a possibly Gzip-compressed Matrix Market file without blocking the calling thread, see `load_matrix_async()` for details.
+ * For uncompressed files, `LoadControl::total_bytes()` reports the file size.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param filepath Path to a Matrix Market file.
+ * @param options Options for loading the matrix.
+ *
+ * @return Future and control for the load.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+AsyncLoad<Value_, Index_> load_matrix_from_some_file_async(const char* filepath, const LoadMatrixAsyncOptions& options) {
+    std::string path(filepath);
+    bool gzip = false;
+#if __has_include("zlib.h")
+    gzip = byteme::is_gzip(filepath);
+#endif
+
+    unsigned long long total = 0;
+    if (!gzip) {
+        std::ifstream input(path, std::ios::binary | std::ios::ate);
+        if (!input) {
+            throw std::runtime_error("failed to open the Matrix Market file at '" + path + "'");
+        }
+        total = input.tellg();
+    }
+
+    return load_matrix_async<Value_, Index_, StoredValue_, StoredIndex_>([path, gzip]() -> std::unique_ptr<byteme::Reader> {
+        std::unique_ptr<byteme::Reader> ptr;
+#if __has_include("zlib.h")
+        if (gzip) {
+            ptr.reset(new byteme::GzipFileReader(path.c_str(), {}));
+            return ptr;
+        }
+#endif
+        ptr.reset(new byteme::RawFileReader(path.c_str(), {}));
+        return ptr;
+    }, total, options);
+}
+
+}
+
+#endif
@@ -0,0 +1,408 @@
+#ifndef TATAMI_MTX_LOAD_MATRIX_RANGE_HPP
+#define TATAMI_MTX_LOAD_MATRIX_RANGE_HPP
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+#include "byteme/byteme.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <cctype>
+#include <utility>
+
+#include "utils.hpp"
+#include "load_matrix.hpp"
+
+/**
+ * @file load_matrix_range.hpp
+ * @brief Load part of a Matrix Market file, e.g., for distributed loading.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @cond
+ */
+namespace internal {
+
+struct MatrixPreamble {
+    std::string banner;
+    std::string nrow, ncol;
+    unsigned long long body_start = 0;
+};
+
+inline MatrixPreamble read_matrix_preamble(std::istream& input) {
+    MatrixPreamble output;
+    std::string line;
+    unsigned long long position = 0;
+    bool first = true;
+
+    while (std::getline(input, line)) {
+        position += line.size() + 1;
+        if (first) {
+            output.banner = line;
+            first = false;
+
+            std::string lower(line);
+            for (auto& x : lower) {
+                x = std::tolower(static_cast<unsigned char>(x));
+            }
+            if (lower.rfind("%%matrixmarket", 0) != 0) {
+                throw std::runtime_error("Matrix Market file should start with a '%%MatrixMarket' banner");
+            }
+            if (lower.find("coordinate") == std::string::npos) {
+                throw std::runtime_error("partial loading is only supported for the coordinate format");
+            }
+            continue;
+        }
+
+        if (line.empty() || line[0] == '%') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        if (!(fields >> output.nrow >> output.ncol)) {
+            throw std::runtime_error("failed to parse the size line of the Matrix Market file");
+        }
+        output.body_start = position;
+        return output;
+    }
+
+    throw std::runtime_error("failed to find the size line of the Matrix Market file");
+}
+
+// Calls 'visit(offset, initial)' for the start of each line from 'position' onwards, where 'initial' is the first byte of the line.
+// If 'at_start = false', 'position' is assumed to be in the middle of a line, which is skipped.
+// Scanning stops when 'visit' returns false, in which case the offset of the current line is returned; otherwise, the end of the file is returned.
+template<class Visit_>
+unsigned long long visit_line_starts(std::istream& input, unsigned long long position, bool at_start, Visit_ visit) {
+    input.clear();
+    input.seekg(position);
+    std::vector<char> buffer(65536);
+    while (input) {
+        input.read(buffer.data(), buffer.size());
+        const std::size_t available = input.gcount();
+        for (std::size_t i = 0; i < available; ++i, ++position) {
+            if (at_start && !visit(position, buffer[i])) {
+                return position;
+            }
+            at_start = (buffer[i] == '\n');
+        }
+    }
+    return position;
+}
+
+inline bool is_data_line(const char initial) {
+    return initial != '\n' && initial != '\r' && initial != '%';
+}
+
+// Streams a replacement preamble followed by the bytes in [start, end) of a file.
+// This allows the selected lines to be parsed by load_matrix() without copying the body of the file into memory.
+class PartialFileReader final : public byteme::Reader {
+public:
+    PartialFileReader(const char* filepath, std::string preamble, const unsigned long long start, const unsigned long long end) :
+        my_input(filepath, std::ios::binary),
+        my_preamble(std::move(preamble)),
+        my_remaining(end - start)
+    {
+        if (!my_input) {
+            throw std::runtime_error("failed to open the Matrix Market file at '" + std::string(filepath) + "'");
+        }
+        my_input.seekg(start);
+    }
+
+    std::size_t read(unsigned char* buffer, std::size_t n) {
+        std::size_t filled = 0;
+        if (my_preamble_used < my_preamble.size()) {
+            filled = std::min(n, my_preamble.size() - my_preamble_used);
+            std::copy_n(my_preamble.data() + my_preamble_used, filled, buffer);
+            my_preamble_used += filled;
+        }
+
+        const auto requested = static_cast<std::size_t>(std::min<unsigned long long>(n - filled, my_remaining));
+        if (requested) {
+            my_input.read(reinterpret_cast<char*>(buffer + filled), requested);
+            const std::size_t available = my_input.gcount();
+            filled += available;
+            my_remaining = (available < requested ? 0 : my_remaining - available);
+        }
+        return filled;
+    }
+
+private:
+    std::ifstream my_input;
+    std::string my_preamble;
+    std::size_t my_preamble_used = 0;
+    unsigned long long my_remaining;
+};
+
+// Loads the line-aligned window [start, end) of the body, which contains 'num_lines' data lines.
+template<typename Value_, typename Index_, typename StoredValue_, typename StoredIndex_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_partial_file(
+    const char* filepath,
+    const MatrixPreamble& preamble,
+    const unsigned long long start,
+    const unsigned long long end,
+    const unsigned long long num_lines,
+    const LoadMatrixOptions& options
+) {
+    PartialFileReader reader(filepath, preamble.banner + "\n" + preamble.nrow + " " + preamble.ncol + " " + std::to_string(num_lines) + "\n", start, end);
+    return load_matrix<Value_, Index_, StoredValue_, StoredIndex_>(reader, options);
+}
+
+// Reordering, orderings and summaries would be computed separately for each range, so they cannot be combined by merge_partial_matrices().
+inline void check_partial_options(const LoadMatrixOptions& options) {
+    if (options.reorder_rows != ReorderMode::NONE || options.reorder_columns != ReorderMode::NONE) {
+        throw std::runtime_error("reordering is not supported for partial loading");
+    }
+    if (options.ordering || options.summaries) {
+        throw std::runtime_error("orderings and summaries are not supported for partial loading");
+    }
+}
+
+inline std::ifstream open_matrix_file(const char* filepath) {
+    std::ifstream input(filepath, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("failed to open the Matrix Market file at '" + std::string(filepath) + "'");
+    }
+    return input;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Load the lines of an uncompressed Matrix Market file that start within a byte range.
+ * Each line is assigned to the range containing its first byte, so a file can be split into contiguous byte ranges (e.g., of equal size) that are loaded by different workers;
+ * the loaded matrices can then be combined with `merge_partial_matrices()`.
+ * Lines in the preamble are ignored, so the first range can start at zero.
+ * The line-aligned window of the range is streamed directly from the file to the parser, after a single pass to count its lines.
+ *
+ * The returned matrix has the global dimensions of the file but only contains the elements in the range.
+ * Only the coordinate format is supported.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param filepath Path to an uncompressed Matrix Market file.
+ * @param start Offset of the first byte of the range.
+ * @param end Offset of one past the last byte of the range.
+ * @param options Options for loading the matrix.
+ * The reordering options, `LoadMatrixOptions::ordering` and `LoadMatrixOptions::summaries` are not supported as they would be inconsistent across ranges.
+ *
+ * @return Pointer to a `tatami::Matrix` instance containing the elements in the range.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_byte_range(const char* filepath, const unsigned long long start, const unsigned long long end, const LoadMatrixOptions& options) {
+    internal::check_partial_options(options);
+    auto input = internal::open_matrix_file(filepath);
+    const auto preamble = internal::read_matrix_preamble(input);
+    const auto position = std::max(start, preamble.body_start);
+    unsigned long long window_start = position, window_end = position, num_lines = 0;
+
+    if (position < end) {
+        // Skipping the partial line at the start of the range, unless the range already starts at a line boundary.
+        bool at_start = (position == preamble.body_start);
+        if (!at_start) {
+            input.clear();
+            input.seekg(position - 1);
+            char previous;
+            at_start = (input.get(previous) && previous == '\n');
+        }
+
+        bool found = false;
+        window_end = internal::visit_line_starts(input, position, at_start, [&](const unsigned long long offset, const char initial) -> bool {
+            if (offset >= end) {
+                return false;
+            }
+            if (!found) {
+                window_start = offset;
+                found = true;
+            }
+            num_lines += internal::is_data_line(initial);
+            return true;
+        });
+        if (!found) {
+            window_start = window_end;
+        }
+    }
+
+    return internal::load_partial_file<Value_, Index_, StoredValue_, StoredIndex_>(filepath, preamble, window_start, window_end, num_lines, options);
+}
+
+/**
+ * Load a range of lines from the body of an uncompressed Matrix Market file, see `load_matrix_byte_range()` for details.
+ * This requires reading all lines before the range, so `load_matrix_byte_range()` should be preferred for large files.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory, see `load_matrix()` for details.
+ * @tparam StoredIndex_ Index data type that is stored in memory for sparse matrices, see `load_matrix()` for details.
+ *
+ * @param filepath Path to an uncompressed Matrix Market file.
+ * @param first Index of the first line in the range, where the first line after the size line has an index of zero.
+ * @param last Index of one past the last line in the range.
+ * @param options Options for loading the matrix, see `load_matrix_byte_range()` for the unsupported options.
+ *
+ * @return Pointer to a `tatami::Matrix` instance containing the elements in the range.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > load_matrix_line_range(const char* filepath, const unsigned long long first, const unsigned long long last, const LoadMatrixOptions& options) {
+    internal::check_partial_options(options);
+    auto input = internal::open_matrix_file(filepath);
+    const auto preamble = internal::read_matrix_preamble(input);
+    unsigned long long line = 0, num_lines = 0;
+    bool found = false;
+    unsigned long long window_start = 0;
+
+    const auto window_end = internal::visit_line_starts(input, preamble.body_start, true, [&](const unsigned long long offset, const char initial) -> bool {
+        if (line >= last) {
+            return false;
+        }
+        if (line >= first) {
+            if (!found) {
+                window_start = offset;
+                found = true;
+            }
+            num_lines += internal::is_data_line(initial);
+        }
+        ++line;
+        return true;
+    });
+    if (!found) {
+        window_start = window_end;
+    }
+
+    return internal::load_partial_file<Value_, Index_, StoredValue_, StoredIndex_>(filepath, preamble, window_start, window_end, num_lines, options);
+}
+
+/**
+ * @brief Options for `merge_partial_matrices()`.
+ */
+struct MergePartialMatricesOptions {
+    /**
+     * Whether to produce a compressed sparse row matrix.
+     * If false, a compressed sparse column matrix is returned instead.
+     */
+    bool row = true;
+
+    /**
+     * Number of threads to use for merging.
+     */
+    int num_threads = 1;
+};
+
+/**
+ * Merge partial matrices, typically created by `load_matrix_byte_range()` or `load_matrix_line_range()` for disjoint ranges of the same file.
+ * The structural non-zero elements of all partial matrices are combined into a single compressed sparse matrix.
+ * Each position should be present in at most one partial matrix.
+ *
+ * @tparam Value_ Data type for the `tatami::Matrix` interface.
+ * @tparam Index_ Integer index type for the `tatami::Matrix` interface.
+ * @tparam StoredValue_ Matrix data type that is stored in memory.
+ * @tparam StoredIndex_ Index data type that is stored in memory.
+ *
+ * @param partials Pointers to the partial matrices, all of which should have the same dimensions.
+ * @param options Options for merging.
+ *
+ * @return Pointer to a `tatami::Matrix` instance containing the merged data.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Value_, typename StoredIndex_ = Index_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > merge_partial_matrices(const std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > >& partials, const MergePartialMatricesOptions& options) {
+    if (partials.empty()) {
+        throw std::runtime_error("at least one partial matrix should be supplied");
+    }
+    const Index_ NR = partials.front()->nrow(), NC = partials.front()->ncol();
+    for (const auto& part : partials) {
+        if (part->nrow() != NR || part->ncol() != NC) {
+            throw std::runtime_error("all partial matrices should have the same dimensions");
+        }
+    }
+
+    const bool row = options.row;
+    const Index_ num_primary = (row ? NR : NC);
+    const Index_ num_secondary = (row ? NC : NR);
+
+    // First pass to count the number of elements in each primary slice.
+    auto pointers = sanisizer::create<std::vector<std::size_t> >(sanisizer::sum<std::size_t>(num_primary, 1));
+    tatami::parallelize([&](int, Index_ start, Index_ length) -> void {
+        tatami::Options opt;
+        opt.sparse_extract_index = false;
+        opt.sparse_extract_value = false;
+        for (const auto& part : partials) {
+            auto ext = tatami::consecutive_extractor<true>(*part, row, start, length, opt);
+            for (Index_ p = start, end = start + length; p < end; ++p) {
+                pointers[p + 1] += ext->fetch(NULL, NULL).number;
+            }
+        }
+    }, num_primary, options.num_threads);
+
+    for (Index_ p = 0; p < num_primary; ++p) {
+        pointers[p + 1] += pointers[p];
+    }
+
+    // Second pass to fill each slice, sorting by index if multiple partial matrices contribute to the same slice.
+    auto values = sanisizer::create<std::vector<StoredValue_> >(pointers.back());
+    auto indices = sanisizer::create<std::vector<StoredIndex_> >(pointers.back());
+    tatami::parallelize([&](int, Index_ start, Index_ length) -> void {
+        std::vector<std::size_t> cursors(pointers.begin() + start, pointers.begin() + start + length);
+        auto vbuffer = sanisizer::create<std::vector<Value_> >(num_secondary);
+        auto ibuffer = sanisizer::create<std::vector<Index_> >(num_secondary);
+        for (const auto& part : partials) {
+            auto ext = tatami::consecutive_extractor<true>(*part, row, start, length);
+            for (Index_ p = 0; p < length; ++p) {
+                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                auto& cursor = cursors[p];
+                std::copy_n(range.value, range.number, values.begin() + cursor);
+                std::copy_n(range.index, range.number, indices.begin() + cursor);
+                cursor += range.number;
+            }
+        }
+
+        std::vector<std::size_t> order;
+        std::vector<StoredValue_> sorted_values;
+        std::vector<StoredIndex_> sorted_indices;
+        for (Index_ p = start, end = start + length; p < end; ++p) {
+            const auto ibegin = indices.begin() + pointers[p], iend = indices.begin() + pointers[p + 1];
+            if (std::is_sorted(ibegin, iend)) {
+                continue;
+            }
+
+            const auto num = pointers[p + 1] - pointers[p];
+            order.resize(num);
+            std::iota(order.begin(), order.end(), static_cast<std::size_t>(0));
+            std::sort(order.begin(), order.end(), [&](std::size_t left, std::size_t right) -> bool { return ibegin[left] < ibegin[right]; });
+
+            const auto vbegin = values.begin() + pointers[p];
+            sorted_values.clear();
+            sorted_indices.clear();
+            for (auto o : order) {
+                sorted_values.push_back(vbegin[o]);
+                sorted_indices.push_back(ibegin[o]);
+            }
+            std::copy(sorted_values.begin(), sorted_values.end(), vbegin);
+            std::copy(sorted_indices.begin(), sorted_indices.end(), ibegin);
+        }
+    }, num_primary, options.num_threads);
+
+    return std::shared_ptr<tatami::Matrix<Value_, Index_> >(
+        new tatami::CompressedSparseMatrix<Value_, Index_, I<decltype(values)>, I<decltype(indices)>, I<decltype(pointers)> >(
+            NR, NC, std::move(values), std::move(indices), std::move(pointers), row, false
+        )
+    );
+}
+
+}
+
+#endif
@@ -0,0 +1,308 @@
+#ifndef TATAMI_MTX_PARALLEL_ZLIB_WRITER_HPP
+#define TATAMI_MTX_PARALLEL_ZLIB_WRITER_HPP
+
+#if __has_include("zlib.h")
+
+#include "zlib.h"
+#include "byteme/byteme.hpp"
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <future>
+#include <limits>
+#include <algorithm>
+
+#include "utils.hpp"
+
+/**
+ * @file parallel_zlib_writer.hpp
+ * @brief Multi-threaded Gzip/Zlib compression for writing Matrix Market files.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Options for `ParallelZlibWriter`.
+ */
+struct ParallelZlibWriterOptions {
+    /**
+     * Compression mode for the output stream.
+     * This should be one of `DEFLATE`, `ZLIB` or `GZIP`.
+     */
+    byteme::ZlibCompressionMode mode = byteme::ZlibCompressionMode::GZIP;
+
+    /**
+     * Compression level for the Zlib library, from 0 (no compression) to 9 (maximum compression).
+     */
+    int compression_level = 6;
+
+    /**
+     * Number of uncompressed bytes in each block.
+     * Each block is compressed independently, so larger values improve the compression ratio at the cost of memory usage.
+     * This should be positive.
+     */
+    std::size_t block_size = sanisizer::cap<std::size_t>(131072);
+
+    /**
+     * Number of threads to use for compression.
+     * This should be positive.
+     */
+    int num_threads = 1;
+};
+
+/**
+ * @brief Compress bytes with multiple threads before passing them to another `byteme::Writer`.
+ *
+ * Incoming bytes are cut into blocks of fixed size, and each block is deflated on its own thread.
+ * All but the last block are terminated by a sync flush so that their compressed contents can be concatenated into a single Deflate stream.
+ * The checksums of the individual blocks are then combined for the Gzip/Zlib trailer, such that the output is a valid single-member stream that can be read by any Gzip/Zlib decompressor.
+ * This approach is similar to that used by **pigz**.
+ *
+ * Compression of each batch of blocks is performed in the background while the next batch is being filled,
+ * so formatting of the Matrix Market file can proceed concurrently with compression.
+ */
+class ParallelZlibWriter final : public byteme::Writer {
+public:
+    /**
+     * @param sink Pointer to a `byteme::Writer` instance to receive the compressed bytes.
+     * This should outlive the `ParallelZlibWriter`.
+     * `sink->finish()` will be called by `finish()`.
+     * @param options Further options.
+     */
+    ParallelZlibWriter(byteme::Writer* sink, const ParallelZlibWriterOptions& options) :
+        my_sink(sink),
+        my_mode(options.mode),
+        my_level(options.compression_level),
+        my_block_size(options.block_size),
+        my_num_threads(options.num_threads)
+    {
+        if (my_block_size == 0) {
+            throw std::runtime_error("block size should be positive");
+        }
+        if (my_num_threads < 1) {
+            throw std::runtime_error("number of threads should be positive");
+        }
+
+        my_filling.resize(sanisizer::cast<I<decltype(my_filling.size())> >(my_num_threads));
+        my_compressing.resize(my_filling.size());
+        for (auto& block : my_filling) {
+            block.input.reserve(my_block_size);
+        }
+
+        my_checksum = (my_mode == byteme::ZlibCompressionMode::GZIP ? crc32(0, NULL, 0) : adler32(0, NULL, 0));
+        write_header();
+    }
+
+    /**
+     * @cond
+     */
+    ~ParallelZlibWriter() {
+        // Making sure the background compression is done before the blocks are destroyed.
+        if (my_future.valid()) {
+            try {
+                my_future.get();
+            } catch (...) {}
+        }
+    }
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param buffer Pointer to an array of bytes to be compressed.
+     * @param n Length of the array.
+     */
+    void write(const unsigned char* buffer, std::size_t n) {
+        while (n > 0) {
+            auto& current = my_filling[my_num_filled].input;
+            const auto to_add = std::min(n, my_block_size - current.size());
+            current.insert(current.end(), buffer, buffer + to_add);
+            buffer += to_add;
+            n -= to_add;
+
+            if (current.size() == my_block_size) {
+                ++my_num_filled;
+                if (sanisizer::is_equal(my_num_filled, my_filling.size())) {
+                    dispatch(false);
+                }
+            }
+        }
+    }
+
+    /**
+     * Compress all remaining bytes, write the trailer and call `finish()` on the sink.
+     */
+    void finish() {
+        // The partially filled block (which may be empty) terminates the stream.
+        ++my_num_filled;
+        dispatch(true);
+        flush_compressed();
+        write_trailer();
+        my_sink->finish();
+    }
+
+private:
+    struct Block {
+        std::vector<unsigned char> input;
+        std::vector<unsigned char> output;
+        std::size_t output_size = 0;
+        uLong checksum = 0;
+        bool last = false;
+    };
+
+    byteme::Writer* my_sink;
+    byteme::ZlibCompressionMode my_mode;
+    int my_level;
+    std::size_t my_block_size;
+    int my_num_threads;
+
+    std::vector<Block> my_filling, my_compressing;
+    I<decltype(my_filling.size())> my_num_filled = 0, my_num_compressing = 0;
+    std::future<void> my_future;
+
+    uLong my_checksum;
+    unsigned long long my_total_input = 0;
+
+private:
+    void write_header() {
+        if (my_mode == byteme::ZlibCompressionMode::GZIP) {
+            // ID1, ID2, CM = deflate, no flags, no modification time, no extra flags, unknown OS.
+            const unsigned char header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 255 };
+            my_sink->write(header, 10);
+
+        } else if (my_mode == byteme::ZlibCompressionMode::ZLIB) {
+            // Deflate with a 32 kB window, and the compression level hint in FLEVEL.
+            const unsigned cmf = 0x78;
+            unsigned flevel;
+            if (my_level >= 0 && my_level < 2) {
+                flevel = 0;
+            } else if (my_level >= 2 && my_level < 6) {
+                flevel = 1;
+            } else if (my_level == 6 || my_level < 0) {
+                flevel = 2;
+            } else {
+                flevel = 3;
+            }
+            unsigned flg = flevel << 6;
+            flg += (31 - (cmf * 256 + flg) % 31) % 31;
+            const unsigned char header[2] = { static_cast<unsigned char>(cmf), static_cast<unsigned char>(flg) };
+            my_sink->write(header, 2);
+        }
+    }
+
+    void write_trailer() {
+        if (my_mode == byteme::ZlibCompressionMode::GZIP) {
+            unsigned char trailer[8];
+            const auto isize = static_cast<unsigned long>(my_total_input & 0xffffffffu);
+            for (int i = 0; i < 4; ++i) {
+                trailer[i] = (my_checksum >> (8 * i)) & 0xff;
+                trailer[i + 4] = (isize >> (8 * i)) & 0xff;
+            }
+            my_sink->write(trailer, 8);
+
+        } else if (my_mode == byteme::ZlibCompressionMode::ZLIB) {
+            unsigned char trailer[4];
+            for (int i = 0; i < 4; ++i) {
+                trailer[i] = (my_checksum >> (8 * (3 - i))) & 0xff; // big-endian for Zlib.
+            }
+            my_sink->write(trailer, 4);
+        }
+    }
+
+    void compress(Block& block) const {
+        const bool gzip = (my_mode == byteme::ZlibCompressionMode::GZIP);
+        const auto len = block.input.size();
+        block.checksum = (gzip ? crc32(0, NULL, 0) : adler32(0, NULL, 0));
+        if (len) {
+            block.checksum = (gzip ? crc32(block.checksum, block.input.data(), len) : adler32(block.checksum, block.input.data(), len));
+        }
+
+        z_stream strm;
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        if (deflateInit2(&strm, my_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("failed to initialize the Zlib compression stream");
+        }
+
+        // Some padding for the sync flush marker, which is not included in deflateBound().
+        block.output.resize(deflateBound(&strm, len) + 16);
+        strm.next_in = block.input.data();
+        strm.avail_in = len;
+        strm.next_out = block.output.data();
+        strm.avail_out = block.output.size();
+
+        const int flush = (block.last ? Z_FINISH : Z_SYNC_FLUSH);
+        int ret;
+        while (1) {
+            ret = deflate(&strm, flush);
+            if (ret == Z_STREAM_ERROR) {
+                break;
+            }
+            if (strm.avail_out > 0 && strm.avail_in == 0 && (!block.last || ret == Z_STREAM_END)) {
+                break;
+            }
+
+            // Resizing the output buffer, which should be very rare.
+            const auto used = block.output.size() - strm.avail_out;
+            block.output.resize(block.output.size() * 2);
+            strm.next_out = block.output.data() + used;
+            strm.avail_out = block.output.size() - used;
+        }
+
+        block.output_size = block.output.size() - strm.avail_out;
+        deflateEnd(&strm);
+        if (ret == Z_STREAM_ERROR) {
+            throw std::runtime_error("failed to compress block with Zlib");
+        }
+    }
+
+    void flush_compressed() {
+        if (!my_future.valid()) {
+            return;
+        }
+        my_future.get();
+
+        const bool gzip = (my_mode == byteme::ZlibCompressionMode::GZIP);
+        for (I<decltype(my_num_compressing)> b = 0; b < my_num_compressing; ++b) {
+            auto& block = my_compressing[b];
+            my_sink->write(block.output.data(), block.output_size);
+
+            const auto len = block.input.size();
+            my_checksum = (gzip ? crc32_combine(my_checksum, block.checksum, len) : adler32_combine(my_checksum, block.checksum, len));
+            my_total_input += len;
+            block.input.clear();
+        }
+        my_num_compressing = 0;
+    }
+
+    void dispatch(bool last) {
+        // Waiting for the previous batch to finish, and then swapping it with the newly filled batch.
+        flush_compressed();
+        my_filling.swap(my_compressing);
+        my_num_compressing = my_num_filled;
+        my_num_filled = 0;
+
+        for (I<decltype(my_num_compressing)> b = 0; b < my_num_compressing; ++b) {
+            my_compressing[b].last = (last && b + 1 == my_num_compressing);
+        }
+
+        my_future = std::async(std::launch::async, [&]() -> void {
+            tatami::parallelize([&](int, I<decltype(my_num_compressing)> start, I<decltype(my_num_compressing)> length) -> void {
+                for (I<decltype(start)> b = start, end = start + length; b < end; ++b) {
+                    compress(my_compressing[b]);
+                }
+            }, my_num_compressing, my_num_threads);
+        });
+    }
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef TATAMI_MTX_STATISTICS_HPP
+#define TATAMI_MTX_STATISTICS_HPP
+
+#include "byteme/byteme.hpp"
+
+#include <cstddef>
+#include <chrono>
+#include <functional>
+
+/**
+ * @file statistics.hpp
+ * @brief Instrumentation for loading and writing Matrix Market files.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Statistics collected by `load_matrix()`.
+ *
+ * An instance of this class can be supplied via `LoadMatrixOptions::statistics`, in which case its fields are overwritten by each call to `load_matrix()`.
+ * All times are wall-clock durations in seconds.
+ */
+struct LoadStatistics {
+    /**
+     * Time spent scanning the banner, comments and the size line.
+     */
+    double preamble_time = 0;
+
+    /**
+     * Time spent in `byteme::Reader::read()`, including any decompression.
+     * If `LoadMatrixOptions::num_threads` is greater than 1, reading is performed concurrently with parsing.
+     */
+    double read_time = 0;
+
+    /**
+     * Time spent scanning the body of the file.
+     * This includes `read_time` if reading is performed on the same thread as parsing.
+     */
+    double parse_time = 0;
+
+    /**
+     * Time spent sorting the triplets and computing the pointers for a sparse matrix.
+     * If `LoadMatrixOptions::tiled = true`, this also includes the construction of the tiles.
+     * This is always zero for the array format.
+     */
+    double compress_time = 0;
+
+    /**
+     * Time spent constructing the `tatami::Matrix`, including the delta encoding of indices if `LoadMatrixOptions::delta_varint_indices = true`.
+     */
+    double construct_time = 0;
+
+    /**
+     * Number of (uncompressed) bytes read from the `byteme::Reader`.
+     */
+    unsigned long long bytes_read = 0;
+
+    /**
+     * Number of lines in the body of the file that were parsed.
+     */
+    unsigned long long lines_parsed = 0;
+
+    /**
+     * Capacity of the temporary vector of values, in bytes.
+     * For the array format, this is the storage of the dense matrix itself.
+     */
+    std::size_t value_bytes = 0;
+
+    /**
+     * Capacity of the temporary vector of primary indices for the coordinate format, in bytes.
+     */
+    std::size_t primary_bytes = 0;
+
+    /**
+     * Capacity of the vector of secondary indices for the coordinate format, in bytes.
+     */
+    std::size_t secondary_bytes = 0;
+
+    /**
+     * Capacity of the vector of pointers for the coordinate format, in bytes.
+     * If `LoadMatrixOptions::tiled = true`, this is the total size of the pointers of all non-empty tiles.
+     */
+    std::size_t pointer_bytes = 0;
+
+    /**
+     * Optional callback to report progress, which is called with the cumulative number of bytes read whenever more bytes are requested from the `byteme::Reader`.
+     * If `LoadMatrixOptions::num_threads` is greater than 1, this is called from the reading thread.
+     * This is not modified by `load_matrix()`.
+     */
+    std::function<void(unsigned long long)> progress;
+};
+
+/**
+ * @brief Statistics collected by `write_matrix()`.
+ *
+ * An instance of this class can be supplied via `WriteMatrixOptions::statistics`, in which case its fields are overwritten by each call to `write_matrix()`.
+ * All times are wall-clock durations in seconds.
+ */
+struct WriteStatistics {
+    /**
+     * Time spent detecting symmetry and counting the number of elements to be written in the coordinate format.
+     * This is always zero for the array format.
+     */
+    double count_time = 0;
+
+    /**
+     * Total time spent in `write_matrix()`, including `count_time`.
+     */
+    double total_time = 0;
+
+    /**
+     * Number of (uncompressed) bytes passed to the `byteme::Writer`.
+     */
+    unsigned long long bytes_written = 0;
+
+    /**
+     * Number of lines written in the body of the file, i.e., the number of matrix elements.
+     */
+    unsigned long long lines_written = 0;
+
+    /**
+     * Optional callback to report progress, which is called with the cumulative number of bytes written whenever the buffer is flushed to the `byteme::Writer`.
+     * If `WriteMatrixOptions::num_threads` is greater than 1, this may be called from a different thread.
+     * This is not modified by `write_matrix()`.
+     */
+    std::function<void(unsigned long long)> progress;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+class Stopwatch {
+public:
+    Stopwatch() : my_start(std::chrono::steady_clock::now()) {}
+
+    // Returns the time since construction or the previous call, in seconds.
+    double lap() {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - my_start).count();
+        my_start = now;
+        return elapsed;
+    }
+
+private:
+    std::chrono::steady_clock::time_point my_start;
+};
+
+// Records the total time in the destructor, to cover all exit points of write_matrix().
+class WriteTimer {
+public:
+    WriteTimer(WriteStatistics* statistics) : my_statistics(statistics), my_start(std::chrono::steady_clock::now()) {}
+
+    ~WriteTimer() {
+        if (my_statistics) {
+            my_statistics->total_time = elapsed();
+        }
+    }
+
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - my_start).count();
+    }
+
+private:
+    WriteStatistics* my_statistics;
+    std::chrono::steady_clock::time_point my_start;
+};
+
+class ObservedReader final : public byteme::Reader {
+public:
+    ObservedReader(byteme::Reader& reader, LoadStatistics& statistics) : my_reader(reader), my_statistics(statistics) {}
+
+    std::size_t read(unsigned char* buffer, std::size_t n) {
+        Stopwatch watch;
+        const auto available = my_reader.read(buffer, n);
+        my_statistics.read_time += watch.lap();
+        my_statistics.bytes_read += available;
+        if (my_statistics.progress) {
+            my_statistics.progress(my_statistics.bytes_read);
+        }
+        return available;
+    }
+
+private:
+    byteme::Reader& my_reader;
+    LoadStatistics& my_statistics;
+};
+
+class ObservedWriter final : public byteme::Writer {
+public:
+    ObservedWriter(byteme::Writer& writer, WriteStatistics& statistics) : my_writer(writer), my_statistics(statistics) {}
+
+    void write(const unsigned char* buffer, std::size_t n) {
+        my_writer.write(buffer, n);
+        my_statistics.bytes_written += n;
+        if (my_statistics.progress) {
+            my_statistics.progress(my_statistics.bytes_written);
+        }
+    }
+
+    void finish() {
+        my_writer.finish();
+    }
+
+private:
+    byteme::Writer& my_writer;
+    WriteStatistics& my_statistics;
+};
+
+}
+/**
+ * @endcond
+ */
+
+}
+
+#endif
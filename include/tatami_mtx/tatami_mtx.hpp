@@ -3,6 +3,19 @@
 
 #include "load_matrix.hpp"
 #include "write_matrix.hpp"
+#include "parallel_zlib_writer.hpp"
+#include "write_matrix_sharded.hpp"
+#include "binary_format.hpp"
+#include "write_binary_matrix.hpp"
+#include "load_binary_matrix.hpp"
+#include "delta_varint_sparse_matrix.hpp"
+#include "load_matrices.hpp"
+#include "load_10x_bundle.hpp"
+#include "inspect_matrix.hpp"
+#include "load_matrix_range.hpp"
+#include "load_matrix_async.hpp"
+#include "statistics.hpp"
+#include "tiled_sparse_matrix.hpp"
 
 /**
  * @file tatami_mtx.hpp
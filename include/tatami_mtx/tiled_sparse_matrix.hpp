@@ -0,0 +1,492 @@
+#ifndef TATAMI_MTX_TILED_SPARSE_MATRIX_HPP
+#define TATAMI_MTX_TILED_SPARSE_MATRIX_HPP
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+/**
+ * @file tiled_sparse_matrix.hpp
+ * @brief Sparse matrix stored as a grid of compressed tiles.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @cond
+ */
+namespace internal {
+
+template<typename Index_>
+Index_ count_tiles(const Index_ extent, const Index_ tile_extent) {
+    // Always reporting at least one tile so that the dimensions of an empty matrix are preserved.
+    if (extent == 0) {
+        return 1;
+    }
+    return extent / tile_extent + (extent % tile_extent > 0);
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Sparse matrix stored as a grid of tiles.
+ *
+ * @tparam Value_ Type of the matrix values.
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * The matrix is partitioned into tiles of fixed size, where each tile is a separate `tatami::Matrix`, typically a `tatami::CompressedSparseMatrix`.
+ * The tiles at the bottom and right edges of the grid may be smaller if the matrix dimensions are not multiples of the tile dimensions.
+ * Extraction of a row only touches the tiles in the same band of rows, and similarly for columns;
+ * for block and indexed extraction, only the tiles overlapping the requested subset are accessed.
+ * This provides predictable performance for access in either dimension without storing both a row-major and column-major copy of the matrix.
+ */
+template<typename Value_, typename Index_>
+class TiledSparseMatrix final : public tatami::Matrix<Value_, Index_> {
+public:
+    /**
+     * @param nrow Number of rows.
+     * @param ncol Number of columns.
+     * @param tile_nrow Number of rows in each tile, excepting the last band of tiles.
+     * This should be positive.
+     * @param tile_ncol Number of columns in each tile, excepting the last band of tiles.
+     * This should be positive.
+     * @param tiles Vector of tiles in row-major order, i.e., all tiles in the first band of rows, then all tiles in the second band, and so on.
+     * The number of tile rows is defined as `nrow / tile_nrow` rounded up, or 1 if `nrow = 0`; the same applies for the number of tile columns.
+     */
+    TiledSparseMatrix(
+        const Index_ nrow,
+        const Index_ ncol,
+        const Index_ tile_nrow,
+        const Index_ tile_ncol,
+        std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > > tiles
+    ) :
+        my_nrow(nrow),
+        my_ncol(ncol),
+        my_tile_nrow(tile_nrow),
+        my_tile_ncol(tile_ncol),
+        my_tiles(std::move(tiles))
+    {
+        if (tile_nrow <= 0 || tile_ncol <= 0) {
+            throw std::runtime_error("tile dimensions should be positive");
+        }
+
+        my_num_tile_rows = internal::count_tiles(nrow, tile_nrow);
+        my_num_tile_columns = internal::count_tiles(ncol, tile_ncol);
+        if (my_tiles.size() != sanisizer::product<std::size_t>(my_num_tile_rows, my_num_tile_columns)) {
+            throw std::runtime_error("number of tiles is not consistent with the matrix and tile dimensions");
+        }
+
+        // Each band of rows is a column-wise combination of its tiles, and the bands are then combined row-wise.
+        // tatami::DelayedBind only calls the extractors of the components that overlap with each request.
+        std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > > bands;
+        bands.reserve(my_num_tile_rows);
+        for (Index_ r = 0; r < my_num_tile_rows; ++r) {
+            const Index_ expected_nrow = std::min(tile_nrow, static_cast<Index_>(nrow - r * tile_nrow));
+
+            std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > > band;
+            band.reserve(my_num_tile_columns);
+            for (Index_ c = 0; c < my_num_tile_columns; ++c) {
+                const Index_ expected_ncol = std::min(tile_ncol, static_cast<Index_>(ncol - c * tile_ncol));
+                const auto& current = my_tiles[static_cast<std::size_t>(r) * static_cast<std::size_t>(my_num_tile_columns) + static_cast<std::size_t>(c)];
+                if (current->nrow() != expected_nrow || current->ncol() != expected_ncol) {
+                    throw std::runtime_error("dimensions of tile (" + std::to_string(r) + ", " + std::to_string(c) + ") are not consistent with the matrix and tile dimensions");
+                }
+                band.push_back(current);
+            }
+
+            bands.emplace_back(new tatami::DelayedBind<Value_, Index_>(std::move(band), false));
+        }
+
+        my_combined.reset(new tatami::DelayedBind<Value_, Index_>(std::move(bands), true));
+    }
+
+private:
+    Index_ my_nrow, my_ncol;
+    Index_ my_tile_nrow, my_tile_ncol;
+    Index_ my_num_tile_rows, my_num_tile_columns;
+    std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > > my_tiles;
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > my_combined;
+
+public:
+    /**
+     * @return Number of rows in each tile, excepting the last band of tiles.
+     */
+    Index_ tile_nrow() const {
+        return my_tile_nrow;
+    }
+
+    /**
+     * @return Number of columns in each tile, excepting the last band of tiles.
+     */
+    Index_ tile_ncol() const {
+        return my_tile_ncol;
+    }
+
+    /**
+     * @return Number of bands of tiles along the rows.
+     */
+    Index_ num_tile_rows() const {
+        return my_num_tile_rows;
+    }
+
+    /**
+     * @return Number of bands of tiles along the columns.
+     */
+    Index_ num_tile_columns() const {
+        return my_num_tile_columns;
+    }
+
+    /**
+     * @param r Index of the band of rows, less than `num_tile_rows()`.
+     * @param c Index of the band of columns, less than `num_tile_columns()`.
+     * @return The tile at position `(r, c)` of the grid.
+     */
+    const std::shared_ptr<const tatami::Matrix<Value_, Index_> >& tile(const Index_ r, const Index_ c) const {
+        return my_tiles[static_cast<std::size_t>(r) * static_cast<std::size_t>(my_num_tile_columns) + static_cast<std::size_t>(c)];
+    }
+
+public:
+    Index_ nrow() const {
+        return my_nrow;
+    }
+
+    Index_ ncol() const {
+        return my_ncol;
+    }
+
+    bool is_sparse() const {
+        return my_combined->is_sparse();
+    }
+
+    double is_sparse_proportion() const {
+        return my_combined->is_sparse_proportion();
+    }
+
+    bool prefer_rows() const {
+        return my_combined->prefer_rows();
+    }
+
+    double prefer_rows_proportion() const {
+        return my_combined->prefer_rows_proportion();
+    }
+
+    bool uses_oracle(const bool row) const {
+        return my_combined->uses_oracle(row);
+    }
+
+public:
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(const bool row, const tatami::Options& opt) const {
+        return my_combined->dense(row, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(const bool row, const Index_ block_start, const Index_ block_length, const tatami::Options& opt) const {
+        return my_combined->dense(row, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicDenseExtractor<Value_, Index_> > dense(const bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return my_combined->dense(row, std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(const bool row, const tatami::Options& opt) const {
+        return my_combined->sparse(row, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(const bool row, const Index_ block_start, const Index_ block_length, const tatami::Options& opt) const {
+        return my_combined->sparse(row, block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::MyopicSparseExtractor<Value_, Index_> > sparse(const bool row, tatami::VectorPtr<Index_> indices_ptr, const tatami::Options& opt) const {
+        return my_combined->sparse(row, std::move(indices_ptr), opt);
+    }
+
+public:
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return my_combined->dense(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(
+        const bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        const Index_ block_start,
+        const Index_ block_length,
+        const tatami::Options& opt
+    ) const {
+        return my_combined->dense(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularDenseExtractor<Value_, Index_> > dense(
+        const bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        tatami::VectorPtr<Index_> indices_ptr,
+        const tatami::Options& opt
+    ) const {
+        return my_combined->dense(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(const bool row, std::shared_ptr<const tatami::Oracle<Index_> > oracle, const tatami::Options& opt) const {
+        return my_combined->sparse(row, std::move(oracle), opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(
+        const bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        const Index_ block_start,
+        const Index_ block_length,
+        const tatami::Options& opt
+    ) const {
+        return my_combined->sparse(row, std::move(oracle), block_start, block_length, opt);
+    }
+
+    std::unique_ptr<tatami::OracularSparseExtractor<Value_, Index_> > sparse(
+        const bool row,
+        std::shared_ptr<const tatami::Oracle<Index_> > oracle,
+        tatami::VectorPtr<Index_> indices_ptr,
+        const tatami::Options& opt
+    ) const {
+        return my_combined->sparse(row, std::move(oracle), std::move(indices_ptr), opt);
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+// Read-only view into a slice of an array that is shared between tiles.
+// This provides the size(), begin(), end() and [] methods required by tatami::CompressedSparseMatrix.
+template<class Storage_>
+class SharedStorageView {
+public:
+    SharedStorageView(std::shared_ptr<const Storage_> storage, const std::size_t offset, const std::size_t length) :
+        my_storage(std::move(storage)),
+        my_offset(offset),
+        my_length(length)
+    {}
+
+    typedef typename Storage_::value_type value_type;
+
+private:
+    std::shared_ptr<const Storage_> my_storage;
+    std::size_t my_offset, my_length;
+
+public:
+    std::size_t size() const {
+        return my_length;
+    }
+
+    const value_type& operator[](const std::size_t i) const {
+        return (*my_storage)[my_offset + i];
+    }
+
+    auto begin() const {
+        return my_storage->begin() + my_offset;
+    }
+
+    auto end() const {
+        return my_storage->begin() + (my_offset + my_length);
+    }
+
+    const value_type* data() const {
+        return my_storage->data() + my_offset;
+    }
+};
+
+template<typename Value_, typename Index_, class ValueStorage_, class IndexStorage_, class PointerStorage_>
+std::shared_ptr<const tatami::Matrix<Value_, Index_> > create_tile(
+    const Index_ NR,
+    const Index_ NC,
+    const std::shared_ptr<const ValueStorage_>& values,
+    const std::shared_ptr<const IndexStorage_>& indices,
+    const std::size_t offset,
+    const std::size_t length,
+    PointerStorage_ pointers,
+    const bool row
+) {
+    typedef SharedStorageView<ValueStorage_> ValueView;
+    typedef SharedStorageView<IndexStorage_> IndexView;
+    return std::shared_ptr<const tatami::Matrix<Value_, Index_> >(
+        new tatami::CompressedSparseMatrix<Value_, Index_, ValueView, IndexView, PointerStorage_>(
+            NR,
+            NC,
+            ValueView(values, offset, length),
+            IndexView(indices, offset, length),
+            std::move(pointers),
+            row,
+            false
+        )
+    );
+}
+
+// Builds the tiles directly from the triplets, where 'primary' and 'secondary' contain the 0-based indices along the primary and secondary dimensions.
+// The triplets are first bucketed by tile with an in-place counting sort (i.e., American flag sort), so no copy of the triplets is made.
+// Each bucket is then sorted by its primary and secondary indices with a workspace that is no larger than the bucket.
+// All tiles share the same value and index arrays, and 'primary' is cleared before returning to release its memory.
+template<typename Value_, typename Index_, class ValueStorage_, class TempIndexStorage_, class IndexStorage_>
+std::shared_ptr<tatami::Matrix<Value_, Index_> > create_tiled_sparse_matrix(
+    const Index_ NR,
+    const Index_ NC,
+    ValueStorage_ values,
+    TempIndexStorage_& primary,
+    IndexStorage_ secondary,
+    const bool row,
+    const Index_ tile_nrow,
+    const Index_ tile_ncol,
+    const int num_threads,
+    std::size_t& pointer_bytes
+) {
+    const Index_ num_primary = (row ? NR : NC), num_secondary = (row ? NC : NR);
+    const Index_ tile_primary = (row ? tile_nrow : tile_ncol), tile_secondary = (row ? tile_ncol : tile_nrow);
+    const Index_ num_primary_tiles = count_tiles(num_primary, tile_primary), num_secondary_tiles = count_tiles(num_secondary, tile_secondary);
+    const auto num_tiles = sanisizer::product<std::size_t>(num_primary_tiles, num_secondary_tiles);
+    const std::size_t num_triplets = values.size();
+
+    auto tile_of = [&](const std::size_t i) -> std::size_t {
+        const std::size_t pt = static_cast<Index_>(primary[i]) / tile_primary;
+        const std::size_t st = static_cast<Index_>(secondary[i]) / tile_secondary;
+        return pt * static_cast<std::size_t>(num_secondary_tiles) + st;
+    };
+
+    auto starts = sanisizer::create<std::vector<std::size_t> >(sanisizer::sum<std::size_t>(num_tiles, 1));
+    for (std::size_t i = 0; i < num_triplets; ++i) {
+        ++(starts[tile_of(i) + 1]);
+    }
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+
+    {
+        std::vector<std::size_t> next(starts.begin(), starts.end() - 1);
+        for (std::size_t b = 0; b < num_tiles; ++b) {
+            const auto bend = starts[b + 1];
+            auto& pos = next[b];
+            while (pos < bend) {
+                // Swapping the current triplet into its bucket until a triplet for the current bucket is found.
+                auto t = tile_of(pos);
+                while (t != b) {
+                    const auto dest = next[t]++;
+                    std::swap(values[pos], values[dest]);
+                    std::swap(primary[pos], primary[dest]);
+                    std::swap(secondary[pos], secondary[dest]);
+                    t = tile_of(pos);
+                }
+                ++pos;
+            }
+        }
+    }
+
+    auto shared_values = std::make_shared<ValueStorage_>(std::move(values));
+    auto shared_indices = std::make_shared<IndexStorage_>(std::move(secondary));
+    std::shared_ptr<const ValueStorage_> const_values = shared_values;
+    std::shared_ptr<const IndexStorage_> const_indices = shared_indices;
+
+    // Empty tiles all refer to the same array of zero pointers, so they do not need their own allocations.
+    typedef std::vector<std::uint32_t> SmallPointers;
+    std::shared_ptr<const SmallPointers> zero_pointers(new SmallPointers(sanisizer::sum<std::size_t>(tile_primary, 1)));
+
+    std::vector<std::shared_ptr<const tatami::Matrix<Value_, Index_> > > tiles(num_tiles);
+    auto thread_pointer_bytes = sanisizer::create<std::vector<std::size_t> >(std::max(num_threads, 1));
+
+    tatami::parallelize([&](const int thread, const std::size_t start, const std::size_t length) -> void {
+        auto& tvalues = *shared_values;
+        auto& tindices = *shared_indices;
+        std::vector<typename ValueStorage_::value_type> vbuffer;
+        std::vector<typename IndexStorage_::value_type> ibuffer;
+        std::vector<Index_> pbuffer;
+        std::vector<std::size_t> scount, pcount;
+
+        for (std::size_t b = start, end = start + length; b < end; ++b) {
+            const Index_ pt = b / num_secondary_tiles, st = b % num_secondary_tiles;
+            const Index_ pfirst = pt * tile_primary, sfirst = st * tile_secondary;
+            const Index_ plength = std::min(tile_primary, static_cast<Index_>(num_primary - pfirst));
+            const Index_ slength = std::min(tile_secondary, static_cast<Index_>(num_secondary - sfirst));
+            const auto offset = starts[b], number = starts[b + 1] - offset;
+
+            // Tiles are stored in row-major order of the grid, regardless of the orientation of the input.
+            auto& current = tiles[row ?
+                static_cast<std::size_t>(pt) * static_cast<std::size_t>(num_secondary_tiles) + static_cast<std::size_t>(st) :
+                static_cast<std::size_t>(st) * static_cast<std::size_t>(num_primary_tiles) + static_cast<std::size_t>(pt)
+            ];
+            const Index_ tile_NR = (row ? plength : slength), tile_NC = (row ? slength : plength);
+
+            if (number == 0) {
+                current = create_tile<Value_, Index_>(
+                    tile_NR,
+                    tile_NC,
+                    const_values,
+                    const_indices,
+                    offset,
+                    0,
+                    SharedStorageView<SmallPointers>(zero_pointers, 0, static_cast<std::size_t>(plength) + 1),
+                    row
+                );
+                continue;
+            }
+
+            // Counting sort by the secondary index and then by the primary index, which leaves the secondary indices sorted within each primary slice.
+            scount.clear();
+            scount.resize(static_cast<std::size_t>(slength) + 1);
+            for (std::size_t i = offset, iend = offset + number; i < iend; ++i) {
+                ++(scount[static_cast<Index_>(tindices[i]) - sfirst + 1]);
+            }
+            std::partial_sum(scount.begin(), scount.end(), scount.begin());
+
+            vbuffer.resize(number);
+            ibuffer.resize(number);
+            pbuffer.resize(number);
+            for (std::size_t i = offset, iend = offset + number; i < iend; ++i) {
+                const Index_ sidx = static_cast<Index_>(tindices[i]) - sfirst;
+                auto& pos = scount[sidx];
+                vbuffer[pos] = tvalues[i];
+                ibuffer[pos] = sidx;
+                pbuffer[pos] = static_cast<Index_>(primary[i]) - pfirst;
+                ++pos;
+            }
+
+            pcount.clear();
+            pcount.resize(static_cast<std::size_t>(plength) + 1);
+            for (auto p : pbuffer) {
+                ++(pcount[p + 1]);
+            }
+            std::partial_sum(pcount.begin(), pcount.end(), pcount.begin());
+
+            if (number <= std::numeric_limits<std::uint32_t>::max()) {
+                current = create_tile<Value_, Index_>(tile_NR, tile_NC, const_values, const_indices, offset, number, SmallPointers(pcount.begin(), pcount.end()), row);
+                thread_pointer_bytes[thread] += sizeof(std::uint32_t) * pcount.size();
+            } else {
+                current = create_tile<Value_, Index_>(tile_NR, tile_NC, const_values, const_indices, offset, number, pcount, row);
+                thread_pointer_bytes[thread] += sizeof(std::size_t) * pcount.size();
+            }
+
+            for (std::size_t k = 0; k < number; ++k) {
+                const auto pos = offset + pcount[pbuffer[k]]++;
+                tvalues[pos] = vbuffer[k];
+                tindices[pos] = ibuffer[k];
+            }
+        }
+    }, num_tiles, num_threads);
+
+    TempIndexStorage_().swap(primary);
+    pointer_bytes = std::accumulate(thread_pointer_bytes.begin(), thread_pointer_bytes.end(), static_cast<std::size_t>(0));
+
+    return std::shared_ptr<tatami::Matrix<Value_, Index_> >(new TiledSparseMatrix<Value_, Index_>(NR, NC, tile_nrow, tile_ncol, std::move(tiles)));
+}
+
+}
+/**
+ * @endcond
+ */
+
+}
+
+#endif
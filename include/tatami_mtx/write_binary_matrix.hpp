@@ -0,0 +1,337 @@
+#ifndef TATAMI_MTX_WRITE_BINARY_MATRIX_HPP
+#define TATAMI_MTX_WRITE_BINARY_MATRIX_HPP
+
+#include "byteme/byteme.hpp"
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#if __has_include("zlib.h")
+#include "zlib.h"
+#endif
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "utils.hpp"
+#include "binary_format.hpp"
+
+/**
+ * @file write_binary_matrix.hpp
+ * @brief Write a **tatami** matrix to the binary container format.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Options for `write_binary_matrix()`.
+ */
+struct WriteBinaryMatrixOptions {
+    /**
+     * Whether to save the matrix in the compressed sparse row format.
+     * If false, the compressed sparse column format is used.
+     * If unset, this is set to `tatami::Matrix::prefer_rows()`.
+     */
+    std::optional<bool> by_row;
+
+    /**
+     * Whether to compress each array in independent blocks with Zlib.
+     * Compression reduces the file size but prevents memory mapping in `load_binary_matrix()`.
+     * An error is raised if this is true and Zlib is not available.
+     */
+    bool compress = false;
+
+    /**
+     * Compression level for the Zlib library, from 0 (no compression) to 9 (maximum compression).
+     * Only used if `compress = true`.
+     */
+    int compression_level = 6;
+
+    /**
+     * Number of uncompressed bytes in each compressed block.
+     * Smaller blocks allow for more parallelism during decompression, at the cost of a lower compression ratio.
+     * Only used if `compress = true`, in which case this should be positive.
+     */
+    std::size_t block_size = sanisizer::cap<std::size_t>(1048576);
+
+    /**
+     * Number of threads for counting the number of (structural) non-zeros in each row/column.
+     * This should be positive.
+     */
+    int num_threads = 1;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+class BinaryArrayWriter {
+public:
+    BinaryArrayWriter(byteme::Writer& writer, const bool compress, const int level, const std::size_t block_size) :
+        my_writer(writer),
+        my_compress(compress),
+        my_level(level),
+        my_block_size(block_size),
+        my_swap(!is_little_endian())
+    {
+        if (my_compress) {
+#if __has_include("zlib.h")
+            if (my_block_size == 0) {
+                throw std::runtime_error("block size should be positive");
+            }
+            my_block.reserve(my_block_size);
+#else
+            throw std::runtime_error("Zlib is required to compress binary matrices");
+#endif
+        }
+    }
+
+private:
+    byteme::Writer& my_writer;
+    bool my_compress;
+    int my_level;
+    std::size_t my_block_size;
+    bool my_swap;
+
+    unsigned long long my_position = 0;
+    std::vector<unsigned char> my_block, my_compressed, my_swapped;
+
+    void write_raw(const unsigned char* ptr, std::size_t n) {
+        my_writer.write(ptr, n);
+        my_position += n;
+    }
+
+#if __has_include("zlib.h")
+    void flush_block() {
+        if (my_block.empty()) {
+            return;
+        }
+
+        uLongf compressed_size = compressBound(my_block.size());
+        my_compressed.resize(compressed_size + 8);
+        if (compress2(my_compressed.data() + 8, &compressed_size, my_block.data(), my_block.size(), my_level) != Z_OK) {
+            throw std::runtime_error("failed to compress block with Zlib");
+        }
+        encode_uint64(compressed_size, my_compressed.data());
+        write_raw(my_compressed.data(), compressed_size + 8);
+        my_block.clear();
+    }
+#endif
+
+public:
+    // The header is never compressed, so that it can always be read directly.
+    void write_header(const unsigned char* ptr, std::size_t n) {
+        write_raw(ptr, n);
+    }
+
+    void write_bytes(const unsigned char* ptr, std::size_t n) {
+        if (!my_compress) {
+            write_raw(ptr, n);
+            return;
+        }
+
+#if __has_include("zlib.h")
+        while (n > 0) {
+            const auto to_add = std::min(n, my_block_size - my_block.size());
+            my_block.insert(my_block.end(), ptr, ptr + to_add);
+            ptr += to_add;
+            n -= to_add;
+            if (my_block.size() == my_block_size) {
+                flush_block();
+            }
+        }
+#endif
+    }
+
+    template<typename Type_>
+    void write(const Type_* ptr, const std::size_t n) {
+        const auto nbytes = sanisizer::product<std::size_t>(n, sizeof(Type_));
+        if (!my_swap) {
+            write_bytes(reinterpret_cast<const unsigned char*>(ptr), nbytes);
+            return;
+        }
+
+        // Converting big-endian values to little-endian.
+        my_swapped.resize(nbytes);
+        std::memcpy(my_swapped.data(), ptr, nbytes);
+        swap_bytes(reinterpret_cast<Type_*>(my_swapped.data()), n);
+        write_bytes(my_swapped.data(), nbytes);
+    }
+
+    // Terminates the current array, either by flushing the last block or padding to an 8-byte boundary.
+    void finish_array() {
+        if (my_compress) {
+#if __has_include("zlib.h")
+            flush_block();
+#endif
+            return;
+        }
+
+        const unsigned char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        write_raw(padding, (8 - my_position % 8) % 8);
+    }
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Write a `tatami::Matrix` to a binary container, see `binary_format.hpp` for details on the format.
+ * This avoids the cost of formatting and parsing text, and the resulting file can be memory-mapped by `load_binary_matrix()`.
+ * Dense matrices are saved in a compressed sparse format containing only the non-zero elements.
+ *
+ * The matrix is streamed into the file in three passes (counting, indices, then values),
+ * so the memory usage is independent of the number of non-zero elements.
+ *
+ * @tparam Value_ Numeric type of the matrix data.
+ * @tparam Index_ Integer type of the row/column indices.
+ * @tparam StoredValue_ Numeric type of the values in the file.
+ * @tparam StoredIndex_ Integer type of the indices in the file.
+ * An error is raised if the extent of the secondary dimension cannot be represented by this type.
+ *
+ * @param matrix Input matrix.
+ * @param writer A `byteme::Writer` instance representing the file to which the matrix contents will be written.
+ * It is the caller's responsibility to call `byteme::Writer::finish()` once this function returns.
+ * @param options Options for writing the matrix.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Value_, typename StoredIndex_ = Index_>
+void write_binary_matrix(const tatami::Matrix<Value_, Index_>& matrix, byteme::Writer& writer, const WriteBinaryMatrixOptions& options) {
+    BinaryMatrixHeader header;
+    header.row = (options.by_row.has_value() ? *(options.by_row) : matrix.prefer_rows());
+    header.value_type = internal::binary_type_of<StoredValue_>();
+    header.index_type = internal::binary_type_of<StoredIndex_>();
+    static_assert(std::is_integral<StoredIndex_>::value, "indices should be stored as integers");
+    header.compressed = options.compress;
+    header.nrow = matrix.nrow();
+    header.ncol = matrix.ncol();
+    if (options.compress) {
+        header.block_size = options.block_size;
+    }
+
+    const bool row = header.row;
+    const Index_ num_primary = (row ? matrix.nrow() : matrix.ncol());
+    const Index_ num_secondary = (row ? matrix.ncol() : matrix.nrow());
+    const bool sparse = matrix.is_sparse();
+
+    // Indices are narrowed to StoredIndex_ when written, so the largest secondary index must be representable.
+    if (num_secondary > 0 && sanisizer::is_greater_than(num_secondary - 1, std::numeric_limits<StoredIndex_>::max())) {
+        throw std::runtime_error("number of " + std::string(row ? "columns" : "rows") + " is too large for the stored index type");
+    }
+
+    // First pass to count the number of non-zero elements in each row/column.
+    auto pointers = sanisizer::create<std::vector<std::uint64_t> >(sanisizer::sum<std::size_t>(num_primary, 1));
+    tatami::parallelize([&](int, Index_ start, Index_ length) -> void {
+        if (sparse) {
+            tatami::Options opt;
+            opt.sparse_extract_index = false;
+            opt.sparse_extract_value = false;
+            auto ext = tatami::consecutive_extractor<true>(matrix, row, start, length, opt);
+            for (Index_ p = start, end = start + length; p < end; ++p) {
+                pointers[p + 1] = ext->fetch(NULL, NULL).number;
+            }
+        } else {
+            auto ext = tatami::consecutive_extractor<false>(matrix, row, start, length);
+            auto vbuffer = sanisizer::create<std::vector<Value_> >(num_secondary);
+            for (Index_ p = start, end = start + length; p < end; ++p) {
+                auto ptr = ext->fetch(vbuffer.data());
+                pointers[p + 1] = std::count_if(ptr, ptr + num_secondary, [](Value_ x) -> bool { return x != 0; });
+            }
+        }
+    }, num_primary, options.num_threads);
+
+    for (Index_ p = 0; p < num_primary; ++p) {
+        pointers[p + 1] = sanisizer::sum<std::uint64_t>(pointers[p + 1], pointers[p]);
+    }
+    header.nnz = pointers.back();
+
+    internal::BinaryArrayWriter output(writer, options.compress, options.compression_level, options.block_size);
+    unsigned char header_buffer[internal::binary_header_size];
+    internal::serialize_binary_header(header, header_buffer);
+    output.write_header(header_buffer, internal::binary_header_size);
+
+    output.write(pointers.data(), pointers.size());
+    output.finish_array();
+
+    // Second and third passes to write the indices and values, respectively.
+    auto vbuffer = sanisizer::create<std::vector<Value_> >(num_secondary);
+    auto ibuffer = sanisizer::create<std::vector<Index_> >(num_secondary);
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool indices = (pass == 0);
+        std::vector<StoredIndex_> stored_indices;
+        std::vector<StoredValue_> stored_values;
+
+        if (sparse) {
+            tatami::Options opt;
+            opt.sparse_extract_index = indices;
+            opt.sparse_extract_value = !indices;
+            auto ext = tatami::consecutive_extractor<true>(matrix, row, static_cast<Index_>(0), num_primary, opt);
+            for (Index_ p = 0; p < num_primary; ++p) {
+                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                if (indices) {
+                    stored_indices.assign(range.index, range.index + range.number);
+                    output.write(stored_indices.data(), stored_indices.size());
+                } else {
+                    stored_values.assign(range.value, range.value + range.number);
+                    output.write(stored_values.data(), stored_values.size());
+                }
+            }
+
+        } else {
+            auto ext = tatami::consecutive_extractor<false>(matrix, row, static_cast<Index_>(0), num_primary);
+            for (Index_ p = 0; p < num_primary; ++p) {
+                auto ptr = ext->fetch(vbuffer.data());
+                stored_indices.clear();
+                stored_values.clear();
+                for (Index_ s = 0; s < num_secondary; ++s) {
+                    if (ptr[s] != 0) {
+                        if (indices) {
+                            stored_indices.push_back(s);
+                        } else {
+                            stored_values.push_back(ptr[s]);
+                        }
+                    }
+                }
+                if (indices) {
+                    output.write(stored_indices.data(), stored_indices.size());
+                } else {
+                    output.write(stored_values.data(), stored_values.size());
+                }
+            }
+        }
+
+        output.finish_array();
+    }
+}
+
+/**
+ * Write a `tatami::Matrix` to a binary container file, see `write_binary_matrix()` for details.
+ *
+ * @tparam Value_ Numeric type of the matrix data.
+ * @tparam Index_ Integer type of the row/column indices.
+ * @tparam StoredValue_ Numeric type of the values in the file.
+ * @tparam StoredIndex_ Integer type of the indices in the file.
+ *
+ * @param matrix Input matrix.
+ * @param filepath Path to the file to be written.
+ * @param options Options for writing the matrix.
+ */
+template<typename Value_, typename Index_, typename StoredValue_ = Value_, typename StoredIndex_ = Index_>
+void write_binary_matrix_to_file(const tatami::Matrix<Value_, Index_>& matrix, const char* filepath, const WriteBinaryMatrixOptions& options) {
+    byteme::RawFileWriter writer(filepath, {});
+    write_binary_matrix<Value_, Index_, StoredValue_, StoredIndex_>(matrix, writer, options);
+    writer.finish();
+}
+
+}
+
+#endif
@@ -8,12 +8,23 @@
 #include <vector>
 #include <cstddef>
 #include <charconv>
+#include <optional>
 #include <stdexcept>
 #include <type_traits>
 #include <cassert>
 #include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 
 #include "utils.hpp"
+#include "parallel_zlib_writer.hpp"
+#include "statistics.hpp"
 
 /**
  * @file write_matrix.hpp
@@ -86,6 +97,22 @@ struct WriteMatrixOptions {
      */
     std::optional<bool> by_row;
 
+    /**
+     * Whether the matrix is symmetric, in which case it is saved with the `symmetric` qualifier and only the lower triangle is written.
+     * If `true`, the caller asserts that the matrix is symmetric, and an error is raised if the matrix is not square.
+     * If unset, a parallel check is performed to determine whether the matrix is symmetric, unless `row_subset` or `column_subset` are set.
+     * This is only used for the coordinate format.
+     */
+    std::optional<bool> symmetric = false;
+
+    /**
+     * Whether to save the matrix with the `pattern` field in the coordinate format, in which case only the row and column indices of each element are written.
+     * If `true`, the caller asserts that all written elements are equal to 1, and their values are not inspected.
+     * If unset, the values are checked during the counting pass and the `pattern` field is used if all written elements are equal to 1.
+     * This is only used for the coordinate format.
+     */
+    std::optional<bool> pattern = false;
+
     /**
      * Whether to write the Matrix Market banner.
      * This can be disabled to, e.g., write a custom banner.
@@ -111,13 +138,685 @@ struct WriteMatrixOptions {
     std::size_t buffer_size = sanisizer::cap<std::size_t>(65536);
 
     /**
-     * Number of threads for counting the number of structural non-zeros in a coordinate matrix.
+     * Whether to skip zeros when saving a non-sparse matrix in the coordinate format.
+     * If `true`, an extra pass is performed over the matrix to count the non-zero elements for the header, and only those elements are written to file.
+     * If `false`, all elements are written, including zeros.
+     * This has no effect on sparse matrices, for which only the structural non-zeros are written;
+     * or for the array format, where all elements must be written.
+     */
+    bool skip_zeros = false;
+
+    /**
+     * Number of threads for counting the number of (structural) non-zeros in a coordinate matrix, as well as for detecting symmetry and pattern matrices.
      * This should be positive.
      * Note that this does not affect the writing itself, which is still done in serial.
      */ 
     int num_threads = 1;
+
+    /**
+     * Maximum number of matrix elements to hold in memory when writing a row-preferring matrix in the array format.
+     * The array format is column-major, so blocks of consecutive columns are extracted from each row and transposed before they are written.
+     * Larger values reduce the number of passes over the rows at the cost of increasing memory usage.
+     * Each block will always contain at least one column, regardless of the value of this field.
+     */
+    std::size_t transpose_buffer_size = sanisizer::cap<std::size_t>(4194304);
+
+    /**
+     * Number of threads for compression in `write_matrix_to_gzip_file()` and `write_matrix_to_zlib_buffer()`.
+     * If greater than 1, the formatted text is compressed in independent blocks on multiple threads via the `ParallelZlibWriter`. 
+     * This should be positive.
+     */
+    int compression_threads = 1;
+
+    /**
+     * Number of blocks of rows/columns to extract ahead of the formatting.
+     * If positive, rows/columns are extracted from the matrix on a background thread and passed to the formatting thread through a bounded queue of this many reusable buffers.
+     * This allows file-backed matrices to perform I/O while previous rows/columns are being formatted, where the extraction itself uses an oracle so that the matrix can prefetch upcoming rows/columns.
+     * If zero, extraction and formatting are performed sequentially on the same thread.
+     * This is not used for row-preferring matrices in the array format.
+     */
+    int prefetch = 0;
+
+    /**
+     * Number of rows/columns in each block when `WriteMatrixOptions::prefetch` is positive.
+     * Larger values reduce synchronization overhead at the cost of memory usage.
+     * Each block will always contain at least one row/column, regardless of the value of this field.
+     */
+    std::size_t prefetch_block_size = sanisizer::cap<std::size_t>(16);
+
+    /**
+     * Indices of the rows to be written, which should be sorted and unique.
+     * If set, only these rows are written, in the specified order, and are renumbered according to their positions in this vector.
+     * The subset is applied during extraction so there is no need to construct a `tatami::DelayedSubset` around the matrix.
+     * If unset, all rows are written.
+     */
+    std::optional<std::vector<std::size_t> > row_subset;
+
+    /**
+     * Indices of the columns to be written, which should be sorted and unique.
+     * If set, only these columns are written, in the specified order, and are renumbered according to their positions in this vector.
+     * If unset, all columns are written.
+     */
+    std::optional<std::vector<std::size_t> > column_subset;
+
+    /**
+     * Pointer to a `WriteStatistics` instance in which to record timings and the number of bytes written.
+     * If NULL, no statistics are collected.
+     * The pointed-to object should not be accessed by other threads during the write, except via `WriteStatistics::progress`.
+     */
+    WriteStatistics* statistics = NULL;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+/*
+ * Rows and columns to be written, where the output dimensions are the subset lengths.
+ * The remapping vectors convert the original indices into positions in the subset.
+ */
+template<typename Index_>
+struct Subsets {
+    Index_ nrow = 0, ncol = 0;
+    tatami::VectorPtr<Index_> rows, columns;
+    std::vector<Index_> row_remap, column_remap;
+
+    const tatami::VectorPtr<Index_>& primary(const bool row) const {
+        return (row ? rows : columns);
+    }
+
+    const tatami::VectorPtr<Index_>& secondary(const bool row) const {
+        return (row ? columns : rows);
+    }
+
+    const std::vector<Index_>& secondary_remap(const bool row) const {
+        return (row ? column_remap : row_remap);
+    }
+};
+
+template<typename Index_>
+void configure_subset(const std::optional<std::vector<std::size_t> >& requested, const Index_ extent, const char* dimension, Index_& output_extent, tatami::VectorPtr<Index_>& subset, std::vector<Index_>& remap) {
+    if (!requested.has_value()) {
+        output_extent = extent;
+        return;
+    }
+
+    const auto& req = *requested;
+    output_extent = sanisizer::cast<Index_>(req.size());
+    auto converted = sanisizer::create<std::vector<Index_> >(output_extent);
+    sanisizer::resize(remap, extent);
+
+    for (Index_ i = 0; i < output_extent; ++i) {
+        const auto current = req[i];
+        if (!sanisizer::is_less_than(current, extent)) {
+            throw std::runtime_error(std::string(dimension) + " subset contains out-of-range indices");
+        }
+        if (i > 0 && current <= req[i - 1]) {
+            throw std::runtime_error(std::string(dimension) + " subset should be sorted and unique");
+        }
+        converted[i] = current;
+        remap[current] = i;
+    }
+
+    subset = std::make_shared<const std::vector<Index_> >(std::move(converted));
+}
+
+template<typename Value_, typename Index_>
+Subsets<Index_> configure_subsets(const tatami::Matrix<Value_, Index_>& matrix, const WriteMatrixOptions& options) {
+    Subsets<Index_> output;
+    configure_subset(options.row_subset, matrix.nrow(), "row", output.nrow, output.rows, output.row_remap);
+    configure_subset(options.column_subset, matrix.ncol(), "column", output.ncol, output.columns, output.column_remap);
+    return output;
+}
+
+/*
+ * Creates an oracular extractor for positions [start, start + length) along the (possibly subsetted) primary dimension,
+ * restricted to positions [secondary_start, secondary_start + secondary_length) along the (possibly subsetted) secondary dimension.
+ * Subsets are handled by the matrix's indexed extractors rather than by wrapping the matrix in a delayed subset.
+ */
+template<bool sparse_, typename Value_, typename Index_>
+auto new_subset_extractor(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const bool row,
+    const Subsets<Index_>& subsets,
+    const Index_ start,
+    const Index_ length,
+    const Index_ secondary_start,
+    const Index_ secondary_length,
+    const tatami::Options& opt)
+{
+    const auto& primary = subsets.primary(row);
+    std::shared_ptr<const tatami::Oracle<Index_> > oracle;
+    if (primary) {
+        oracle.reset(new tatami::FixedViewOracle<Index_>(primary->data() + start, length));
+    } else {
+        oracle.reset(new tatami::ConsecutiveOracle<Index_>(start, length));
+    }
+
+    const auto& secondary = subsets.secondary(row);
+    if (secondary) {
+        if (secondary_start == 0 && sanisizer::is_equal(secondary_length, secondary->size())) {
+            return tatami::new_extractor<sparse_, true>(matrix, row, std::move(oracle), secondary, opt);
+        }
+        auto sliced = std::make_shared<const std::vector<Index_> >(secondary->begin() + secondary_start, secondary->begin() + secondary_start + secondary_length);
+        return tatami::new_extractor<sparse_, true>(matrix, row, std::move(oracle), std::move(sliced), opt);
+    }
+
+    const Index_ full = (row ? matrix.ncol() : matrix.nrow());
+    if (secondary_start == 0 && secondary_length == full) {
+        return tatami::new_extractor<sparse_, true>(matrix, row, std::move(oracle), opt);
+    }
+    return tatami::new_extractor<sparse_, true>(matrix, row, std::move(oracle), secondary_start, secondary_length, opt);
+}
+
+template<bool sparse_, typename Value_, typename Index_>
+auto new_subset_extractor(const tatami::Matrix<Value_, Index_>& matrix, const bool row, const Subsets<Index_>& subsets, const Index_ start, const Index_ length, const tatami::Options& opt) {
+    return new_subset_extractor<sparse_>(matrix, row, subsets, start, length, static_cast<Index_>(0), (row ? subsets.ncol : subsets.nrow), opt);
+}
+
+// Converts the indices of a sparse range into positions in the secondary subset, if any.
+template<typename Value_, typename Index_>
+void remap_indices(tatami::SparseRange<Value_, Index_>& range, Index_* ibuffer, const std::vector<Index_>& remap) {
+    if (remap.empty() || range.index == NULL) {
+        return;
+    }
+    for (Index_ i = 0; i < range.number; ++i) {
+        ibuffer[i] = remap[range.index[i]];
+    }
+    range.index = ibuffer;
+}
+
+template<typename Value_, typename Index_>
+void write_array_by_row_blocks(
+    const tatami::Matrix<Value_, Index_>& matrix,
+    const Subsets<Index_>& subsets,
+    byteme::BufferedWriter<char>& bufwriter,
+    std::vector<char>& conversion_buffer,
+    const WriteMatrixOptions& options
+) {
+    const auto NR = subsets.nrow;
+    const auto NC = subsets.ncol;
+    if (NR == 0 || NC == 0) {
+        return;
+    }
+
+    // Each block contains as many columns as can fit in the transposition buffer.
+    Index_ block_size = 1;
+    const auto max_columns = options.transpose_buffer_size / static_cast<std::size_t>(NR);
+    if (max_columns > 1) {
+        block_size = (sanisizer::is_less_than(max_columns, NC) ? static_cast<Index_>(max_columns) : NC);
+    }
+
+    // Transposing in square tiles so that both the reads and writes stay in cache.
+    constexpr Index_ tile_size = 32;
+    auto tbuffer = sanisizer::create<std::vector<Value_> >(sanisizer::product<std::size_t>(block_size, NR));
+    auto rbuffer = sanisizer::create<std::vector<Value_> >(sanisizer::product<std::size_t>(block_size, tile_size));
+
+    for (Index_ block_start = 0; block_start < NC; block_start += block_size) {
+        const Index_ block_length = std::min(block_size, static_cast<Index_>(NC - block_start));
+        auto ext = new_subset_extractor<false>(matrix, true, subsets, static_cast<Index_>(0), NR, block_start, block_length, tatami::Options());
+
+        for (Index_ row_start = 0; row_start < NR; row_start += tile_size) {
+            const Index_ row_length = std::min(tile_size, static_cast<Index_>(NR - row_start));
+            for (Index_ r = 0; r < row_length; ++r) {
+                const auto rptr = rbuffer.data() + sanisizer::product_unsafe<std::size_t>(r, block_length);
+                const auto ptr = ext->fetch(rptr);
+                tatami::copy_n(ptr, block_length, rptr);
+            }
+
+            for (Index_ col_start = 0; col_start < block_length; col_start += tile_size) {
+                const Index_ col_end = col_start + std::min(tile_size, static_cast<Index_>(block_length - col_start));
+                for (Index_ r = 0; r < row_length; ++r) {
+                    const auto rptr = rbuffer.data() + sanisizer::product_unsafe<std::size_t>(r, block_length);
+                    for (Index_ c = col_start; c < col_end; ++c) {
+                        tbuffer[sanisizer::nd_offset<std::size_t>(row_start + r, NR, c)] = rptr[c];
+                    }
+                }
+            }
+        }
+
+        const auto block_total = sanisizer::product_unsafe<std::size_t>(block_length, NR);
+        for (std::size_t i = 0; i < block_total; ++i) {
+            const auto used = convert(tbuffer[i], conversion_buffer, options.format, options.precision); 
+            bufwriter.write(conversion_buffer.data(), used);
+            bufwriter.write('\n');
+        }
+    }
+}
+
+/*
+ * Extracts each row/column of the matrix and passes it to 'consume', along with its index.
+ * If 'prefetch' is positive, extraction is performed on a background thread that fills a bounded queue of reusable buffers,
+ * so that the formatting in 'consume' does not need to wait for (potentially I/O-bound) extraction of the next row/column.
+ */
+template<bool sparse_, typename Value_, typename Index_, class Consume_>
+void extract_primary(const tatami::Matrix<Value_, Index_>& matrix, const Subsets<Index_>& subsets, const bool row, const tatami::Options& opt, const int prefetch, const std::size_t prefetch_block_size, Consume_ consume) {
+    const Index_ num_primary = (row ? subsets.nrow : subsets.ncol);
+    const Index_ num_secondary = (row ? subsets.ncol : subsets.nrow);
+    const auto& remap = subsets.secondary_remap(row);
+
+    if (prefetch <= 0 || num_primary == 0) {
+        auto ext = new_subset_extractor<sparse_>(matrix, row, subsets, static_cast<Index_>(0), num_primary, opt);
+        auto vbuffer = sanisizer::create<std::vector<Value_> >(num_secondary);
+        if constexpr(sparse_) {
+            auto ibuffer = sanisizer::create<std::vector<Index_> >(num_secondary);
+            for (Index_ p = 0; p < num_primary; ++p) {
+                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                remap_indices(range, ibuffer.data(), remap);
+                consume(p, range);
+            }
+        } else {
+            for (Index_ p = 0; p < num_primary; ++p) {
+                consume(p, ext->fetch(vbuffer.data()));
+            }
+        }
+        return;
+    }
+
+    Index_ block_size = 1;
+    if (prefetch_block_size > 1) {
+        block_size = (sanisizer::is_less_than(prefetch_block_size, num_primary) ? static_cast<Index_>(prefetch_block_size) : num_primary);
+    }
+
+    struct Slot {
+        std::vector<Value_> values;
+        std::vector<Index_> indices;
+        std::vector<Index_> numbers;
+        Index_ start = 0;
+        Index_ length = 0;
+    };
+
+    const auto slot_size = sanisizer::product<std::size_t>(block_size, num_secondary);
+    auto slots = sanisizer::create<std::vector<Slot> >(prefetch);
+    std::deque<Slot*> free_slots, ready_slots;
+    for (auto& slot : slots) {
+        sanisizer::resize(slot.values, slot_size);
+        if constexpr(sparse_) {
+            sanisizer::resize(slot.indices, slot_size);
+            sanisizer::resize(slot.numbers, block_size);
+        }
+        free_slots.push_back(&slot);
+    }
+
+    std::mutex lock;
+    std::condition_variable cv;
+    bool finished = false, aborted = false;
+    std::exception_ptr error;
+
+    std::thread producer([&]() -> void {
+        try {
+            // The consecutive extractor uses an oracle, so file-backed matrices can prefetch the upcoming rows/columns.
+            auto ext = new_subset_extractor<sparse_>(matrix, row, subsets, static_cast<Index_>(0), num_primary, opt);
+            for (Index_ start = 0; start < num_primary; start += std::min(block_size, static_cast<Index_>(num_primary - start))) {
+                Slot* slot;
+                {
+                    std::unique_lock<std::mutex> lck(lock);
+                    cv.wait(lck, [&]() -> bool { return aborted || !free_slots.empty(); });
+                    if (aborted) {
+                        return;
+                    }
+                    slot = free_slots.front();
+                    free_slots.pop_front();
+                }
+
+                slot->start = start;
+                slot->length = std::min(block_size, static_cast<Index_>(num_primary - start));
+                for (Index_ i = 0; i < slot->length; ++i) {
+                    const auto offset = sanisizer::product_unsafe<std::size_t>(i, num_secondary);
+                    const auto vptr = slot->values.data() + offset;
+                    if constexpr(sparse_) {
+                        const auto iptr = slot->indices.data() + offset;
+                        auto range = ext->fetch(vptr, iptr);
+                        remap_indices(range, iptr, remap);
+                        slot->numbers[i] = range.number;
+                        if (range.value) {
+                            tatami::copy_n(range.value, range.number, vptr);
+                        }
+                        if (range.index) {
+                            tatami::copy_n(range.index, range.number, iptr);
+                        }
+                    } else {
+                        tatami::copy_n(ext->fetch(vptr), num_secondary, vptr);
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lck(lock);
+                    ready_slots.push_back(slot);
+                }
+                cv.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lck(lock);
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lck(lock);
+            finished = true;
+        }
+        cv.notify_all();
+    });
+
+    try {
+        while (1) {
+            Slot* slot;
+            {
+                std::unique_lock<std::mutex> lck(lock);
+                cv.wait(lck, [&]() -> bool { return finished || !ready_slots.empty(); });
+                if (ready_slots.empty()) {
+                    break;
+                }
+                slot = ready_slots.front();
+                ready_slots.pop_front();
+            }
+
+            for (Index_ i = 0; i < slot->length; ++i) {
+                const auto offset = sanisizer::product_unsafe<std::size_t>(i, num_secondary);
+                if constexpr(sparse_) {
+                    consume(
+                        slot->start + i,
+                        tatami::SparseRange<Value_, Index_>(
+                            slot->numbers[i],
+                            (opt.sparse_extract_value ? slot->values.data() + offset : NULL),
+                            (opt.sparse_extract_index ? slot->indices.data() + offset : NULL)
+                        )
+                    );
+                } else {
+                    consume(slot->start + i, static_cast<const Value_*>(slot->values.data() + offset));
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lck(lock);
+                free_slots.push_back(slot);
+            }
+            cv.notify_all();
+        }
+
+    } catch (...) {
+        // Stopping the producer before propagating the error from the consumer.
+        {
+            std::lock_guard<std::mutex> lck(lock);
+            aborted = true;
+        }
+        cv.notify_all();
+        producer.join();
+        throw;
+    }
+
+    producer.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+template<typename Index_>
+bool in_lower_triangle(const bool primary_is_row, const Index_ primary, const Index_ secondary) {
+    if (primary_is_row) {
+        return secondary <= primary;
+    } else {
+        return secondary >= primary;
+    }
+}
+
+template<typename Value_, typename Index_>
+bool is_symmetric(const tatami::Matrix<Value_, Index_>& matrix, const int num_threads) {
+    const auto N = matrix.nrow();
+    if (N != matrix.ncol()) {
+        return false;
+    }
+
+    // Comparing each row against its corresponding column.
+    auto okay = sanisizer::create<std::vector<char> >(num_threads, 1);
+    if (matrix.is_sparse()) {
+        tatami::parallelize([&](int t, Index_ start, Index_ length) -> void {
+            auto rext = tatami::consecutive_extractor<true>(matrix, true, start, length);
+            auto cext = tatami::consecutive_extractor<true>(matrix, false, start, length);
+            auto rvbuffer = sanisizer::create<std::vector<Value_> >(N);
+            auto ribuffer = sanisizer::create<std::vector<Index_> >(N);
+            auto cvbuffer = sanisizer::create<std::vector<Value_> >(N);
+            auto cibuffer = sanisizer::create<std::vector<Index_> >(N);
+
+            for (Index_ x = start, end = start + length; x < end; ++x) {
+                const auto rrange = rext->fetch(rvbuffer.data(), ribuffer.data());
+                const auto crange = cext->fetch(cvbuffer.data(), cibuffer.data());
+                if (
+                    rrange.number != crange.number ||
+                    !std::equal(rrange.index, rrange.index + rrange.number, crange.index) ||
+                    !std::equal(rrange.value, rrange.value + rrange.number, crange.value)
+                ) {
+                    okay[t] = false;
+                    return;
+                }
+            }
+        }, N, num_threads);
+
+    } else {
+        tatami::parallelize([&](int t, Index_ start, Index_ length) -> void {
+            auto rext = tatami::consecutive_extractor<false>(matrix, true, start, length);
+            auto cext = tatami::consecutive_extractor<false>(matrix, false, start, length);
+            auto rbuffer = sanisizer::create<std::vector<Value_> >(N);
+            auto cbuffer = sanisizer::create<std::vector<Value_> >(N);
+
+            for (Index_ x = start, end = start + length; x < end; ++x) {
+                const auto rptr = rext->fetch(rbuffer.data());
+                const auto cptr = cext->fetch(cbuffer.data());
+                if (!std::equal(rptr, rptr + N, cptr)) {
+                    okay[t] = false;
+                    return;
+                }
+            }
+        }, N, num_threads);
+    }
+
+    return std::find(okay.begin(), okay.end(), 0) == okay.end();
+}
+
+template<typename Value_>
+void write_banner(byteme::BufferedWriter<char>& bufwriter, const bool coordinate, const bool pattern, const bool symmetric) {
+    bufwriter.write("%%MatrixMarket matrix");
+    if (coordinate) {
+        bufwriter.write(" coordinate");
+    } else {
+        bufwriter.write(" array");
+    }
+    if (pattern) {
+        bufwriter.write(" pattern");
+    } else if constexpr(std::is_integral<Value_>::value) {
+        bufwriter.write(" integer");
+    } else {
+        bufwriter.write(" real");
+    }
+    if (symmetric) {
+        bufwriter.write(" symmetric\n");
+    } else {
+        bufwriter.write(" general\n");
+    }
+}
+
+struct CoordinateCounts {
+    unsigned long long total = 0;
+    bool all_ones = true;
+};
+
+template<typename Value_, typename Index_>
+CoordinateCounts count_coordinate_entries(const tatami::Matrix<Value_, Index_>& matrix, const Subsets<Index_>& subsets, const bool symmetric, const bool skip_zeros, const bool check_ones, const int num_threads) {
+    const auto NR = subsets.nrow;
+    const auto NC = subsets.ncol;
+    CoordinateCounts output;
+
+    // No need for a pass over the matrix if all elements of a dense matrix are to be written.
+    const bool sparse = matrix.is_sparse();
+    if (!sparse && !skip_zeros && !check_ones) {
+        if (symmetric) {
+            output.total = sanisizer::product<unsigned long long>(NR, NR) / 2 + NR / 2 + NR % 2; // i.e., N * (N + 1) / 2 without overflowing.
+        } else {
+            output.total = sanisizer::product<unsigned long long>(NR, NC);
+        }
+        return output;
+    }
+
+    assert(num_threads >= 0);
+    auto totals = sanisizer::create<std::vector<unsigned long long> >(num_threads);
+    auto ones = sanisizer::create<std::vector<char> >(num_threads, 1);
+
+    // For symmetric matrices, we only count the elements in the lower triangle.
+    const bool prefer_rows = matrix.prefer_rows();
+    const auto num_primary = (prefer_rows ? NR : NC);
+    const auto num_secondary = (prefer_rows ? NC : NR);
+
+    if (sparse) {
+        tatami::parallelize([&](int t, Index_ start, Index_ length) -> void {
+            tatami::Options opt;
+            opt.sparse_extract_index = symmetric;
+            opt.sparse_extract_value = check_ones;
+            opt.sparse_ordered_index = false;
+            auto ext = new_subset_extractor<true>(matrix, prefer_rows, subsets, start, length, opt);
+            const auto& remap = subsets.secondary_remap(prefer_rows);
+            std::vector<Value_> vbuffer;
+            if (check_ones) {
+                sanisizer::resize(vbuffer, num_secondary);
+            }
+            std::vector<Index_> ibuffer;
+            if (symmetric) {
+                sanisizer::resize(ibuffer, num_secondary);
+            }
+
+            unsigned long long count = 0;
+            bool all_ones = true;
+            for (Index_ p = start, end = start + length; p < end; ++p) {
+                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+                remap_indices(range, ibuffer.data(), remap);
+                if (!symmetric && !check_ones) {
+                    count = sanisizer::sum<I<decltype(count)> >(count, range.number);
+                    continue;
+                }
+                for (I<decltype(range.number)> i = 0; i < range.number; ++i) {
+                    if (symmetric && !in_lower_triangle(prefer_rows, p, range.index[i])) {
+                        continue;
+                    }
+                    ++count;
+                    if (check_ones && range.value[i] != 1) {
+                        all_ones = false;
+                    }
+                }
+            }
+
+            totals[t] = count;
+            ones[t] = all_ones;
+        }, num_primary, num_threads);
+
+    } else {
+        tatami::parallelize([&](int t, Index_ start, Index_ length) -> void {
+            auto ext = new_subset_extractor<false>(matrix, prefer_rows, subsets, start, length, tatami::Options());
+            auto vbuffer = sanisizer::create<std::vector<Value_> >(num_secondary);
+            unsigned long long count = 0;
+            bool all_ones = true;
+
+            for (Index_ p = start, end = start + length; p < end; ++p) {
+                auto ptr = ext->fetch(vbuffer.data());
+                for (I<decltype(num_secondary)> s = 0; s < num_secondary; ++s) {
+                    if (symmetric && !in_lower_triangle(prefer_rows, p, s)) {
+                        continue;
+                    }
+                    if (skip_zeros && ptr[s] == 0) {
+                        continue;
+                    }
+                    ++count;
+                    if (ptr[s] != 1) {
+                        all_ones = false;
+                    }
+                }
+            }
+
+            totals[t] = count;
+            ones[t] = all_ones;
+        }, num_primary, num_threads);
+    }
+
+    for (auto t : totals) {
+        output.total = sanisizer::sum<I<decltype(output.total)> >(output.total, t);
+    }
+    output.all_ones = (check_ones && std::find(ones.begin(), ones.end(), 0) == ones.end());
+    return output;
+}
+
+/*
+ * Formats 1-based indices for the coordinate format, without pre-formatting every index in the matrix.
+ * Small indices are directly taken from a pre-formatted table with a fixed upper limit.
+ * Larger indices are split into high and low digits, where the high digits are formatted recursively
+ * and the low digits are taken from a small table of zero-padded strings.
+ */
+template<typename Index_>
+class IndexDictionary {
+public:
+    IndexDictionary(const Index_ max_index, const unsigned long long table_limit = 65536) {
+        my_table_size = (sanisizer::is_less_than(max_index, table_limit) ? static_cast<unsigned long long>(max_index) : table_limit);
+        my_lookup.resize(my_table_size + 1);
+
+        std::vector<char> conversion_buffer(100);
+        for (unsigned long long i = 0; i < my_table_size; ++i) {
+            const auto used = convert(i + 1, conversion_buffer, {}, {});
+            my_dictionary.insert(my_dictionary.end(), conversion_buffer.data(), conversion_buffer.data() + used);
+            my_lookup[i + 1] = my_dictionary.size();
+        }
+
+        if (sanisizer::is_greater_than(max_index, my_table_size)) {
+            my_low_digits.resize(low_modulo * low_width);
+            auto lptr = my_low_digits.data();
+            for (unsigned long long i = 0; i < low_modulo; ++i) {
+                auto current = i;
+                for (int d = low_width; d > 0; --d) {
+                    lptr[d - 1] = '0' + (current % 10);
+                    current /= 10;
+                }
+                lptr += low_width;
+            }
+        }
+    }
+
+private:
+    static constexpr unsigned long long low_modulo = 10000;
+    static constexpr int low_width = 4;
+
+    unsigned long long my_table_size;
+    std::vector<char> my_dictionary;
+    std::vector<std::size_t> my_lookup;
+    std::vector<char> my_low_digits;
+
+    void write_number(byteme::BufferedWriter<char>& writer, const unsigned long long number) const {
+        if (number <= my_table_size) {
+            const auto start = my_lookup[number - 1];
+            writer.write(my_dictionary.data() + start, my_lookup[number] - start);
+            return;
+        }
+
+        const auto high = number / low_modulo;
+        if (high == 0) { // only possible if the table is very small.
+            char buffer[32];
+            const auto out = std::to_chars(buffer, buffer + sizeof(buffer), number);
+            writer.write(buffer, out.ptr - buffer);
+            return;
+        }
+
+        write_number(writer, high);
+        writer.write(my_low_digits.data() + (number % low_modulo) * low_width, low_width);
+    }
+
+public:
+    // Writes the 1-based counterpart of the 0-based index 'i'.
+    void write(byteme::BufferedWriter<char>& writer, const Index_ i) const {
+        write_number(writer, static_cast<unsigned long long>(i) + 1);
+    }
 };
 
+}
+/**
+ * @endcond
+ */
+
 /**
  * Write a `tatami::Matrix` to a Matrix Market file.
  * This can either be stored in an array or coordinate format depending on the options.
@@ -132,34 +831,37 @@ struct WriteMatrixOptions {
  */
 template<typename Value_, typename Index_>
 void write_matrix(const tatami::Matrix<Value_, Index_>& matrix, byteme::Writer& writer, const WriteMatrixOptions& options) {
+    // The observed writer and timer are declared first so that they outlive the final flush of the buffered writer.
+    byteme::Writer* wptr = &writer;
+    std::optional<internal::ObservedWriter> observed;
+    const auto stats = options.statistics;
+    if (stats) {
+        auto progress = std::move(stats->progress);
+        *stats = WriteStatistics();
+        stats->progress = std::move(progress);
+        observed.emplace(writer, *stats);
+        wptr = &(*observed);
+    }
+    internal::WriteTimer timer(stats);
+
     std::unique_ptr<byteme::BufferedWriter<char> > bufwriter;
     if (options.num_threads > 1) {
-        bufwriter.reset(new byteme::ParallelBufferedWriter<char, byteme::Writer*>(&writer, options.buffer_size));
+        bufwriter.reset(new byteme::ParallelBufferedWriter<char, byteme::Writer*>(wptr, options.buffer_size));
     } else {
-        bufwriter.reset(new byteme::SerialBufferedWriter<char, byteme::Writer*>(&writer, options.buffer_size));
+        bufwriter.reset(new byteme::SerialBufferedWriter<char, byteme::Writer*>(wptr, options.buffer_size));
     }
 
     const bool coordinate = (options.coordinate.has_value() ? *(options.coordinate) : matrix.is_sparse());
-    if (options.banner) {
-        bufwriter->write("%%MatrixMarket matrix");
-        if (coordinate) {
-            bufwriter->write(" coordinate");
-        } else {
-            bufwriter->write(" array");
-        }
-        if constexpr(std::is_integral<Value_>::value) {
-            bufwriter->write(" integer");
-        } else {
-            bufwriter->write(" real");
-        }
-        bufwriter->write(" general\n");
-    }
-
-    const auto NR = matrix.nrow();
-    const auto NC = matrix.ncol();
+    const auto subsets = internal::configure_subsets(matrix, options);
+    const auto NR = subsets.nrow;
+    const auto NC = subsets.ncol;
     std::vector<char> conversion_buffer(100);
 
     if (!coordinate){ 
+        if (options.banner) {
+            internal::write_banner<Value_>(*bufwriter, false, false, false);
+        }
+
         const auto NR_size = convert(NR, conversion_buffer, options.format, options.precision);
         bufwriter->write(conversion_buffer.data(), NR_size);
         bufwriter->write('\t');
@@ -167,170 +869,133 @@ void write_matrix(const tatami::Matrix<Value_, Index_>& matrix, byteme::Writer&
         bufwriter->write(conversion_buffer.data(), NC_size);
         bufwriter->write('\n');
 
-        auto ext = tatami::consecutive_extractor<false>(matrix, false, static_cast<Index_>(0), NC);
-        auto vbuffer = sanisizer::create<std::vector<Value_> >(NR);
+        if (stats) {
+            stats->lines_written = sanisizer::product<unsigned long long>(NR, NC);
+        }
+
+        if (matrix.prefer_rows()) {
+            internal::write_array_by_row_blocks(matrix, subsets, *bufwriter, conversion_buffer, options);
+            return;
+        }
 
-        for (I<decltype(NC)> c = 0; c < NC; ++c) {
-            auto ptr = ext->fetch(vbuffer.data());
+        internal::extract_primary<false>(matrix, subsets, false, tatami::Options(), options.prefetch, options.prefetch_block_size, [&](const Index_, const Value_* ptr) -> void {
             for (I<decltype(NR)> r = 0; r < NR; ++r) {
                 const auto used = convert(ptr[r], conversion_buffer, options.format, options.precision); 
                 bufwriter->write(conversion_buffer.data(), used);
                 bufwriter->write('\n');
             }
-        }
+        });
         return;
     }
 
-    // Building a look-up table so we don't have to do repeated string conversions.
-    const auto nums = std::max(NR, NC);
-    std::vector<std::size_t> lookup(sanisizer::sum<typename std::vector<std::size_t>::size_type>(nums, 1));
-    std::vector<char> dictionary;
-    for (Index_ i = 0; i < nums; ++i) {
-        const auto used = convert(i + 1, conversion_buffer, options.format, options.precision);
-        dictionary.insert(dictionary.end(), conversion_buffer.data(), conversion_buffer.data() + used);
-        lookup[i + 1] = dictionary.size();
+    const bool has_subsets = (subsets.rows || subsets.columns);
+    bool symmetric = false;
+    if (!options.symmetric.has_value()) {
+        symmetric = (!has_subsets && internal::is_symmetric(matrix, options.num_threads));
+    } else if (*(options.symmetric)) {
+        if (NR != NC) {
+            throw std::runtime_error("symmetric matrices should be square");
+        }
+        if (has_subsets && options.row_subset != options.column_subset) {
+            throw std::runtime_error("row and column subsets should be the same for symmetric matrices");
+        }
+        symmetric = true;
     }
 
+    // Figuring out how many elements we need to write before starting.
+    const auto counts = internal::count_coordinate_entries(matrix, subsets, symmetric, options.skip_zeros, !options.pattern.has_value(), options.num_threads);
+    if (stats) {
+        stats->count_time = timer.elapsed();
+        stats->lines_written = counts.total;
+    }
+    const bool pattern = (options.pattern.has_value() ? *(options.pattern) : (counts.all_ones && counts.total > 0));
+
+    if (options.banner) {
+        internal::write_banner<Value_>(*bufwriter, true, pattern, symmetric);
+    }
+
+    // Building a look-up table so we don't have to do repeated string conversions.
+    const internal::IndexDictionary<Index_> dictionary(std::max(NR, NC));
+
     if (NR >= 1) {
-        bufwriter->write(dictionary.data() + lookup[NR - 1], lookup[NR] - lookup[NR - 1]);
+        dictionary.write(*bufwriter, NR - 1);
     } else {
         bufwriter->write('0');
     }
     bufwriter->write('\t');
 
     if (NC >= 1) {
-        bufwriter->write(dictionary.data() + lookup[NC - 1], lookup[NC] - lookup[NC - 1]);
+        dictionary.write(*bufwriter, NC - 1);
     } else {
         bufwriter->write('0');
     }
     bufwriter->write('\t');
 
+    const auto total_used = convert(counts.total, conversion_buffer, options.format, options.precision);
+    bufwriter->write(conversion_buffer.data(), total_used);
+    bufwriter->write('\n');
+
     if (NR == 0 || NC == 0) {
-        bufwriter->write("0\n");
         return;
     }
 
-    const bool by_row = (options.by_row.has_value() ? *(options.by_row) : matrix.prefer_rows());
-
-    if (matrix.is_sparse()) {
-        assert(options.num_threads >= 0);
-        auto totals = sanisizer::create<std::vector<unsigned long long> >(options.num_threads);
-
-        // Trying to figure out how many non-zero elements we have before starting.
-        if (matrix.prefer_rows()) {
-            tatami::parallelize([&](int t, Index_ start, Index_ length) -> void {
-                tatami::Options opt;
-                opt.sparse_extract_index = false;
-                opt.sparse_extract_value = false;
-                opt.sparse_ordered_index = false;
-                auto ext = tatami::consecutive_extractor<true>(matrix, true, start, length, opt);
-                unsigned long long count = 0;
-                for (Index_ r = start, end = start + length; r < end; ++r) {
-                    auto range = ext->fetch(NULL, NULL);
-                    count = sanisizer::sum<I<decltype(count)> >(count, range.number);
-                }
-                totals[t] = count;
-            }, NR, options.num_threads);
-
+    auto write_entry = [&](const Index_ r, const Index_ c, const Value_ val) -> void {
+        dictionary.write(*bufwriter, r);
+        bufwriter->write('\t');
+        dictionary.write(*bufwriter, c);
+        if (pattern) {
+            bufwriter->write('\n');
         } else {
-            tatami::parallelize([&](int t, Index_ start, Index_ length) -> void {
-                tatami::Options opt;
-                opt.sparse_extract_index = false;
-                opt.sparse_extract_value = false;
-                opt.sparse_ordered_index = false;
-                auto ext = tatami::consecutive_extractor<true>(matrix, false, start, length, opt);
-                unsigned long long count = 0;
-                for (Index_ c = start, end = start + length; c < end; ++c) {
-                    auto range = ext->fetch(NULL, NULL);
-                    count = sanisizer::sum<I<decltype(count)> >(count, range.number);
-                }
-                totals[t] = count;
-            }, NC, options.num_threads);
+            bufwriter->write('\t');
+            const auto used = convert(val, conversion_buffer, options.format, options.precision); 
+            bufwriter->write(conversion_buffer.data(), used);
+            bufwriter->write('\n');
         }
+    };
 
-        unsigned long long total_size = 0;
-        for (auto t : totals) {
-            total_size = sanisizer::sum<I<decltype(total_size)> >(total_size, t);
-        }
-        const auto used = convert(total_size, conversion_buffer, options.format, options.precision);
-        bufwriter->write(conversion_buffer.data(), used);
-        bufwriter->write('\n');
+    const bool by_row = (options.by_row.has_value() ? *(options.by_row) : matrix.prefer_rows());
 
-        if (by_row) {
-            auto ext = tatami::consecutive_extractor<true>(matrix, true, static_cast<Index_>(0), NR);
-            auto vbuffer = sanisizer::create<std::vector<Value_> >(NC);
-            auto ibuffer = sanisizer::create<std::vector<Index_> >(NC);
-            for (I<decltype(NR)> r = 0; r < NR; ++r) {
-                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
-                for (I<decltype(range.number)> i = 0; i < range.number; ++i) {
-                    bufwriter->write(dictionary.data() + lookup[r], lookup[r + 1] - lookup[r]);
-                    bufwriter->write('\t');
-                    const auto index = range.index[i];
-                    bufwriter->write(dictionary.data() + lookup[index], lookup[index + 1] - lookup[index]);
-                    bufwriter->write('\t');
-                    auto used = convert(range.value[i], conversion_buffer, options.format, options.precision); 
-                    bufwriter->write(conversion_buffer.data(), used);
-                    bufwriter->write('\n');
-                }
-            }
+    if (matrix.is_sparse()) {
+        tatami::Options opt;
+        opt.sparse_extract_value = !pattern;
 
-        } else {
-            auto ext = tatami::consecutive_extractor<true>(matrix, false, static_cast<Index_>(0), NC);
-            auto vbuffer = sanisizer::create<std::vector<Value_> >(NR);
-            auto ibuffer = sanisizer::create<std::vector<Index_> >(NR);
-            for (I<decltype(NC)> c = 0; c < NC; ++c) {
-                auto range = ext->fetch(vbuffer.data(), ibuffer.data());
-                for (I<decltype(range.number)> i = 0; i < range.number; ++i) {
-                    const auto index = range.index[i];
-                    bufwriter->write(dictionary.data() + lookup[index], lookup[index + 1] - lookup[index]);
-                    bufwriter->write('\t');
-                    bufwriter->write(dictionary.data() + lookup[c], lookup[c + 1] - lookup[c]);
-                    bufwriter->write('\t');
-                    auto used = convert(range.value[i], conversion_buffer, options.format, options.precision); 
-                    bufwriter->write(conversion_buffer.data(), used);
-                    bufwriter->write('\n');
+        internal::extract_primary<true>(matrix, subsets, by_row, opt, options.prefetch, options.prefetch_block_size, [&](const Index_ p, const tatami::SparseRange<Value_, Index_>& range) -> void {
+            for (I<decltype(range.number)> i = 0; i < range.number; ++i) {
+                const auto index = range.index[i];
+                const Value_ val = (pattern ? 1 : range.value[i]);
+                if (by_row) {
+                    if (symmetric && index > p) {
+                        continue;
+                    }
+                    write_entry(p, index, val);
+                } else {
+                    if (symmetric && index < p) {
+                        continue;
+                    }
+                    write_entry(index, p, val);
                 }
             }
-        }
+        });
 
     } else {
-        const auto total_size = sanisizer::product<unsigned long long>(NR, NC);
-        const auto total_used = convert(total_size, conversion_buffer, options.format, options.precision);
-        bufwriter->write(conversion_buffer.data(), total_used);
-        bufwriter->write('\n');
-
-        if (by_row) {
-            auto ext = tatami::consecutive_extractor<false>(matrix, true, static_cast<Index_>(0), NR);
-            auto vbuffer = sanisizer::create<std::vector<Value_> >(NC);
-            for (I<decltype(NR)> r = 0; r < NR; ++r) {
-                auto ptr = ext->fetch(vbuffer.data());
-                for (I<decltype(NC)> c = 0; c < NC; ++c) {
-                    bufwriter->write(dictionary.data() + lookup[r], lookup[r + 1] - lookup[r]);
-                    bufwriter->write('\t');
-                    bufwriter->write(dictionary.data() + lookup[c], lookup[c + 1] - lookup[c]);
-                    bufwriter->write('\t');
-                    const auto used = convert(ptr[c], conversion_buffer, options.format, options.precision); 
-                    bufwriter->write(conversion_buffer.data(), used);
-                    bufwriter->write('\n');
+        internal::extract_primary<false>(matrix, subsets, by_row, tatami::Options(), options.prefetch, options.prefetch_block_size, [&](const Index_ p, const Value_* ptr) -> void {
+            if (by_row) {
+                const auto limit = (symmetric ? static_cast<I<decltype(NC)> >(p + 1) : NC);
+                for (I<decltype(NC)> c = 0; c < limit; ++c) {
+                    if (options.skip_zeros && ptr[c] == 0) {
+                        continue;
+                    }
+                    write_entry(p, c, ptr[c]);
                 }
-            }
-
-        } else {
-            auto ext = tatami::consecutive_extractor<false>(matrix, false, static_cast<Index_>(0), NC);
-            auto vbuffer = sanisizer::create<std::vector<Value_> >(NR);
-            for (I<decltype(NC)> c = 0; c < NC; ++c) {
-                auto ptr = ext->fetch(vbuffer.data());
-                for (I<decltype(NR)> r = 0; r < NR; ++r) {
-                    bufwriter->write(dictionary.data() + lookup[r], lookup[r + 1] - lookup[r]);
-                    bufwriter->write('\t');
-                    bufwriter->write(dictionary.data() + lookup[c], lookup[c + 1] - lookup[c]);
-                    bufwriter->write('\t');
-                    const auto used = convert(ptr[r], conversion_buffer, options.format, options.precision); 
-                    bufwriter->write(conversion_buffer.data(), used);
-                    bufwriter->write('\n');
+            } else {
+                for (I<decltype(NR)> r = (symmetric ? p : 0); r < NR; ++r) {
+                    if (options.skip_zeros && ptr[r] == 0) {
+                        continue;
+                    }
+                    write_entry(r, p, ptr[r]);
                 }
             }
-        }
+        });
     }
 }
 
@@ -351,6 +1016,249 @@ void write_matrix_to_text_file(const tatami::Matrix<Value_, Index_>& matrix, con
     writer.finish();
 }
 
+/**
+ * @brief Stream a sparse matrix into a Matrix Market file.
+ *
+ * @tparam Value_ Numeric type of the matrix data.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * This writes a Matrix Market file in the coordinate format where the rows or columns are supplied one at a time, e.g., by a generator that produces its results on the fly.
+ * Unlike `write_matrix()`, the full matrix never needs to be held in memory.
+ * As the number of non-zero elements is not known in advance, a fixed-width placeholder is written in the header and replaced with the actual count by `finish()` (or by the destructor, if `finish()` was never called).
+ * The count is zero-padded to 20 digits, which is still a valid integer for Matrix Market parsers.
+ */
+template<typename Value_, typename Index_>
+class MatrixMarketStreamWriter {
+public:
+    /**
+     * @param filepath Path to the Matrix Market file to be written.
+     * This should be an uncompressed file as the header needs to be modified by `finish()`.
+     * @param nrow Number of rows in the matrix.
+     * @param ncol Number of columns in the matrix.
+     * @param options Options for writing the matrix.
+     * Only `WriteMatrixOptions::banner`, `WriteMatrixOptions::format`, `WriteMatrixOptions::precision`, `WriteMatrixOptions::buffer_size`, `WriteMatrixOptions::skip_zeros` and `WriteMatrixOptions::num_threads` are used.
+     * If `WriteMatrixOptions::pattern` is true, the `pattern` field is used and the values passed to `append_row()` and `append_column()` are ignored.
+     * All other options are ignored, i.e., the output is always in the coordinate format with general symmetry.
+     */
+    MatrixMarketStreamWriter(const char* filepath, const Index_ nrow, const Index_ ncol, const WriteMatrixOptions& options) :
+        my_path(filepath),
+        my_nrow(nrow),
+        my_ncol(ncol),
+        my_format(options.format),
+        my_precision(options.precision),
+        my_skip_zeros(options.skip_zeros),
+        my_pattern(options.pattern.has_value() && *(options.pattern)),
+        my_dictionary(std::max(nrow, ncol)),
+        my_conversion_buffer(100),
+        my_writer(filepath, {})
+    {
+        if (options.num_threads > 1) {
+            my_bufwriter.reset(new byteme::ParallelBufferedWriter<char, byteme::Writer*>(&my_writer, options.buffer_size));
+        } else {
+            my_bufwriter.reset(new byteme::SerialBufferedWriter<char, byteme::Writer*>(&my_writer, options.buffer_size));
+        }
+
+        // Formatting the header in memory so that we know the byte offset of the NNZ placeholder.
+        byteme::RawBufferWriter header_writer({});
+        {
+            byteme::SerialBufferedWriter<char, byteme::Writer*> header_bufwriter(&header_writer, 100);
+            if (options.banner) {
+                internal::write_banner<Value_>(header_bufwriter, true, my_pattern, false);
+            }
+            write_dimension(header_bufwriter, nrow);
+            header_bufwriter.write('\t');
+            write_dimension(header_bufwriter, ncol);
+            header_bufwriter.write('\t');
+            header_bufwriter.flush();
+        }
+        header_writer.finish();
+
+        const auto& header = header_writer.get_output();
+        my_count_offset = header.size();
+        my_bufwriter->write(reinterpret_cast<const char*>(header.data()), header.size());
+        my_bufwriter->write(std::string(count_width, '0').c_str(), count_width);
+        my_bufwriter->write('\n');
+    }
+
+    /**
+     * If `finish()` was not called, the destructor flushes all buffered output and updates the header with the number of written elements.
+     * This ensures that the file is still a valid Matrix Market file, e.g., if the stream is abandoned due to an exception.
+     * Any errors during this process are ignored; call `finish()` explicitly to detect them.
+     */
+    ~MatrixMarketStreamWriter() {
+        if (!my_finished) {
+            try {
+                finalize();
+            } catch (...) {}
+        }
+    }
+
+    /**
+     * @cond
+     */
+    MatrixMarketStreamWriter(const MatrixMarketStreamWriter&) = delete;
+    MatrixMarketStreamWriter& operator=(const MatrixMarketStreamWriter&) = delete;
+    MatrixMarketStreamWriter(MatrixMarketStreamWriter&&) = delete;
+    MatrixMarketStreamWriter& operator=(MatrixMarketStreamWriter&&) = delete;
+    /**
+     * @endcond
+     */
+
+private:
+    std::string my_path;
+    Index_ my_nrow, my_ncol;
+    std::optional<std::chars_format> my_format;
+    std::optional<int> my_precision;
+    bool my_skip_zeros, my_pattern;
+
+    internal::IndexDictionary<Index_> my_dictionary;
+    std::vector<char> my_conversion_buffer;
+    byteme::RawFileWriter my_writer;
+    std::unique_ptr<byteme::BufferedWriter<char> > my_bufwriter;
+
+    static constexpr int count_width = 20;
+    std::size_t my_count_offset = 0;
+    unsigned long long my_count = 0;
+
+    Index_ my_next_row = 0, my_next_column = 0;
+    bool my_finished = false;
+
+private:
+    void write_dimension(byteme::BufferedWriter<char>& writer, const Index_ dim) const {
+        if (dim >= 1) {
+            my_dictionary.write(writer, dim - 1);
+        } else {
+            writer.write('0');
+        }
+    }
+
+    void write_entry(const Index_ r, const Index_ c, const Value_ val) {
+        my_dictionary.write(*my_bufwriter, r);
+        my_bufwriter->write('\t');
+        my_dictionary.write(*my_bufwriter, c);
+        if (!my_pattern) {
+            my_bufwriter->write('\t');
+            const auto used = convert(val, my_conversion_buffer, my_format, my_precision); 
+            my_bufwriter->write(my_conversion_buffer.data(), used);
+        }
+        my_bufwriter->write('\n');
+        ++my_count;
+    }
+
+    static bool is_valid_index(const Index_ index, const Index_ limit) {
+        if constexpr(std::is_signed<Index_>::value) {
+            if (index < 0) {
+                return false;
+            }
+        }
+        return index < limit;
+    }
+
+    void check_state() const {
+        if (my_finished) {
+            throw std::runtime_error("cannot append to a finished stream");
+        }
+    }
+
+    void finalize() {
+        my_finished = true;
+        my_bufwriter.reset(); // flushing the remaining contents.
+        my_writer.finish();
+
+        char count_buffer[count_width + 1];
+        std::snprintf(count_buffer, sizeof(count_buffer), "%020llu", my_count);
+
+        std::FILE* handle = std::fopen(my_path.c_str(), "r+b");
+        if (handle == NULL) {
+            throw std::runtime_error("failed to reopen '" + my_path + "' to update the header");
+        }
+        const bool okay = (std::fseek(handle, sanisizer::cast<long>(my_count_offset), SEEK_SET) == 0 && std::fwrite(count_buffer, 1, count_width, handle) == static_cast<std::size_t>(count_width));
+        if (std::fclose(handle) != 0 || !okay) {
+            throw std::runtime_error("failed to update the header of '" + my_path + "'");
+        }
+    }
+
+public:
+    /**
+     * Append the next row of the matrix, starting from the first row.
+     * This should not be used in the same stream as `append_column()`.
+     *
+     * @param values Pointer to an array of length `n`, containing the values of the structural non-zero elements in this row.
+     * Ignored in pattern mode.
+     * @param indices Pointer to an array of length `n`, containing the column indices of the structural non-zero elements in this row.
+     * @param n Number of structural non-zero elements.
+     */
+    void append_row(const Value_* values, const Index_* indices, const Index_ n) {
+        check_state();
+        if (my_next_column > 0) {
+            throw std::runtime_error("cannot append rows after appending columns");
+        }
+        if (my_next_row == my_nrow) {
+            throw std::runtime_error("number of appended rows exceeds the number of rows");
+        }
+
+        for (Index_ i = 0; i < n; ++i) {
+            if (!is_valid_index(indices[i], my_ncol)) {
+                throw std::runtime_error("column index out of range");
+            }
+            const Value_ val = (my_pattern ? 1 : values[i]);
+            if (my_skip_zeros && val == 0) {
+                continue;
+            }
+            write_entry(my_next_row, indices[i], val);
+        }
+        ++my_next_row;
+    }
+
+    /**
+     * Append the next column of the matrix, starting from the first column.
+     * This should not be used in the same stream as `append_row()`.
+     *
+     * @param values Pointer to an array of length `n`, containing the values of the structural non-zero elements in this column.
+     * Ignored in pattern mode.
+     * @param indices Pointer to an array of length `n`, containing the row indices of the structural non-zero elements in this column.
+     * @param n Number of structural non-zero elements.
+     */
+    void append_column(const Value_* values, const Index_* indices, const Index_ n) {
+        check_state();
+        if (my_next_row > 0) {
+            throw std::runtime_error("cannot append columns after appending rows");
+        }
+        if (my_next_column == my_ncol) {
+            throw std::runtime_error("number of appended columns exceeds the number of columns");
+        }
+
+        for (Index_ i = 0; i < n; ++i) {
+            if (!is_valid_index(indices[i], my_nrow)) {
+                throw std::runtime_error("row index out of range");
+            }
+            const Value_ val = (my_pattern ? 1 : values[i]);
+            if (my_skip_zeros && val == 0) {
+                continue;
+            }
+            write_entry(indices[i], my_next_column, val);
+        }
+        ++my_next_column;
+    }
+
+    /**
+     * @return Number of elements written so far.
+     */
+    unsigned long long num_written() const {
+        return my_count;
+    }
+
+    /**
+     * Flush all buffered output to file and update the header with the number of written elements.
+     * Any rows/columns that were not appended are treated as empty.
+     * This should be called exactly once, after which no further rows or columns can be appended.
+     */
+    void finish() {
+        check_state();
+        finalize();
+    }
+};
+
 #if __has_include("zlib.h")
 
 /**
@@ -365,6 +1273,19 @@ void write_matrix_to_text_file(const tatami::Matrix<Value_, Index_>& matrix, con
  */
 template<typename Value_, typename Index_, typename StoredValue_ = Automatic, typename StoredIndex_ = Automatic>
 void write_matrix_to_gzip_file(const tatami::Matrix<Value_, Index_>& matrix, const char* filepath, const WriteMatrixOptions& options) {
+    if (options.compression_threads > 1) {
+        byteme::RawFileWriter raw(filepath, {});
+        ParallelZlibWriter writer(&raw, [&]{
+            ParallelZlibWriterOptions opt;
+            opt.mode = byteme::ZlibCompressionMode::GZIP;
+            opt.num_threads = options.compression_threads;
+            return opt;
+        }());
+        write_matrix<Value_, Index_>(matrix, writer, options);
+        writer.finish();
+        return;
+    }
+
     byteme::GzipFileWriter writer(filepath, {});
     write_matrix<Value_, Index_>(matrix, writer, options);
     writer.finish();
@@ -408,6 +1329,19 @@ std::vector<unsigned char> write_matrix_to_text_buffer(const tatami::Matrix<Valu
  */
 template<typename Value_, typename Index_>
 std::vector<unsigned char> write_matrix_to_zlib_buffer(const tatami::Matrix<Value_, Index_>& matrix, const byteme::ZlibCompressionMode mode, const WriteMatrixOptions& options) {
+    if (options.compression_threads > 1) {
+        byteme::RawBufferWriter raw({});
+        ParallelZlibWriter writer(&raw, [&]{
+            ParallelZlibWriterOptions opt;
+            opt.mode = mode;
+            opt.num_threads = options.compression_threads;
+            return opt;
+        }());
+        write_matrix<Value_, Index_>(matrix, writer, options);
+        writer.finish();
+        return raw.get_output();
+    }
+
     byteme::ZlibBufferWriter writer([&]{
         byteme::ZlibBufferWriterOptions opt;
         opt.mode = mode;
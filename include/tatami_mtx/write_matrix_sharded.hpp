@@ -0,0 +1,270 @@
+#ifndef TATAMI_MTX_WRITE_MATRIX_SHARDED_HPP
+#define TATAMI_MTX_WRITE_MATRIX_SHARDED_HPP
+
+#include "byteme/byteme.hpp"
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+
+#include "utils.hpp"
+#include "write_matrix.hpp"
+
+/**
+ * @file write_matrix_sharded.hpp
+ * @brief Write a **tatami** matrix to multiple Matrix Market files.
+ */
+
+namespace tatami_mtx {
+
+/**
+ * @brief Options for `write_matrix_sharded()`.
+ */
+struct WriteMatrixShardedOptions {
+    /**
+     * Number of shards, i.e., contiguous blocks of rows or columns that are each saved to a separate file.
+     * This should be positive.
+     */
+    int num_shards = 1;
+
+    /**
+     * Whether to split the matrix into blocks of rows.
+     * If false, the matrix is split into blocks of columns.
+     * If unset, this is set to `tatami::Matrix::prefer_rows()` so that each shard can be extracted efficiently.
+     */
+    std::optional<bool> by_row;
+
+    /**
+     * Whether to Gzip-compress each shard.
+     * Only used if Zlib is available.
+     */
+    bool gzip = false;
+
+    /**
+     * Number of threads for writing shards concurrently.
+     * Each thread has its own writer (and compressor, if `gzip = true`).
+     */
+    int num_threads = 1;
+
+    /**
+     * Options for writing each shard, see `write_matrix()` for details.
+     * `WriteMatrixOptions::symmetric` is always set to false as the shards are not square.
+     */
+    WriteMatrixOptions write;
+};
+
+/**
+ * @brief Manifest for a sharded Matrix Market export.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ */
+template<typename Index_>
+struct ShardManifest {
+    /**
+     * Number of rows in the full matrix.
+     */
+    Index_ nrow = 0;
+
+    /**
+     * Number of columns in the full matrix.
+     */
+    Index_ ncol = 0;
+
+    /**
+     * Whether the matrix was split into blocks of rows.
+     */
+    bool by_row = true;
+
+    /**
+     * Block boundaries, of length equal to the number of shards plus 1.
+     * Shard `i` contains rows (or columns) in `[boundaries[i], boundaries[i + 1])`.
+     */
+    std::vector<Index_> boundaries;
+
+    /**
+     * Paths to the Matrix Market file for each shard.
+     */
+    std::vector<std::string> paths;
+};
+
+/**
+ * @cond
+ */
+namespace internal {
+
+inline std::string manifest_directory(const std::string& manifest_path) {
+    const auto pos = manifest_path.find_last_of('/');
+    if (pos == std::string::npos) {
+        return std::string();
+    }
+    return manifest_path.substr(0, pos + 1);
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Split a `tatami::Matrix` into contiguous blocks of rows or columns and write each block to its own Matrix Market file.
+ * Shards are written concurrently, each with its own `byteme::Writer`, so that downstream consumers can read and decompress the shards in parallel.
+ * A manifest file is also created that records the global dimensions and the block boundaries.
+ *
+ * Shard `i` is written to `<prefix>.<i>.mtx` (or `<prefix>.<i>.mtx.gz` if compressed), while the manifest is written to `<prefix>.manifest`.
+ * The manifest is a tab-separated text file where the first line is a `%%tatami_mtx shards` header;
+ * the second line contains the number of rows, the number of columns, `row` or `column` for the splitting dimension, and the number of shards;
+ * and each subsequent line contains the start and end of each block and the file name of the corresponding shard, relative to the manifest's directory.
+ *
+ * @tparam Value_ Numeric type of the matrix data.
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param matrix Input matrix.
+ * @param prefix Prefix of the paths to the shard and manifest files.
+ * @param options Options for writing the shards.
+ *
+ * @return Manifest describing the shards.
+ */
+template<typename Value_, typename Index_>
+ShardManifest<Index_> write_matrix_sharded(const tatami::Matrix<Value_, Index_>& matrix, const std::string& prefix, const WriteMatrixShardedOptions& options) {
+    if (options.num_shards < 1) {
+        throw std::runtime_error("number of shards should be positive");
+    }
+
+    ShardManifest<Index_> manifest;
+    manifest.nrow = matrix.nrow();
+    manifest.ncol = matrix.ncol();
+    manifest.by_row = (options.by_row.has_value() ? *(options.by_row) : matrix.prefer_rows());
+
+    // Evenly splitting the dimension, with the first few shards getting one extra row/column if it doesn't divide evenly.
+    const auto extent = (manifest.by_row ? manifest.nrow : manifest.ncol);
+    const Index_ num_shards = sanisizer::cast<Index_>(options.num_shards);
+    const Index_ per_shard = extent / num_shards;
+    const Index_ remainder = extent % num_shards;
+    sanisizer::resize(manifest.boundaries, sanisizer::sum<std::size_t>(num_shards, 1));
+    for (Index_ s = 0; s < num_shards; ++s) {
+        manifest.boundaries[s + 1] = manifest.boundaries[s] + per_shard + (s < remainder);
+    }
+
+    const auto dir = internal::manifest_directory(prefix);
+    std::vector<std::string> names;
+    names.reserve(num_shards);
+    manifest.paths.reserve(num_shards);
+    for (Index_ s = 0; s < num_shards; ++s) {
+        std::string path = prefix + "." + std::to_string(s) + ".mtx";
+#if __has_include("zlib.h")
+        if (options.gzip) {
+            path += ".gz";
+        }
+#endif
+        names.push_back(path.substr(dir.size()));
+        manifest.paths.push_back(std::move(path));
+    }
+
+    auto write_options = options.write;
+    write_options.symmetric = false;
+
+    // The matrix is guaranteed to outlive the shard views, so we use a non-owning pointer.
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > ptr(std::shared_ptr<const tatami::Matrix<Value_, Index_> >(), &matrix);
+
+    tatami::parallelize([&](int, Index_ start, Index_ length) -> void {
+        for (Index_ s = start, end = start + length; s < end; ++s) {
+            tatami::DelayedSubsetBlock<Value_, Index_> shard(ptr, manifest.boundaries[s], manifest.boundaries[s + 1] - manifest.boundaries[s], manifest.by_row);
+            const auto& path = manifest.paths[s];
+#if __has_include("zlib.h")
+            if (options.gzip) {
+                write_matrix_to_gzip_file(shard, path.c_str(), write_options);
+                continue;
+            }
+#endif
+            write_matrix_to_text_file(shard, path.c_str(), write_options);
+        }
+    }, num_shards, options.num_threads);
+
+    std::ofstream output(prefix + ".manifest");
+    if (!output) {
+        throw std::runtime_error("failed to open the manifest file at '" + prefix + ".manifest'");
+    }
+    output << "%%tatami_mtx shards\n";
+    output << manifest.nrow << '\t' << manifest.ncol << '\t' << (manifest.by_row ? "row" : "column") << '\t' << num_shards << '\n';
+    for (Index_ s = 0; s < num_shards; ++s) {
+        output << manifest.boundaries[s] << '\t' << manifest.boundaries[s + 1] << '\t' << names[s] << '\n';
+    }
+    output.close();
+    if (!output) {
+        throw std::runtime_error("failed to write the manifest file at '" + prefix + ".manifest'");
+    }
+
+    return manifest;
+}
+
+/**
+ * Read the manifest created by `write_matrix_sharded()`.
+ *
+ * @tparam Index_ Integer type of the row/column indices.
+ *
+ * @param manifest_path Path to the manifest file.
+ *
+ * @return Manifest describing the shards.
+ * Paths to the shard files are resolved relative to the directory containing the manifest.
+ */
+template<typename Index_>
+ShardManifest<Index_> read_shard_manifest(const std::string& manifest_path) {
+    std::ifstream input(manifest_path);
+    if (!input) {
+        throw std::runtime_error("failed to open the manifest file at '" + manifest_path + "'");
+    }
+
+    std::string line;
+    if (!std::getline(input, line) || line != "%%tatami_mtx shards") {
+        throw std::runtime_error("unrecognized header in the manifest file");
+    }
+
+    ShardManifest<Index_> manifest;
+    unsigned long long num_shards;
+    {
+        if (!std::getline(input, line)) {
+            throw std::runtime_error("missing dimensions in the manifest file");
+        }
+        std::istringstream fields(line);
+        unsigned long long nr, nc;
+        std::string dim;
+        if (!(fields >> nr >> nc >> dim >> num_shards) || (dim != "row" && dim != "column")) {
+            throw std::runtime_error("invalid dimensions in the manifest file");
+        }
+        manifest.nrow = sanisizer::cast<Index_>(nr);
+        manifest.ncol = sanisizer::cast<Index_>(nc);
+        manifest.by_row = (dim == "row");
+    }
+
+    const auto dir = internal::manifest_directory(manifest_path);
+    manifest.boundaries.push_back(0);
+    for (unsigned long long s = 0; s < num_shards; ++s) {
+        if (!std::getline(input, line)) {
+            throw std::runtime_error("fewer shards than expected in the manifest file");
+        }
+        std::istringstream fields(line);
+        unsigned long long start, end;
+        std::string name;
+        if (!(fields >> start >> end) || !std::getline(fields >> std::ws, name) || !sanisizer::is_equal(start, manifest.boundaries.back()) || end < start) {
+            throw std::runtime_error("invalid shard boundaries in the manifest file");
+        }
+        manifest.boundaries.push_back(sanisizer::cast<Index_>(end));
+        manifest.paths.push_back(dir + name);
+    }
+
+    if (!sanisizer::is_equal(manifest.boundaries.back(), manifest.by_row ? manifest.nrow : manifest.ncol)) {
+        throw std::runtime_error("shard boundaries do not cover the matrix in the manifest file");
+    }
+
+    return manifest;
+}
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/write_binary_matrix.hpp"
+#include "tatami_mtx/load_binary_matrix.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+class BinaryMatrixTest : public ::testing::TestWithParam<std::tuple<int, bool, bool, bool> > {
+protected:
+    static std::vector<double> simulate(int NR, int NC) {
+        auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.15;
+            opt.lower = -10;
+            opt.upper = 10;
+            return opt;
+        }());
+        for (auto& v : vec) {
+            v = std::round(v); // so that integer storage types are exact.
+        }
+        return vec;
+    }
+};
+
+TEST_P(BinaryMatrixTest, RoundTrip) {
+    const auto& params = GetParam();
+    const int mode = std::get<0>(params);
+    const bool by_row = std::get<1>(params);
+    const bool compress = std::get<2>(params);
+    const bool memory_map = std::get<3>(params);
+
+    const int NR = 87, NC = 53;
+    auto vec = simulate(NR, NC);
+    auto dense = std::make_shared<tatami::DenseMatrix<double, int, std::vector<double> > >(NR, NC, vec, true);
+    std::shared_ptr<tatami::Matrix<double, int> > mat;
+    if (mode == 0) {
+        mat = dense;
+    } else {
+        mat = tatami::convert_to_compressed_sparse<double, int>(*dense, mode == 1, {});
+    }
+
+    tatami_mtx::WriteBinaryMatrixOptions wopt;
+    wopt.by_row = by_row;
+    wopt.compress = compress;
+    wopt.block_size = 100;
+    wopt.num_threads = 2;
+
+    tatami_mtx::LoadBinaryMatrixOptions lopt;
+    lopt.memory_map = memory_map;
+    lopt.check = true;
+    lopt.num_threads = 3;
+
+    // Same types in memory and on disk.
+    {
+        auto path = temp_file_path("tatami_mtx-test-binary_matrix");
+        tatami_mtx::write_binary_matrix_to_file(*mat, path.c_str(), wopt);
+
+        auto header = tatami_mtx::read_binary_matrix_header(path.c_str());
+        EXPECT_EQ(header.nrow, static_cast<unsigned long long>(NR));
+        EXPECT_EQ(header.ncol, static_cast<unsigned long long>(NC));
+        EXPECT_EQ(header.row, by_row);
+        EXPECT_EQ(header.compressed, compress);
+        EXPECT_EQ(header.value_type, tatami_mtx::BinaryDataType::FLOAT64);
+        EXPECT_EQ(header.index_type, tatami_mtx::BinaryDataType::INT32);
+        EXPECT_EQ(header.nnz, static_cast<unsigned long long>(std::count_if(vec.begin(), vec.end(), [](double x) -> bool { return x != 0; })));
+
+        auto loaded = tatami_mtx::load_binary_matrix_from_file<double, int>(path.c_str(), lopt);
+        EXPECT_TRUE(loaded->is_sparse());
+        EXPECT_EQ(loaded->prefer_rows(), by_row);
+        const bool mapped = (memory_map && !compress);
+        typedef tatami_mtx::MappedCompressedSparseMatrix<double, int, double, int> Mapped;
+        EXPECT_EQ(dynamic_cast<const Mapped*>(loaded.get()) != NULL, mapped);
+        tatami_test::test_simple_row_access(*loaded, *dense);
+        tatami_test::test_simple_column_access(*loaded, *dense);
+    }
+
+    // Different types on disk, requiring conversion.
+    {
+        auto path = temp_file_path("tatami_mtx-test-binary_matrix");
+        tatami_mtx::write_binary_matrix_to_file<double, int, std::int16_t, std::uint8_t>(*mat, path.c_str(), wopt);
+        auto header = tatami_mtx::read_binary_matrix_header(path.c_str());
+        EXPECT_EQ(header.value_type, tatami_mtx::BinaryDataType::INT16);
+        EXPECT_EQ(header.index_type, tatami_mtx::BinaryDataType::UINT8);
+
+        auto loaded = tatami_mtx::load_binary_matrix_from_file<double, int, float, std::uint16_t>(path.c_str(), lopt);
+        tatami_test::test_simple_row_access(*loaded, *dense);
+
+        auto mapped = tatami_mtx::load_binary_matrix_from_file<double, int, std::int16_t, std::uint8_t>(path.c_str(), lopt);
+        tatami_test::test_simple_column_access(*mapped, *dense);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BinaryMatrix,
+    BinaryMatrixTest,
+    ::testing::Combine(
+        ::testing::Values(0, 1, 2), // dense, sparse row, sparse column
+        ::testing::Values(false, true), // by row
+        ::testing::Values(false, true), // compressed
+        ::testing::Values(false, true) // memory map
+    )
+);
+
+TEST(BinaryMatrix, Empty) {
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(10, 0, std::vector<double>(), true);
+    for (int compress = 0; compress < 2; ++compress) {
+        auto path = temp_file_path("tatami_mtx-test-binary_matrix");
+        tatami_mtx::write_binary_matrix_to_file(mat, path.c_str(), [&]{
+            tatami_mtx::WriteBinaryMatrixOptions opt;
+            opt.compress = compress;
+            return opt;
+        }());
+        auto loaded = tatami_mtx::load_binary_matrix_from_file<double, int>(path.c_str(), {});
+        EXPECT_EQ(loaded->nrow(), 10);
+        EXPECT_EQ(loaded->ncol(), 0);
+    }
+}
+
+TEST(BinaryMatrix, Errors) {
+    auto path = temp_file_path("tatami_mtx-test-binary_matrix");
+    {
+        std::ofstream output(path, std::ios::binary);
+        output << "foo";
+    }
+    tatami_test::throws_error([&]() {
+        tatami_mtx::read_binary_matrix_header(path.c_str());
+    }, "too small");
+
+    {
+        std::ofstream output(path, std::ios::binary);
+        output << std::string(64, 'a');
+    }
+    tatami_test::throws_error([&]() {
+        tatami_mtx::read_binary_matrix_header(path.c_str());
+    }, "magic");
+
+    // Truncating a valid file.
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(10, 5, std::vector<double>(50, 1), true);
+    tatami_mtx::write_binary_matrix_to_file(mat, path.c_str(), {});
+    std::vector<char> contents;
+    {
+        std::ifstream input(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream output(path, std::ios::binary);
+        output.write(contents.data(), contents.size() - 16);
+    }
+    for (int memory_map = 0; memory_map < 2; ++memory_map) {
+        tatami_test::throws_error([&]() {
+            tatami_mtx::load_binary_matrix_from_file<double, int>(path.c_str(), [&]{
+                tatami_mtx::LoadBinaryMatrixOptions opt;
+                opt.memory_map = memory_map;
+                return opt;
+            }());
+        }, "truncated");
+    }
+
+    // Indices that do not fit in the stored type.
+    tatami::DenseMatrix<double, int, std::vector<double> > wide(2, 300, std::vector<double>(600, 1), true);
+    tatami_test::throws_error([&]() {
+        tatami_mtx::write_binary_matrix_to_file<double, int, double, std::uint8_t>(wide, path.c_str(), {});
+    }, "too large for the stored index type");
+
+    // Narrowing is fine if the largest index fits.
+    tatami::DenseMatrix<double, int, std::vector<double> > narrow(2, 256, std::vector<double>(512, 1), true);
+    tatami_mtx::write_binary_matrix_to_file<double, int, double, std::uint8_t>(narrow, path.c_str(), {});
+    auto reloaded = tatami_mtx::load_binary_matrix_from_file<double, int>(path.c_str(), {});
+    tatami_test::test_simple_row_access(*reloaded, narrow);
+}
@@ -0,0 +1,280 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/delta_varint_sparse_matrix.hpp"
+#include "tatami_mtx/load_matrix.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+class DeltaVarintSparseMatrixTest : public ::testing::TestWithParam<std::tuple<bool, std::size_t> > {
+protected:
+    inline static const int NR = 123, NC = 457;
+
+    static std::vector<double> simulate() {
+        auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.2;
+            opt.lower = -10;
+            opt.upper = 10;
+            return opt;
+        }());
+
+        for (auto& v : vec) {
+            v = std::round(v); // so that float storage is exact.
+        }
+
+        // Adding a few empty rows and columns, along with some large gaps.
+        for (int r = 0; r < NR; ++r) {
+            for (int c = 0; c < NC; ++c) {
+                if (r % 17 == 0 || c % 23 == 0 || (c > 150 && c < 400 && r % 2 == 0)) {
+                    vec[r * NC + c] = 0;
+                }
+            }
+        }
+        return vec;
+    }
+};
+
+TEST_P(DeltaVarintSparseMatrixTest, Access) {
+    const auto& params = GetParam();
+    const bool csr = std::get<0>(params);
+    const auto interval = std::get<1>(params);
+
+    auto vec = simulate();
+    tatami::DenseMatrix<double, int, std::vector<double> > dense(NR, NC, vec, true);
+
+    // Extracting the compressed components.
+    const int num_primary = (csr ? NR : NC);
+    const int num_secondary = (csr ? NC : NR);
+    std::vector<double> values;
+    std::vector<int> indices;
+    std::vector<std::size_t> pointers(1);
+    auto ext = dense.dense(csr, tatami::Options());
+    std::vector<double> buffer(num_secondary);
+    for (int p = 0; p < num_primary; ++p) {
+        auto ptr = ext->fetch(p, buffer.data());
+        for (int s = 0; s < num_secondary; ++s) {
+            if (ptr[s] != 0) {
+                values.push_back(ptr[s]);
+                indices.push_back(s);
+            }
+        }
+        pointers.push_back(values.size());
+    }
+
+    auto encoded = tatami_mtx::encode_delta_varint_indices<int>(num_primary, pointers, indices, interval);
+    EXPECT_EQ(encoded.pointers, pointers);
+    EXPECT_LT(encoded.bytes.size(), indices.size() * 2); // at most 2 bytes per gap for these dimensions.
+
+    tatami_mtx::DeltaVarintSparseMatrix<double, int> mat(NR, NC, values, encoded, csr);
+    EXPECT_EQ(mat.nrow(), NR);
+    EXPECT_EQ(mat.ncol(), NC);
+    EXPECT_TRUE(mat.is_sparse());
+    EXPECT_EQ(mat.prefer_rows(), csr);
+    EXPECT_FALSE(mat.uses_oracle(true));
+
+    tatami_test::test_simple_row_access(mat, dense);
+    tatami_test::test_simple_column_access(mat, dense);
+
+    // Different stored type.
+    std::vector<float> fvalues(values.begin(), values.end());
+    tatami_mtx::DeltaVarintSparseMatrix<double, int, float> fmat(NR, NC, std::move(fvalues), encoded, csr);
+    tatami_test::test_simple_row_access(fmat, dense);
+    tatami_test::test_simple_column_access(fmat, dense);
+
+    // Accessing in reverse, to check that the cursors are correctly reset.
+    for (int row = 0; row < 2; ++row) {
+        const int num = (row ? NR : NC), len = (row ? NC : NR);
+        auto sub = std::make_shared<std::vector<int> >();
+        for (int i = 2; i < len; i += 7) {
+            sub->push_back(i);
+        }
+
+        auto mext = mat.dense(row, sub, tatami::Options());
+        auto rext = dense.dense(row, sub, tatami::Options());
+        auto mext2 = mat.sparse(row, 5, len - 10, tatami::Options());
+        auto rext2 = dense.dense(row, 5, len - 10, tatami::Options());
+        std::vector<double> mbuffer(len), rbuffer(len), vbuffer(len);
+        std::vector<int> ibuffer(len);
+
+        for (int i = num; i > 0; --i) {
+            auto mptr = mext->fetch(i - 1, mbuffer.data());
+            auto rptr = rext->fetch(i - 1, rbuffer.data());
+            EXPECT_EQ(std::vector<double>(mptr, mptr + sub->size()), std::vector<double>(rptr, rptr + sub->size()));
+
+            auto range = mext2->fetch(i - 1, vbuffer.data(), ibuffer.data());
+            auto rptr2 = rext2->fetch(i - 1, rbuffer.data());
+            std::vector<double> expanded(len - 10);
+            for (int k = 0; k < range.number; ++k) {
+                expanded[range.index[k] - 5] = range.value[k];
+            }
+            EXPECT_EQ(expanded, std::vector<double>(rptr2, rptr2 + len - 10));
+        }
+    }
+
+    // Oracular access.
+    for (int row = 0; row < 2; ++row) {
+        const int num = (row ? NR : NC), len = (row ? NC : NR);
+        auto mext = tatami::consecutive_extractor<true>(mat, row, 0, num);
+        auto rext = dense.dense(row, tatami::Options());
+        std::vector<double> vbuffer(len), rbuffer(len);
+        std::vector<int> ibuffer(len);
+        for (int i = 0; i < num; ++i) {
+            auto range = mext->fetch(vbuffer.data(), ibuffer.data());
+            auto rptr = rext->fetch(i, rbuffer.data());
+            std::vector<double> expanded(len);
+            for (int k = 0; k < range.number; ++k) {
+                expanded[range.index[k]] = range.value[k];
+            }
+            EXPECT_EQ(expanded, std::vector<double>(rptr, rptr + len));
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    DeltaVarintSparseMatrix,
+    DeltaVarintSparseMatrixTest,
+    ::testing::Combine(
+        ::testing::Values(true, false), // CSR or CSC.
+        ::testing::Values(1, 4, 64) // skip interval.
+    )
+);
+
+TEST(DeltaVarintSparseMatrix, LargeGaps) {
+    // Checking that multi-byte varints are correctly handled.
+    std::vector<std::size_t> pointers { 0, 4, 4, 6 };
+    std::vector<std::uint32_t> indices { 0, 200, 100000, 3000000000u, 5, 4000000000u };
+    auto encoded = tatami_mtx::encode_delta_varint_indices<std::uint32_t>(3, pointers, indices, 2);
+    EXPECT_EQ(encoded.skip_bases, std::vector<std::uint32_t>{ 200 });
+
+    std::vector<double> values { 1, 2, 3, 4, 5, 6 };
+    tatami_mtx::DeltaVarintSparseMatrix<double, std::uint32_t> mat(3, 4000000001u, values, encoded, true);
+    auto ext = mat.sparse(true, tatami::Options());
+    std::vector<double> vbuffer(6);
+    std::vector<std::uint32_t> ibuffer(6);
+
+    auto range = ext->fetch(0, vbuffer.data(), ibuffer.data());
+    EXPECT_EQ(std::vector<std::uint32_t>(range.index, range.index + range.number), std::vector<std::uint32_t>(indices.begin(), indices.begin() + 4));
+    range = ext->fetch(1, vbuffer.data(), ibuffer.data());
+    EXPECT_EQ(range.number, 0);
+    range = ext->fetch(2, vbuffer.data(), ibuffer.data());
+    EXPECT_EQ(std::vector<std::uint32_t>(range.index, range.index + range.number), std::vector<std::uint32_t>(indices.begin() + 4, indices.end()));
+
+    auto bext = mat.sparse(true, 150000u, 3500000000u, tatami::Options());
+    range = bext->fetch(0, vbuffer.data(), ibuffer.data());
+    ASSERT_EQ(range.number, 1);
+    EXPECT_EQ(range.index[0], 3000000000u);
+    EXPECT_EQ(range.value[0], 4);
+}
+
+TEST(DeltaVarintSparseMatrix, Errors) {
+    std::vector<std::size_t> pointers { 0, 2 };
+    std::vector<int> indices { 5, 2 };
+    tatami_test::throws_error([&]() {
+        tatami_mtx::encode_delta_varint_indices<int>(1, pointers, indices);
+    }, "sorted");
+
+    indices[1] = 10;
+    tatami_test::throws_error([&]() {
+        tatami_mtx::encode_delta_varint_indices<int>(1, pointers, indices, 0);
+    }, "positive");
+
+    auto encoded = tatami_mtx::encode_delta_varint_indices<int>(1, pointers, indices);
+    tatami_test::throws_error([&]() {
+        tatami_mtx::DeltaVarintSparseMatrix<double, int>(2, 20, std::vector<double>(2), encoded, true);
+    }, "number of rows/columns");
+    tatami_test::throws_error([&]() {
+        tatami_mtx::DeltaVarintSparseMatrix<double, int>(1, 20, std::vector<double>(3), encoded, true);
+    }, "number of values");
+}
+
+TEST(DeltaVarintSparseMatrix, Load) {
+    const int NR = 50, NC = 80;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.1;
+        opt.lower = 1;
+        opt.upper = 100;
+        return opt;
+    }());
+    for (auto& v : vec) {
+        v = std::round(v);
+    }
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(NR, NC, vec, true);
+
+    byteme::RawBufferWriter writer({});
+    tatami_mtx::WriteMatrixOptions wopt;
+    wopt.coordinate = true;
+    tatami_mtx::write_matrix(ref, writer, wopt);
+    writer.finish();
+    const auto& buffer = writer.output;
+
+    typedef tatami_mtx::DeltaVarintSparseMatrix<double, int, double> Expected;
+    for (int row = 0; row < 2; ++row) {
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.row = row;
+        opt.delta_varint_indices = true;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(buffer.data(), buffer.size(), opt);
+        EXPECT_NE(dynamic_cast<const Expected*>(out.get()), nullptr);
+        EXPECT_EQ(out->prefer_rows(), static_cast<bool>(row));
+        tatami_test::test_simple_row_access(*out, ref);
+        tatami_test::test_simple_column_access(*out, ref);
+    }
+}
+
+TEST(DeltaVarintSparseMatrix, Duplicates) {
+    // Repeated indices are encoded as zero gaps, including at the boundaries between skip groups.
+    std::vector<std::size_t> pointers { 0, 5 };
+    std::vector<int> indices { 1, 1, 4, 4, 4 };
+    auto encoded = tatami_mtx::encode_delta_varint_indices<int>(1, pointers, indices, 2);
+    EXPECT_EQ(encoded.skip_bases, (std::vector<int>{ 1, 4 }));
+
+    std::vector<double> values { 1, 2, 3, 4, 5 };
+    tatami_mtx::DeltaVarintSparseMatrix<double, int> mat(1, 6, values, encoded, true);
+    auto ext = mat.sparse(true, tatami::Options());
+    std::vector<double> vbuffer(5);
+    std::vector<int> ibuffer(5);
+    auto range = ext->fetch(0, vbuffer.data(), ibuffer.data());
+    EXPECT_EQ(std::vector<int>(range.index, range.index + range.number), indices);
+    EXPECT_EQ(std::vector<double>(range.value, range.value + range.number), values);
+
+    // Seeking to a repeated index should land on its first occurrence.
+    auto bext = mat.sparse(true, 4, 2, tatami::Options());
+    range = bext->fetch(0, vbuffer.data(), ibuffer.data());
+    EXPECT_EQ(std::vector<double>(range.value, range.value + range.number), (std::vector<double>{ 3, 4, 5 }));
+
+    // Loading a Matrix Market file with a duplicated triplet should behave as the default loader.
+    std::string contents = "%%MatrixMarket matrix coordinate integer general\n2 3 4\n1 2 3\n2 1 5\n1 2 4\n2 3 6\n";
+    for (int row = 0; row < 2; ++row) {
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.row = row;
+        auto ref = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+        opt.delta_varint_indices = true;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+
+        // Duplicates are summed by neither loader, so the last value is reported in the dense output.
+        const int num_primary = (row ? 2 : 3), num_secondary = (row ? 3 : 2);
+        auto oext = out->dense(row, tatami::Options());
+        auto rext = ref->dense(row, tatami::Options());
+        std::vector<double> obuffer(num_secondary), rbuffer(num_secondary);
+        for (int p = 0; p < num_primary; ++p) {
+            auto optr = oext->fetch(p, obuffer.data());
+            auto rptr = rext->fetch(p, rbuffer.data());
+            EXPECT_EQ(std::vector<double>(optr, optr + num_secondary), std::vector<double>(rptr, rptr + num_secondary));
+        }
+
+        // Both copies of the duplicated element are retained in the first row.
+        auto sext = out->sparse(row, tatami::Options());
+        std::vector<double> svbuffer(num_secondary + 1);
+        std::vector<int> sibuffer(num_secondary + 1);
+        auto srange = sext->fetch(0, svbuffer.data(), sibuffer.data());
+        EXPECT_EQ(srange.number, (row ? 2 : 1));
+    }
+}
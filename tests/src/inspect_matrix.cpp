@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/inspect_matrix.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+TEST(InspectMatrix, Coordinate) {
+    std::string contents = "%%MatrixMarket matrix coordinate integer general\n% a comment\n300 20 5\n1 1 1\n2 2 2\n3 3 3\n4 4 4\n5 5 5\n";
+    const auto buffer = reinterpret_cast<const unsigned char*>(contents.data());
+
+    // By row.
+    {
+        auto details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), {});
+        EXPECT_EQ(details.format, eminem::Format::COORDINATE);
+        EXPECT_EQ(details.field, eminem::Field::INTEGER);
+        EXPECT_EQ(details.symmetry, eminem::Symmetry::GENERAL);
+        EXPECT_EQ(details.nrow, 300);
+        EXPECT_EQ(details.ncol, 20);
+        EXPECT_EQ(details.nlines, 5);
+        EXPECT_EQ(details.value_type, tatami_mtx::BinaryDataType::INT32);
+        EXPECT_EQ(details.index_type, tatami_mtx::BinaryDataType::UINT8);
+        EXPECT_EQ(details.temporary_index_type, tatami_mtx::BinaryDataType::UINT16);
+        EXPECT_EQ(details.triplet_bytes, 5 * (2 + 1 + 4));
+        EXPECT_EQ(details.pointer_bytes, 301 * sizeof(std::size_t));
+        EXPECT_EQ(details.final_bytes, 5 * (1 + 4) + 301 * sizeof(std::size_t));
+        EXPECT_EQ(details.peak_bytes, details.triplet_bytes + details.pointer_bytes);
+    }
+
+    // Accounting for the extra copies from parallel compression and first touch.
+    {
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.compress_threads = 3;
+        auto details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), opt);
+        const unsigned long long base = details.triplet_bytes + details.pointer_bytes;
+        EXPECT_EQ(details.peak_bytes, base + 5 * (1 + 4) + 3 * 300 * sizeof(std::size_t));
+
+        opt.compress_threads = 1;
+        opt.first_touch_threads = 2;
+        details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), opt);
+        EXPECT_EQ(details.peak_bytes, base - 5 * 2 + details.pointer_bytes); // primary indices are released, and pointers are the largest array here.
+
+        // The larger of the two phases is reported when both are enabled.
+        opt.compress_threads = 3;
+        details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), opt);
+        EXPECT_EQ(details.peak_bytes, base + 5 * (1 + 4) + 3 * 300 * sizeof(std::size_t));
+    }
+
+    // Accounting for the pointers and workspaces of tiles.
+    {
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.tiled = true;
+        opt.tile_nrow = 100;
+        opt.tile_ncol = 8;
+        opt.num_threads = 2;
+        auto details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), opt);
+        EXPECT_EQ(details.triplet_bytes, 5 * (2 + 1 + 4));
+        EXPECT_EQ(details.pointer_bytes, (3 * 3 + 1) * 101 * sizeof(std::uint32_t));
+        EXPECT_EQ(details.final_bytes, 5 * (1 + 4) + details.pointer_bytes);
+        const unsigned long long worker = 5 * (4 + 1 + sizeof(int)) + (100 + 8 + 2) * sizeof(std::size_t);
+        EXPECT_EQ(details.peak_bytes, details.triplet_bytes + details.pointer_bytes + (3 * 3 + 1) * 2 * sizeof(std::size_t) + 2 * worker);
+
+        // Tiles are truncated to the matrix dimensions.
+        opt.tile_nrow = 1000;
+        opt.tile_ncol = 1000;
+        details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), opt);
+        EXPECT_EQ(details.pointer_bytes, 2 * 301 * sizeof(std::uint32_t));
+    }
+
+    // By column, with explicit types.
+    {
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.row = false;
+        auto details = tatami_mtx::inspect_matrix_from_text_buffer<int, double, std::uint32_t>(buffer, contents.size(), opt);
+        EXPECT_EQ(details.value_type, tatami_mtx::BinaryDataType::FLOAT64);
+        EXPECT_EQ(details.index_type, tatami_mtx::BinaryDataType::UINT32);
+        EXPECT_EQ(details.temporary_index_type, tatami_mtx::BinaryDataType::UINT8);
+        EXPECT_EQ(details.triplet_bytes, 5 * (1 + 4 + 8));
+        EXPECT_EQ(details.pointer_bytes, 21 * sizeof(std::size_t));
+    }
+}
+
+TEST(InspectMatrix, Symmetric) {
+    std::string contents = "%%MatrixMarket matrix coordinate real symmetric\n100000 100000 3\n1 1 1\n2 1 2\n3 3 3\n";
+    const auto buffer = reinterpret_cast<const unsigned char*>(contents.data());
+    auto details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), {});
+    EXPECT_EQ(details.symmetry, eminem::Symmetry::SYMMETRIC);
+    EXPECT_EQ(details.value_type, tatami_mtx::BinaryDataType::FLOAT64);
+    EXPECT_EQ(details.index_type, tatami_mtx::BinaryDataType::UINT32);
+    EXPECT_EQ(details.temporary_index_type, tatami_mtx::BinaryDataType::UINT32);
+    EXPECT_EQ(details.triplet_bytes, 6 * (4 + 4 + 8)); // reserving space for the mirrored elements.
+}
+
+TEST(InspectMatrix, Array) {
+    std::string contents = "%%MatrixMarket matrix array real general\n3 4\n";
+    const auto buffer = reinterpret_cast<const unsigned char*>(contents.data());
+    auto details = tatami_mtx::inspect_matrix_from_text_buffer<int>(buffer, contents.size(), {});
+    EXPECT_EQ(details.format, eminem::Format::ARRAY);
+    EXPECT_EQ(details.nlines, 12);
+    EXPECT_EQ(details.triplet_bytes, 0);
+    EXPECT_EQ(details.pointer_bytes, 0);
+    EXPECT_EQ(details.final_bytes, 12 * 8);
+    EXPECT_EQ(details.peak_bytes, 12 * 8);
+
+    std::string pattern = "%%MatrixMarket matrix array pattern general\n3 4\n";
+    tatami_test::throws_error([&]() {
+        tatami_mtx::inspect_matrix_from_text_buffer<int>(reinterpret_cast<const unsigned char*>(pattern.data()), pattern.size(), {});
+    }, "unsupported");
+}
+
+TEST(InspectMatrix, Files) {
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(10, 7, std::vector<double>(70, 1), true);
+    tatami_mtx::WriteMatrixOptions wopt;
+    wopt.coordinate = true;
+
+    auto path = temp_file_path("tatami_mtx-test-inspect_matrix");
+    tatami_mtx::write_matrix_to_text_file(mat, path.c_str(), wopt);
+    auto details = tatami_mtx::inspect_matrix_from_text_file<int>(path.c_str(), {});
+    EXPECT_EQ(details.nrow, 10);
+    EXPECT_EQ(details.ncol, 7);
+    EXPECT_EQ(details.nlines, 70);
+
+    auto details2 = tatami_mtx::inspect_matrix_from_some_file<int>(path.c_str(), {});
+    EXPECT_EQ(details2.nlines, 70);
+
+    auto gzpath = temp_file_path("tatami_mtx-test-inspect_matrix") + ".gz";
+    tatami_mtx::write_matrix_to_gzip_file(mat, gzpath.c_str(), wopt);
+    auto details3 = tatami_mtx::inspect_matrix_from_gzip_file<int>(gzpath.c_str(), {});
+    EXPECT_EQ(details3.nlines, 70);
+    auto details4 = tatami_mtx::inspect_matrix_from_some_file<int>(gzpath.c_str(), {});
+    EXPECT_EQ(details4.nlines, 70);
+    EXPECT_EQ(details4.peak_bytes, details.peak_bytes);
+}
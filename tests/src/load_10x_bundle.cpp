@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/load_10x_bundle.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <filesystem>
+
+class Load10xBundleTest : public ::testing::TestWithParam<std::tuple<bool, bool, int> > {
+protected:
+    inline static const int NR = 30, NC = 25;
+
+    static std::shared_ptr<tatami::Matrix<double, int> > simulate() {
+        auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.2;
+            opt.lower = 1;
+            opt.upper = 20;
+            return opt;
+        }());
+        for (auto& v : vec) {
+            v = std::round(v);
+        }
+        return std::make_shared<tatami::DenseMatrix<double, int, std::vector<double> > >(NR, NC, std::move(vec), true);
+    }
+
+    static void write_lines(const std::string& path, const std::string& contents, bool gzip) {
+        std::unique_ptr<byteme::Writer> writer;
+        if (gzip) {
+            writer.reset(new byteme::GzipFileWriter(path.c_str(), {}));
+        } else {
+            writer.reset(new byteme::RawFileWriter(path.c_str(), {}));
+        }
+        writer->write(reinterpret_cast<const unsigned char*>(contents.data()), contents.size());
+        writer->finish();
+    }
+
+    static std::string create_directory(const tatami::Matrix<double, int>& mat, bool gzip, bool types) {
+        auto dir = temp_file_path("tatami_mtx-test-load_10x_bundle");
+        std::filesystem::create_directory(dir);
+        std::string suffix = (gzip ? ".gz" : "");
+
+        tatami_mtx::WriteMatrixOptions wopt;
+        wopt.coordinate = true;
+        wopt.by_row = false;
+        if (gzip) {
+            tatami_mtx::write_matrix_to_gzip_file(mat, (dir + "/matrix.mtx.gz").c_str(), wopt);
+        } else {
+            tatami_mtx::write_matrix_to_text_file(mat, (dir + "/matrix.mtx").c_str(), wopt);
+        }
+
+        std::string features;
+        for (int r = 0; r < NR; ++r) {
+            features += "ENSG" + std::to_string(r) + "\tGENE" + std::to_string(r);
+            if (types) {
+                features += (r % 3 == 0 ? "\tAntibody Capture" : "\tGene Expression");
+            }
+            features += "\n";
+        }
+        write_lines(dir + (types ? "/features.tsv" : "/genes.tsv") + suffix, features, gzip);
+
+        std::string barcodes;
+        for (int c = 0; c < NC; ++c) {
+            barcodes += "CELL-" + std::to_string(c) + "\n";
+        }
+        write_lines(dir + "/barcodes.tsv" + suffix, barcodes, gzip);
+
+        return dir;
+    }
+};
+
+TEST_P(Load10xBundleTest, Basic) {
+    const auto& params = GetParam();
+    const bool gzip = std::get<0>(params);
+    const bool row = std::get<1>(params);
+    const int num_threads = std::get<2>(params);
+
+    auto ref = simulate();
+    auto dir = create_directory(*ref, gzip, true);
+
+    tatami_mtx::Load10xBundleOptions opt;
+    opt.num_threads = num_threads;
+    opt.load.row = row;
+    auto loaded = tatami_mtx::load_10x_bundle<double, int>(dir, opt);
+
+    EXPECT_EQ(loaded.matrix->prefer_rows(), row);
+    tatami_test::test_simple_row_access(*(loaded.matrix), *ref);
+    tatami_test::test_simple_column_access(*(loaded.matrix), *ref);
+    ASSERT_EQ(loaded.feature_ids.size(), static_cast<std::size_t>(NR));
+    EXPECT_EQ(loaded.feature_ids[1], "ENSG1");
+    EXPECT_EQ(loaded.feature_names[2], "GENE2");
+    EXPECT_EQ(loaded.feature_types[3], "Antibody Capture");
+    ASSERT_EQ(loaded.barcodes.size(), static_cast<std::size_t>(NC));
+    EXPECT_EQ(loaded.barcodes[4], "CELL-4");
+
+    // Filtering by type.
+    opt.feature_types = std::vector<std::string>{ "Gene Expression" };
+    auto filtered = tatami_mtx::load_10x_bundle<double, int, int, unsigned short>(dir, opt);
+
+    std::vector<int> keep;
+    for (int r = 0; r < NR; ++r) {
+        if (r % 3 != 0) {
+            keep.push_back(r);
+        }
+    }
+    auto expected = tatami::make_DelayedSubset<double, int>(ref, keep, true);
+    tatami_test::test_simple_row_access(*(filtered.matrix), *expected);
+    tatami_test::test_simple_column_access(*(filtered.matrix), *expected);
+
+    ASSERT_EQ(filtered.feature_ids.size(), keep.size());
+    for (std::size_t i = 0; i < keep.size(); ++i) {
+        EXPECT_EQ(filtered.feature_ids[i], "ENSG" + std::to_string(keep[i]));
+        EXPECT_EQ(filtered.feature_names[i], "GENE" + std::to_string(keep[i]));
+        EXPECT_EQ(filtered.feature_types[i], "Gene Expression");
+    }
+    EXPECT_EQ(filtered.barcodes, loaded.barcodes);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Load10xBundle,
+    Load10xBundleTest,
+    ::testing::Combine(
+        ::testing::Values(false, true), // gzip
+        ::testing::Values(false, true), // row
+        ::testing::Values(1, 3) // number of threads
+    )
+);
+
+TEST_F(Load10xBundleTest, OldFormat) {
+    auto ref = simulate();
+    auto dir = create_directory(*ref, false, false);
+
+    auto loaded = tatami_mtx::load_10x_bundle<double, int>(dir, {});
+    tatami_test::test_simple_column_access(*(loaded.matrix), *ref);
+    EXPECT_EQ(loaded.feature_ids.size(), static_cast<std::size_t>(NR));
+    EXPECT_EQ(loaded.feature_names.size(), static_cast<std::size_t>(NR));
+    EXPECT_TRUE(loaded.feature_types.empty());
+
+    tatami_mtx::Load10xBundleOptions opt;
+    opt.feature_types = std::vector<std::string>{ "Gene Expression" };
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_10x_bundle<double, int>(dir, opt);
+    }, "feature types");
+}
+
+TEST_F(Load10xBundleTest, ReorderAndSummaries) {
+    auto ref = simulate();
+    auto dir = create_directory(*ref, false, true);
+
+    tatami_mtx::LoadOrdering ordering;
+    tatami_mtx::LoadSummaries summaries;
+    tatami_mtx::Load10xBundleOptions opt;
+    opt.feature_types = std::vector<std::string>{ "Gene Expression" };
+    opt.load.reorder_rows = tatami_mtx::ReorderMode::CUSTOM;
+    const int num_kept = NR - (NR + 2) / 3;
+    for (int r = 0; r < num_kept; ++r) {
+        opt.load.custom_row_order.push_back((r + 7) % num_kept);
+    }
+    opt.load.reorder_columns = tatami_mtx::ReorderMode::CUSTOM;
+    for (int c = NC; c > 0; --c) {
+        opt.load.custom_column_order.push_back(c - 1);
+    }
+    opt.load.ordering = &ordering;
+    opt.load.summaries = &summaries;
+    auto loaded = tatami_mtx::load_10x_bundle<double, int>(dir, opt);
+
+    // Row orderings refer to the retained features.
+    std::vector<int> keep;
+    for (int r = 0; r < NR; ++r) {
+        if (r % 3 != 0) {
+            keep.push_back(r);
+        }
+    }
+    EXPECT_EQ(ordering.rows, opt.load.custom_row_order);
+    std::vector<int> row_order, column_order(ordering.columns.begin(), ordering.columns.end());
+    for (auto r : ordering.rows) {
+        row_order.push_back(keep[r]);
+    }
+    EXPECT_EQ(column_order, std::vector<int>(opt.load.custom_column_order.begin(), opt.load.custom_column_order.end()));
+
+    auto rsub = tatami::make_DelayedSubset<double, int>(ref, row_order, true);
+    auto expected = tatami::make_DelayedSubset<double, int>(std::move(rsub), column_order, false);
+    tatami_test::test_simple_row_access(*(loaded.matrix), *expected);
+
+    // Annotations are reordered to match the matrix.
+    for (std::size_t i = 0; i < row_order.size(); ++i) {
+        EXPECT_EQ(loaded.feature_ids[i], "ENSG" + std::to_string(row_order[i]));
+        EXPECT_EQ(loaded.feature_names[i], "GENE" + std::to_string(row_order[i]));
+    }
+    for (int c = 0; c < NC; ++c) {
+        EXPECT_EQ(loaded.barcodes[c], "CELL-" + std::to_string(column_order[c]));
+    }
+
+    // Summaries are also reported in the loaded order.
+    auto ext = expected->dense(true, tatami::Options());
+    std::vector<double> buffer(NC);
+    for (std::size_t i = 0; i < row_order.size(); ++i) {
+        auto ptr = ext->fetch(i, buffer.data());
+        double sum = 0;
+        std::size_t detected = 0;
+        for (int c = 0; c < NC; ++c) {
+            sum += ptr[c];
+            detected += (ptr[c] != 0);
+        }
+        EXPECT_EQ(summaries.row_sums[i], sum);
+        EXPECT_EQ(summaries.row_detected[i], detected);
+    }
+    EXPECT_EQ(summaries.column_sums.size(), static_cast<std::size_t>(NC));
+
+    // Annotations are still reordered if the ordering is not requested.
+    opt.load.ordering = NULL;
+    opt.load.summaries = NULL;
+    auto unordered = tatami_mtx::load_10x_bundle<double, int>(dir, opt);
+    EXPECT_EQ(unordered.feature_ids, loaded.feature_ids);
+    EXPECT_EQ(unordered.barcodes, loaded.barcodes);
+}
+
+TEST_F(Load10xBundleTest, StatisticsAndStorage) {
+    auto ref = simulate();
+    auto dir = create_directory(*ref, false, true);
+
+    // The matrix goes through load_matrix(), so automatic storage types and statistics are supported.
+    tatami_mtx::LoadStatistics stats;
+    tatami_mtx::Load10xBundleOptions opt;
+    opt.feature_types = std::vector<std::string>{ "Gene Expression" };
+    opt.load.statistics = &stats;
+    auto loaded = tatami_mtx::load_10x_bundle<double, int, tatami_mtx::Automatic, tatami_mtx::Automatic>(dir, opt);
+
+    std::vector<int> keep;
+    for (int r = 0; r < NR; ++r) {
+        if (r % 3 != 0) {
+            keep.push_back(r);
+        }
+    }
+    auto expected = tatami::make_DelayedSubset<double, int>(ref, keep, true);
+    tatami_test::test_simple_column_access(*(loaded.matrix), *expected);
+
+    // Dense matrices are written with all of their zeros, so every element is a line in the file.
+    EXPECT_EQ(stats.lines_parsed, static_cast<unsigned long long>(NR * NC));
+    EXPECT_EQ(stats.bytes_read, std::filesystem::file_size(dir + "/matrix.mtx"));
+
+    // Filtering is not supported for symmetric matrices.
+    write_lines(dir + "/matrix.mtx", "%%MatrixMarket matrix coordinate integer symmetric\n30 30 1\n2 1 5\n", false);
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_10x_bundle<double, int>(dir, opt);
+    }, "general");
+}
+
+TEST_F(Load10xBundleTest, Errors) {
+    auto ref = simulate();
+    auto dir = create_directory(*ref, false, true);
+    write_lines(dir + "/barcodes.tsv", "A\nB\n", false);
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_10x_bundle<double, int>(dir, {});
+    }, "number of barcodes");
+
+    std::filesystem::remove(dir + "/barcodes.tsv");
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_10x_bundle<double, int>(dir, {});
+    }, "barcodes.tsv");
+}
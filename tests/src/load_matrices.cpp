@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/load_matrices.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+#include "tatami_mtx/write_matrix_sharded.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <fstream>
+
+class LoadMatricesTest : public ::testing::TestWithParam<std::tuple<bool, int, bool, int> > {};
+
+TEST_P(LoadMatricesTest, Basic) {
+    const auto& params = GetParam();
+    const bool row = std::get<0>(params);
+    const int num_files = std::get<1>(params);
+    const bool gzip = std::get<2>(params);
+    const int num_threads = std::get<3>(params);
+
+    const int NR = 41, NC = 37;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        opt.lower = 1;
+        opt.upper = 50;
+        return opt;
+    }());
+    for (auto& v : vec) {
+        v = std::round(v);
+    }
+    auto ref = std::make_shared<tatami::DenseMatrix<double, int, std::vector<double> > >(NR, NC, std::move(vec), true);
+
+    auto prefix = temp_file_path("tatami_mtx-test-load_matrices");
+    auto manifest = tatami_mtx::write_matrix_sharded(*ref, prefix, [&]{
+        tatami_mtx::WriteMatrixShardedOptions opt;
+        opt.num_shards = num_files;
+        opt.by_row = row;
+        opt.gzip = gzip;
+        opt.write.coordinate = true;
+        return opt;
+    }());
+
+    // Replacing the first file with a dense array, to check that these are handled correctly.
+    {
+        std::shared_ptr<const tatami::Matrix<double, int> > cref(ref);
+        tatami::DelayedSubsetBlock<double, int> first(cref, manifest.boundaries[0], manifest.boundaries[1] - manifest.boundaries[0], row);
+        tatami_mtx::WriteMatrixOptions wopt;
+        wopt.coordinate = false;
+        manifest.paths[0] = prefix + ".dense.mtx";
+        tatami_mtx::write_matrix_to_text_file(first, manifest.paths[0].c_str(), wopt);
+    }
+
+    tatami_mtx::LoadMatricesOptions opt;
+    opt.row = row;
+    opt.num_threads = num_threads;
+    auto combined = tatami_mtx::load_matrices<double, int>(manifest.paths, opt);
+
+    EXPECT_EQ(combined->nrow(), NR);
+    EXPECT_EQ(combined->ncol(), NC);
+    EXPECT_TRUE(combined->is_sparse());
+    EXPECT_EQ(combined->prefer_rows(), row);
+    tatami_test::test_simple_row_access(*combined, *ref);
+    tatami_test::test_simple_column_access(*combined, *ref);
+
+    // Different storage types.
+    auto combined2 = tatami_mtx::load_matrices<double, int, int, unsigned short>(manifest.paths, opt);
+    tatami_test::test_simple_row_access(*combined2, *ref);
+    tatami_test::test_simple_column_access(*combined2, *ref);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LoadMatrices,
+    LoadMatricesTest,
+    ::testing::Combine(
+        ::testing::Values(true, false), // combine by row
+        ::testing::Values(1, 3, 10), // number of files
+        ::testing::Values(false, true), // gzip
+        ::testing::Values(1, 3) // number of threads
+    )
+);
+
+TEST(LoadMatrices, Errors) {
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrices<double, int>({}, {});
+    }, "at least one");
+
+    auto prefix = temp_file_path("tatami_mtx-test-load_matrices");
+    std::vector<std::string> paths { prefix + ".0.mtx", prefix + ".1.mtx" };
+    tatami::DenseMatrix<double, int, std::vector<double> > first(5, 2, std::vector<double>(10, 1), true);
+    tatami_mtx::write_matrix_to_text_file(first, paths[0].c_str(), {});
+    tatami::DenseMatrix<double, int, std::vector<double> > second(4, 2, std::vector<double>(8, 1), true);
+    tatami_mtx::write_matrix_to_text_file(second, paths[1].c_str(), {});
+
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrices<double, int>(paths, {});
+    }, "same number of rows");
+
+    tatami_mtx::LoadMatricesOptions opt;
+    opt.row = true;
+    auto combined = tatami_mtx::load_matrices<double, int>(paths, opt);
+    EXPECT_EQ(combined->nrow(), 9);
+    EXPECT_EQ(combined->ncol(), 2);
+}
+
+TEST(LoadMatrices, ExplicitZeros) {
+    auto prefix = temp_file_path("tatami_mtx-test-load_matrices");
+    std::vector<std::string> paths { prefix + ".zero.mtx", prefix + ".second.mtx" };
+    {
+        std::ofstream output(paths[0]);
+        output << "%%MatrixMarket matrix coordinate integer general\n3 2 3\n1 1 5\n2 1 0\n3 2 7\n";
+    }
+    {
+        std::ofstream output(paths[1]);
+        output << "%%MatrixMarket matrix coordinate integer general\n3 1 2\n2 1 4\n3 1 6\n";
+    }
+
+    // Explicit zeros are preserved as structural elements.
+    auto combined = tatami_mtx::load_matrices<double, int>(paths, {});
+    EXPECT_EQ(combined->ncol(), 3);
+    auto ext = combined->sparse(false, tatami::Options());
+    std::vector<double> vbuffer(3);
+    std::vector<int> ibuffer(3);
+    std::vector<std::vector<int> > expected_indices { { 0, 1 }, { 2 }, { 1, 2 } };
+    std::vector<std::vector<double> > expected_values { { 5, 0 }, { 7 }, { 4, 6 } };
+    for (int c = 0; c < 3; ++c) {
+        auto range = ext->fetch(c, vbuffer.data(), ibuffer.data());
+        EXPECT_EQ(std::vector<int>(range.index, range.index + range.number), expected_indices[c]);
+        EXPECT_EQ(std::vector<double>(range.value, range.value + range.number), expected_values[c]);
+    }
+
+    // Tiling is ignored for the individual files.
+    tatami_mtx::LoadMatricesOptions topt;
+    topt.load.tiled = true;
+    topt.load.tile_nrow = 1;
+    auto tiled = tatami_mtx::load_matrices<double, int>(paths, topt);
+    tatami_test::test_simple_column_access(*tiled, *combined);
+}
+
+TEST(LoadMatrices, NarrowingValues) {
+    auto prefix = temp_file_path("tatami_mtx-test-load_matrices");
+    std::vector<std::string> paths { prefix + ".narrow.mtx", prefix + ".other.mtx" };
+    {
+        std::ofstream output(paths[0]);
+        output << "%%MatrixMarket matrix coordinate real general\n3 2 4\n1 1 0.4\n2 1 2.5\n3 1 3\n2 2 5\n";
+    }
+    {
+        std::ofstream output(paths[1]);
+        output << "%%MatrixMarket matrix coordinate real general\n3 1 2\n1 1 0.2\n3 1 7\n";
+    }
+
+    // Values that become zero after conversion to Value_ are still counted and copied in the same way.
+    auto combined = tatami_mtx::load_matrices<int, int, double>(paths, {});
+    EXPECT_EQ(combined->nrow(), 3);
+    EXPECT_EQ(combined->ncol(), 3);
+
+    auto ext = combined->sparse(false, tatami::Options());
+    std::vector<int> vbuffer(3), ibuffer(3);
+    std::vector<std::vector<int> > expected_indices { { 0, 1, 2 }, { 1 }, { 0, 2 } };
+    std::vector<std::vector<int> > expected_values { { 0, 2, 3 }, { 5 }, { 0, 7 } };
+    for (int c = 0; c < 3; ++c) {
+        auto range = ext->fetch(c, vbuffer.data(), ibuffer.data());
+        EXPECT_EQ(std::vector<int>(range.index, range.index + range.number), expected_indices[c]);
+        EXPECT_EQ(std::vector<int>(range.value, range.value + range.number), expected_values[c]);
+    }
+
+    std::vector<int> dense { 0, 0, 0, 2, 5, 0, 3, 0, 7 };
+    tatami::DenseMatrix<int, int, std::vector<int> > ref(3, 3, std::move(dense), true);
+    tatami_test::test_simple_row_access(*combined, ref);
+}
@@ -13,6 +13,10 @@
 #include <vector>
 #include <random>
 #include <type_traits>
+#include <numeric>
+#include <algorithm>
+#include <memory>
+#include <sstream>
 
 template<class T>
 class LoadMatrixTestMethods {
@@ -514,3 +518,356 @@ TEST_F(LoadMatrixFloatTypeTest, ArrayCustom) {
     tatami_test::test_simple_row_access(*out, *ref);
     tatami_test::test_simple_column_access(*out, *ref);
 }
+
+/***********************************
+ *** Checking symmetric matrices ***
+ ***********************************/
+
+TEST(LoadMatrixSymmetric, Basic) {
+    std::string contents = "%%MatrixMarket matrix coordinate integer symmetric\n3 3 4\n1 1 5\n2 1 2\n3 1 -3\n3 3 1\n";
+    std::vector<double> expected { 5, 2, -3, 2, 0, 0, -3, 0, 1 };
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(3, 3, expected, true);
+
+    for (int row = 0; row < 2; ++row) {
+        tatami_mtx::Options opt;
+        opt.row = row;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+        EXPECT_TRUE(out->sparse());
+        tatami_test::test_simple_row_access(*out, ref);
+        tatami_test::test_simple_column_access(*out, ref);
+    }
+}
+
+TEST(LoadMatrixSymmetric, Skew) {
+    std::string contents = "%%MatrixMarket matrix coordinate real skew-symmetric\n3 3 2\n2 1 2.5\n3 2 -1\n";
+    std::vector<double> expected { 0, -2.5, 0, 2.5, 0, 1, 0, -1, 0 };
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(3, 3, expected, true);
+
+    auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), {});
+    tatami_test::test_simple_row_access(*out, ref);
+    tatami_test::test_simple_column_access(*out, ref);
+}
+
+TEST(LoadMatrixPattern, Basic) {
+    std::string contents = "%%MatrixMarket matrix coordinate pattern general\n3 4 4\n1 1\n2 3\n3 1\n3 4\n";
+    std::vector<double> expected { 1, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 1 };
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(3, 4, expected, true);
+
+    for (int row = 0; row < 2; ++row) {
+        tatami_mtx::Options opt;
+        opt.row = row;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+        EXPECT_TRUE(out->sparse());
+        tatami_test::test_simple_row_access(*out, ref);
+        tatami_test::test_simple_column_access(*out, ref);
+    }
+}
+
+inline std::size_t counting_allocated = 0;
+
+template<typename Type_>
+struct CountingAllocator {
+    typedef Type_ value_type;
+    CountingAllocator() = default;
+    template<typename Other_>
+    CountingAllocator(const CountingAllocator<Other_>&) {}
+
+    Type_* allocate(std::size_t n) {
+        counting_allocated += n * sizeof(Type_);
+        return std::allocator<Type_>().allocate(n);
+    }
+
+    void deallocate(Type_* ptr, std::size_t n) {
+        std::allocator<Type_>().deallocate(ptr, n);
+    }
+
+    template<typename Other_>
+    bool operator==(const CountingAllocator<Other_>&) const { return true; }
+    template<typename Other_>
+    bool operator!=(const CountingAllocator<Other_>&) const { return false; }
+};
+
+TEST(LoadMatrixAllocator, Basic) {
+    std::string coordinate = "%%MatrixMarket matrix coordinate real general\n3 4 4\n1 1 1.5\n2 3 -2\n3 1 3\n3 4 4.5\n";
+    std::vector<double> expected { 1.5, 0, 0, 0, 0, 0, -2, 0, 3, 0, 0, 4.5 };
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(3, 4, expected, true);
+
+    for (int row = 0; row < 2; ++row) {
+        for (int delta = 0; delta < 2; ++delta) {
+            tatami_mtx::LoadMatrixOptions opt;
+            opt.row = row;
+            opt.delta_varint_indices = delta;
+            counting_allocated = 0;
+            auto out = tatami_mtx::load_matrix_from_text_buffer<double, int, double, int, CountingAllocator>(reinterpret_cast<const unsigned char*>(coordinate.data()), coordinate.size(), opt);
+            EXPECT_GE(counting_allocated, 4 * (sizeof(double) + sizeof(int)));
+            EXPECT_TRUE(out->sparse());
+            tatami_test::test_simple_row_access(*out, ref);
+            tatami_test::test_simple_column_access(*out, ref);
+        }
+    }
+
+    std::string array = "%%MatrixMarket matrix array real general\n3 4\n1.5\n0\n3\n0\n0\n0\n0\n-2\n0\n0\n0\n4.5\n";
+    for (int row = 0; row < 2; ++row) {
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.row = row;
+        counting_allocated = 0;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int, tatami_mtx::Automatic, tatami_mtx::Automatic, CountingAllocator>(reinterpret_cast<const unsigned char*>(array.data()), array.size(), opt);
+        EXPECT_EQ(counting_allocated, 12 * sizeof(double));
+        EXPECT_FALSE(out->sparse());
+        tatami_test::test_simple_row_access(*out, ref);
+    }
+}
+
+TEST(LoadMatrixFirstTouch, Basic) {
+    const int NR = 37, NC = 23;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(NR, NC, std::move(vec), true);
+
+    for (int coordinate = 0; coordinate < 2; ++coordinate) {
+        tatami_mtx::WriteMatrixOptions wopt;
+        wopt.coordinate = coordinate;
+        byteme::RawBufferWriter writer({});
+        tatami_mtx::write_matrix(ref, writer, wopt);
+        writer.finish();
+        const auto& contents = writer.get_output();
+
+        for (int row = 0; row < 2; ++row) {
+            for (int nthreads = 2; nthreads <= 5; nthreads += 3) {
+                tatami_mtx::LoadMatrixOptions opt;
+                opt.row = row;
+                opt.first_touch_threads = nthreads;
+                auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(contents.data(), contents.size(), opt);
+                EXPECT_EQ(out->sparse(), coordinate);
+                EXPECT_EQ(out->prefer_rows(), row);
+                tatami_test::test_simple_row_access(*out, ref);
+                tatami_test::test_simple_column_access(*out, ref);
+
+                if (coordinate) {
+                    opt.delta_varint_indices = true;
+                    out = tatami_mtx::load_matrix_from_text_buffer<double, int>(contents.data(), contents.size(), opt);
+                    tatami_test::test_simple_row_access(*out, ref);
+                }
+            }
+        }
+    }
+
+    // Handles empty matrices.
+    std::string empty = "%%MatrixMarket matrix coordinate real general\n0 5 0\n";
+    tatami_mtx::LoadMatrixOptions opt;
+    opt.first_touch_threads = 3;
+    auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(empty.data()), empty.size(), opt);
+    EXPECT_EQ(out->nrow(), 0);
+    EXPECT_EQ(out->ncol(), 5);
+    auto ext = out->sparse_column();
+    std::vector<double> vbuffer(1);
+    std::vector<int> ibuffer(1);
+    EXPECT_EQ(ext->fetch(0, vbuffer.data(), ibuffer.data()).number, 0);
+}
+
+TEST(LoadMatrixSummaries, Basic) {
+    const int NR = 29, NC = 17;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.3;
+        return opt;
+    }());
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(NR, NC, vec, true);
+
+    std::vector<double> row_sums(NR), column_sums(NC);
+    std::vector<std::size_t> row_detected(NR), column_detected(NC);
+    for (int r = 0; r < NR; ++r) {
+        for (int c = 0; c < NC; ++c) {
+            const auto v = vec[r * NC + c];
+            row_sums[r] += v;
+            column_sums[c] += v;
+            row_detected[r] += (v != 0);
+            column_detected[c] += (v != 0);
+        }
+    }
+
+    for (int coordinate = 0; coordinate < 2; ++coordinate) {
+        tatami_mtx::WriteMatrixOptions wopt;
+        wopt.coordinate = coordinate;
+        byteme::RawBufferWriter writer({});
+        tatami_mtx::write_matrix(ref, writer, wopt);
+        writer.finish();
+        const auto& contents = writer.get_output();
+
+        for (int row = 0; row < 2; ++row) {
+            tatami_mtx::LoadSummaries summaries;
+            summaries.row_sums.resize(100, 1); // replaced by the load.
+            tatami_mtx::LoadMatrixOptions opt;
+            opt.row = row;
+            opt.summaries = &summaries;
+            tatami_mtx::load_matrix_from_text_buffer<double, int>(contents.data(), contents.size(), opt);
+
+            ASSERT_EQ(summaries.row_sums.size(), NR);
+            for (int r = 0; r < NR; ++r) {
+                EXPECT_FLOAT_EQ(summaries.row_sums[r], row_sums[r]);
+            }
+            ASSERT_EQ(summaries.column_sums.size(), NC);
+            for (int c = 0; c < NC; ++c) {
+                EXPECT_FLOAT_EQ(summaries.column_sums[c], column_sums[c]);
+            }
+            EXPECT_EQ(summaries.row_detected, row_detected);
+            EXPECT_EQ(summaries.column_detected, column_detected);
+        }
+    }
+}
+
+TEST(LoadMatrixSummaries, Symmetric) {
+    std::string contents = "%%MatrixMarket matrix coordinate integer skew-symmetric\n3 3 3\n2 1 5\n3 1 -3\n3 2 0\n";
+    tatami_mtx::LoadSummaries summaries;
+    tatami_mtx::LoadMatrixOptions opt;
+    opt.summaries = &summaries;
+    tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+
+    // Full matrix is [[0, -5, 3], [5, 0, 0], [-3, 0, 0]], with an explicit zero at (3, 2) and (2, 3).
+    EXPECT_EQ(summaries.row_sums, std::vector<double>({ -2, 5, -3 }));
+    EXPECT_EQ(summaries.column_sums, std::vector<double>({ 2, -5, 3 }));
+    EXPECT_EQ(summaries.row_detected, std::vector<std::size_t>({ 2, 1, 1 }));
+    EXPECT_EQ(summaries.column_detected, std::vector<std::size_t>({ 2, 1, 1 }));
+}
+
+TEST(LoadMatrixReorder, Basic) {
+    const int NR = 31, NC = 19;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.25;
+        return opt;
+    }());
+    auto ref = std::make_shared<tatami::DenseMatrix<double, int, std::vector<double> > >(NR, NC, vec, true);
+
+    tatami_mtx::WriteMatrixOptions wopt;
+    wopt.coordinate = true;
+    wopt.skip_zeros = true; // so that the number of structural non-zeros is equal to the number of detected values.
+    byteme::RawBufferWriter writer({});
+    tatami_mtx::write_matrix(*ref, writer, wopt);
+    writer.finish();
+    const auto& contents = writer.get_output();
+
+    std::vector<std::size_t> custom_columns(NC);
+    std::iota(custom_columns.begin(), custom_columns.end(), 0);
+    std::mt19937_64 rng(42);
+    std::shuffle(custom_columns.begin(), custom_columns.end(), rng);
+
+    for (int row = 0; row < 2; ++row) {
+        tatami_mtx::LoadOrdering ordering;
+        tatami_mtx::LoadSummaries summaries;
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.row = row;
+        opt.reorder_rows = tatami_mtx::ReorderMode::NNZ;
+        opt.reorder_columns = tatami_mtx::ReorderMode::CUSTOM;
+        opt.custom_column_order = custom_columns;
+        opt.ordering = &ordering;
+        opt.summaries = &summaries;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(contents.data(), contents.size(), opt);
+
+        EXPECT_EQ(ordering.columns, custom_columns);
+        ASSERT_EQ(ordering.rows.size(), NR);
+        for (int r = 1; r < NR; ++r) {
+            EXPECT_GE(summaries.row_detected[r - 1], summaries.row_detected[r]);
+        }
+
+        std::vector<int> row_subset(ordering.rows.begin(), ordering.rows.end()), column_subset(custom_columns.begin(), custom_columns.end());
+        auto expected = tatami::make_DelayedSubset<double, int>(tatami::make_DelayedSubset<double, int>(ref, row_subset, true), column_subset, false);
+        tatami_test::test_simple_row_access(*out, *expected);
+        tatami_test::test_simple_column_access(*out, *expected);
+
+        auto ext = expected->dense_row();
+        std::vector<double> buffer(NC);
+        for (int r = 0; r < NR; ++r) {
+            auto ptr = ext->fetch(r, buffer.data());
+            double sum = std::accumulate(ptr, ptr + NC, 0.0);
+            EXPECT_FLOAT_EQ(summaries.row_sums[r], sum);
+        }
+    }
+
+    // Identity ordering is reported without reordering.
+    tatami_mtx::LoadOrdering ordering;
+    tatami_mtx::LoadMatrixOptions opt;
+    opt.ordering = &ordering;
+    tatami_mtx::load_matrix_from_text_buffer<double, int>(contents.data(), contents.size(), opt);
+    EXPECT_EQ(ordering.rows.size(), NR);
+    EXPECT_EQ(ordering.rows.back(), NR - 1);
+    EXPECT_EQ(ordering.columns.size(), NC);
+}
+
+TEST(LoadMatrixReorder, Errors) {
+    std::string coordinate = "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 5\n";
+    auto cptr = reinterpret_cast<const unsigned char*>(coordinate.data());
+    tatami_mtx::LoadMatrixOptions opt;
+    opt.reorder_rows = tatami_mtx::ReorderMode::CUSTOM;
+    opt.custom_row_order = std::vector<std::size_t>{ 0 };
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_from_text_buffer<double, int>(cptr, coordinate.size(), opt);
+    }, "length");
+
+    opt.custom_row_order = std::vector<std::size_t>{ 1, 1 };
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_from_text_buffer<double, int>(cptr, coordinate.size(), opt);
+    }, "permutation");
+
+    std::string array = "%%MatrixMarket matrix array real general\n2 1\n1\n2\n";
+    opt.reorder_rows = tatami_mtx::ReorderMode::NNZ;
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(array.data()), array.size(), opt);
+    }, "coordinate");
+}
+
+TEST(LoadMatrixParallelCompress, Shuffled) {
+    const int NR = 57, NC = 41;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(NR, NC, vec, true);
+
+    // Writing the triplets in a random order so that the sort is non-trivial.
+    std::vector<std::string> lines;
+    for (int r = 0; r < NR; ++r) {
+        for (int c = 0; c < NC; ++c) {
+            const auto v = vec[r * NC + c];
+            if (v != 0) {
+                std::ostringstream line;
+                line.precision(17);
+                line << r + 1 << " " << c + 1 << " " << v << "\n";
+                lines.push_back(line.str());
+            }
+        }
+    }
+    std::mt19937_64 rng(1234);
+    std::shuffle(lines.begin(), lines.end(), rng);
+
+    std::string contents = "%%MatrixMarket matrix coordinate real general\n" + std::to_string(NR) + " " + std::to_string(NC) + " " + std::to_string(lines.size()) + "\n";
+    for (const auto& l : lines) {
+        contents += l;
+    }
+    auto cptr = reinterpret_cast<const unsigned char*>(contents.data());
+
+    for (int row = 0; row < 2; ++row) {
+        for (int nthreads : { 2, 3, 8, 100 }) {
+            tatami_mtx::LoadMatrixOptions opt;
+            opt.row = row;
+            opt.compress_threads = nthreads;
+            auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(cptr, contents.size(), opt);
+            EXPECT_TRUE(out->sparse());
+            EXPECT_EQ(out->prefer_rows(), row);
+            tatami_test::test_simple_row_access(*out, ref);
+            tatami_test::test_simple_column_access(*out, ref);
+        }
+    }
+
+    // Works with empty matrices.
+    std::string empty = "%%MatrixMarket matrix coordinate real general\n4 3 0\n";
+    tatami_mtx::LoadMatrixOptions opt;
+    opt.compress_threads = 4;
+    auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(empty.data()), empty.size(), opt);
+    EXPECT_EQ(out->nrow(), 4);
+    EXPECT_EQ(out->ncol(), 3);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/load_matrix_async.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <filesystem>
+
+class LoadMatrixAsyncTest : public ::testing::Test {
+protected:
+    inline static const int NR = 40, NC = 30;
+    inline static std::shared_ptr<tatami::Matrix<double, int> > ref;
+    inline static std::string path;
+
+    static void SetUpTestSuite() {
+        auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.2;
+            return opt;
+        }());
+        ref.reset(new tatami::DenseMatrix<double, int, std::vector<double> >(NR, NC, std::move(vec), true));
+
+        path = temp_file_path("tatami_mtx-test-load_matrix_async");
+        tatami_mtx::WriteMatrixOptions wopt;
+        wopt.coordinate = true;
+        tatami_mtx::write_matrix_to_text_file(*ref, path.c_str(), wopt);
+    }
+};
+
+TEST_F(LoadMatrixAsyncTest, Default) {
+    auto loading = tatami_mtx::load_matrix_from_some_file_async<double, int>(path.c_str(), {});
+    auto mat = loading.result.get();
+    tatami_test::test_simple_row_access(*mat, *ref);
+
+    const unsigned long long file_size = std::filesystem::file_size(path);
+    EXPECT_EQ(loading.control->total_bytes(), file_size);
+    EXPECT_EQ(loading.control->bytes_read(), file_size);
+    EXPECT_FALSE(loading.control->is_cancelled());
+}
+
+TEST_F(LoadMatrixAsyncTest, Executor) {
+    std::vector<std::function<void()> > queue;
+    tatami_mtx::LoadMatrixAsyncOptions opt;
+    opt.executor = [&](std::function<void()> task) -> void {
+        queue.push_back(std::move(task));
+    };
+    opt.load.row = false;
+    opt.load.buffer_size = 100;
+
+    auto loading = tatami_mtx::load_matrix_from_some_file_async<double, int>(path.c_str(), opt);
+    ASSERT_EQ(queue.size(), 1);
+    EXPECT_EQ(loading.control->bytes_read(), 0);
+
+    queue.front()();
+    auto mat = loading.result.get();
+    EXPECT_FALSE(mat->prefer_rows());
+    tatami_test::test_simple_column_access(*mat, *ref);
+    EXPECT_EQ(loading.control->bytes_read(), loading.control->total_bytes());
+}
+
+TEST_F(LoadMatrixAsyncTest, Cancelled) {
+    std::vector<std::function<void()> > queue;
+    tatami_mtx::LoadMatrixAsyncOptions opt;
+    opt.executor = [&](std::function<void()> task) -> void {
+        queue.push_back(std::move(task));
+    };
+
+    // Cancelling before the load starts.
+    {
+        auto loading = tatami_mtx::load_matrix_from_some_file_async<double, int>(path.c_str(), opt);
+        loading.control->cancel();
+        queue.back()();
+        EXPECT_THROW(loading.result.get(), tatami_mtx::LoadCancelled);
+        EXPECT_EQ(loading.control->bytes_read(), 0);
+    }
+
+    // Cancelling after the load has started, which is detected at the next buffer refill.
+    {
+        std::shared_ptr<tatami_mtx::LoadControl> control;
+        opt.load.buffer_size = 50;
+        auto loading = tatami_mtx::load_matrix_async<double, int>([&]() -> std::unique_ptr<byteme::Reader> {
+            control->cancel();
+            return std::unique_ptr<byteme::Reader>(new byteme::RawFileReader(path.c_str(), {}));
+        }, 0, opt);
+        control = loading.control;
+        queue.back()();
+        EXPECT_THROW(loading.result.get(), tatami_mtx::LoadCancelled);
+        EXPECT_EQ(loading.control->total_bytes(), 0);
+    }
+}
+
+TEST_F(LoadMatrixAsyncTest, Errors) {
+    auto loading = tatami_mtx::load_matrix_async<double, int>([&]() -> std::unique_ptr<byteme::Reader> {
+        throw std::runtime_error("oops");
+    }, 0, {});
+    tatami_test::throws_error([&]() {
+        loading.result.get();
+    }, "oops");
+}
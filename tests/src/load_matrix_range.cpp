@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/load_matrix_range.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+class LoadMatrixRangeTest : public ::testing::TestWithParam<std::tuple<int, bool, int> > {
+protected:
+    static std::shared_ptr<tatami::Matrix<double, int> > simulate(int NR, int NC) {
+        auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.15;
+            opt.lower = 1;
+            opt.upper = 100;
+            return opt;
+        }());
+        for (auto& v : vec) {
+            v = std::round(v);
+        }
+        return std::make_shared<tatami::DenseMatrix<double, int, std::vector<double> > >(NR, NC, std::move(vec), true);
+    }
+};
+
+TEST_P(LoadMatrixRangeTest, ByteRange) {
+    const auto& params = GetParam();
+    const int num_ranges = std::get<0>(params);
+    const bool row = std::get<1>(params);
+    const int num_threads = std::get<2>(params);
+
+    const int NR = 53, NC = 47;
+    auto ref = simulate(NR, NC);
+
+    // Writing by row so that each range spans multiple columns, to check that the merge sorts the indices.
+    auto path = temp_file_path("tatami_mtx-test-load_matrix_range");
+    tatami_mtx::WriteMatrixOptions wopt;
+    wopt.coordinate = true;
+    wopt.by_row = true;
+    tatami_mtx::write_matrix_to_text_file(*ref, path.c_str(), wopt);
+    const unsigned long long file_size = std::filesystem::file_size(path);
+
+    tatami_mtx::LoadMatrixOptions lopt;
+    lopt.row = row;
+    std::vector<std::shared_ptr<const tatami::Matrix<double, int> > > byte_partials, line_partials;
+    const unsigned long long num_lines = 53 * 47; // upper bound on the number of lines.
+    for (int r = 0; r < num_ranges; ++r) {
+        const unsigned long long start = file_size * r / num_ranges, end = file_size * (r + 1) / num_ranges;
+        auto part = tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), start, end, lopt);
+        EXPECT_EQ(part->nrow(), NR);
+        EXPECT_EQ(part->ncol(), NC);
+        byte_partials.push_back(std::move(part));
+
+        const unsigned long long first = num_lines * r / num_ranges, last = num_lines * (r + 1) / num_ranges;
+        line_partials.push_back(tatami_mtx::load_matrix_line_range<double, int>(path.c_str(), first, last, lopt));
+    }
+
+    tatami_mtx::MergePartialMatricesOptions mopt;
+    mopt.row = row;
+    mopt.num_threads = num_threads;
+    for (const auto& partials : { byte_partials, line_partials }) {
+        auto merged = tatami_mtx::merge_partial_matrices(partials, mopt);
+        EXPECT_EQ(merged->prefer_rows(), row);
+        tatami_test::test_simple_row_access(*merged, *ref);
+        tatami_test::test_simple_column_access(*merged, *ref);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LoadMatrixRange,
+    LoadMatrixRangeTest,
+    ::testing::Combine(
+        ::testing::Values(1, 3, 10, 500), // number of ranges
+        ::testing::Values(true, false), // row
+        ::testing::Values(1, 3) // number of threads
+    )
+);
+
+TEST(LoadMatrixRange, Alignment) {
+    auto path = temp_file_path("tatami_mtx-test-load_matrix_range");
+    {
+        std::ofstream output(path);
+        output << "%%MatrixMarket matrix coordinate integer general\n% comment\n5 4 3\n1 1 10\n2 2 20\n5 4 30\n";
+    }
+
+    // Starting in the middle of the preamble.
+    auto part = tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 10, 70, {});
+    auto ext = part->dense(true, tatami::Options());
+    std::vector<double> buffer(4);
+    EXPECT_EQ(ext->fetch(0, buffer.data())[0], 10);
+    EXPECT_EQ(ext->fetch(1, buffer.data())[1], 0); // starts at offset 72, so it is excluded.
+
+    // Starting exactly at a line boundary.
+    part = tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 72, 1000, {});
+    ext = part->dense(true, tatami::Options());
+    EXPECT_EQ(ext->fetch(0, buffer.data())[0], 0);
+    EXPECT_EQ(ext->fetch(1, buffer.data())[1], 20);
+    EXPECT_EQ(ext->fetch(4, buffer.data())[3], 30);
+
+    // Empty ranges.
+    part = tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 73, 79, {});
+    EXPECT_EQ(part->nrow(), 5);
+    EXPECT_EQ(part->ncol(), 4);
+    EXPECT_EQ(part->dense(true, tatami::Options())->fetch(1, buffer.data())[1], 0);
+    part = tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 1000, 2000, {});
+    EXPECT_EQ(part->nrow(), 5);
+}
+
+TEST(LoadMatrixRange, NoTrailingNewline) {
+    auto path = temp_file_path("tatami_mtx-test-load_matrix_range");
+    {
+        std::ofstream output(path);
+        output << "%%MatrixMarket matrix coordinate integer general\n3 3 3\n1 1 10\n\n2 2 20\n3 3 30";
+    }
+
+    // Empty lines are skipped when counting the lines in each window.
+    auto part = tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 0, 65, {});
+    auto ext = part->dense(true, tatami::Options());
+    std::vector<double> buffer(3);
+    EXPECT_EQ(ext->fetch(0, buffer.data())[0], 10);
+    EXPECT_EQ(ext->fetch(1, buffer.data())[1], 20);
+    EXPECT_EQ(ext->fetch(2, buffer.data())[2], 0);
+
+    part = tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 65, 1000, {});
+    ext = part->dense(true, tatami::Options());
+    EXPECT_EQ(ext->fetch(1, buffer.data())[1], 0);
+    EXPECT_EQ(ext->fetch(2, buffer.data())[2], 30);
+
+    part = tatami_mtx::load_matrix_line_range<double, int>(path.c_str(), 2, 10, {});
+    ext = part->dense(true, tatami::Options());
+    EXPECT_EQ(ext->fetch(0, buffer.data())[0], 0);
+    EXPECT_EQ(ext->fetch(1, buffer.data())[1], 20);
+    EXPECT_EQ(ext->fetch(2, buffer.data())[2], 30);
+}
+
+TEST(LoadMatrixRange, Errors) {
+    auto path = temp_file_path("tatami_mtx-test-load_matrix_range");
+    {
+        std::ofstream output(path);
+        output << "%%MatrixMarket matrix array real general\n2 1\n1\n2\n";
+    }
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 0, 100, {});
+    }, "coordinate");
+
+    {
+        std::ofstream output(path);
+        output << "%%MatrixMarket matrix coordinate integer general\n2 2 1\n1 1 5\n";
+    }
+    tatami_mtx::LoadMatrixOptions lopt;
+    lopt.reorder_rows = tatami_mtx::ReorderMode::NNZ;
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_byte_range<double, int>(path.c_str(), 0, 100, lopt);
+    }, "reordering");
+
+    lopt.reorder_rows = tatami_mtx::ReorderMode::NONE;
+    tatami_mtx::LoadSummaries summaries;
+    lopt.summaries = &summaries;
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_line_range<double, int>(path.c_str(), 0, 100, lopt);
+    }, "summaries");
+
+    std::vector<std::shared_ptr<const tatami::Matrix<double, int> > > partials;
+    tatami_test::throws_error([&]() {
+        tatami_mtx::merge_partial_matrices(partials, {});
+    }, "at least one");
+
+    partials.emplace_back(new tatami::DenseMatrix<double, int, std::vector<double> >(2, 3, std::vector<double>(6), true));
+    partials.emplace_back(new tatami::DenseMatrix<double, int, std::vector<double> >(3, 2, std::vector<double>(6), true));
+    tatami_test::throws_error([&]() {
+        tatami_mtx::merge_partial_matrices(partials, {});
+    }, "same dimensions");
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include "byteme/byteme.hpp"
+#include "zlib.h"
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/load_matrix.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+#include "tatami_mtx/parallel_zlib_writer.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <random>
+
+class ParallelZlibWriterTest : public ::testing::TestWithParam<std::tuple<int, int, std::size_t> > {
+protected:
+    static std::vector<unsigned char> simulate_text(std::size_t n) {
+        std::mt19937_64 rng(n);
+        std::vector<unsigned char> output;
+        output.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            output.push_back('0' + (rng() % 10));
+            if (i % 17 == 0) {
+                output.push_back('\n');
+            }
+        }
+        return output;
+    }
+
+    static std::vector<unsigned char> decompress(const std::vector<unsigned char>& buffer) {
+        z_stream strm;
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        strm.next_in = const_cast<unsigned char*>(buffer.data());
+        strm.avail_in = buffer.size();
+        inflateInit2(&strm, 15 + 32); // automatic Gzip/Zlib detection.
+
+        std::vector<unsigned char> output;
+        std::vector<unsigned char> chunk(1000);
+        int ret;
+        do {
+            strm.next_out = chunk.data();
+            strm.avail_out = chunk.size();
+            ret = inflate(&strm, Z_NO_FLUSH);
+            output.insert(output.end(), chunk.data(), chunk.data() + chunk.size() - strm.avail_out);
+        } while (ret == Z_OK);
+
+        inflateEnd(&strm);
+        EXPECT_EQ(ret, Z_STREAM_END); // checksums are verified by inflate().
+        EXPECT_EQ(strm.avail_in, 0);
+        return output;
+    }
+};
+
+TEST_P(ParallelZlibWriterTest, Basic) {
+    auto param = GetParam();
+    const auto mode = std::get<0>(param);
+    const auto nthreads = std::get<1>(param);
+    const auto total = std::get<2>(param);
+    auto contents = simulate_text(total);
+
+    byteme::RawBufferWriter raw({});
+    tatami_mtx::ParallelZlibWriter writer(&raw, [&]{
+        tatami_mtx::ParallelZlibWriterOptions opt;
+        opt.mode = (mode == 0 ? byteme::ZlibCompressionMode::GZIP : byteme::ZlibCompressionMode::ZLIB);
+        opt.block_size = 1000;
+        opt.num_threads = nthreads;
+        return opt;
+    }());
+
+    // Writing in uneven pieces to check that blocks are correctly filled.
+    std::size_t position = 0, step = 1;
+    while (position < contents.size()) {
+        const auto n = std::min(step, contents.size() - position);
+        writer.write(contents.data() + position, n);
+        position += n;
+        step = step * 3 + 1;
+    }
+    writer.finish();
+
+    const auto& output = raw.get_output();
+    EXPECT_TRUE(byteme::is_zlib_or_gzip(output.data(), output.size()));
+    EXPECT_EQ(decompress(output), contents);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParallelZlibWriter,
+    ParallelZlibWriterTest,
+    ::testing::Combine(
+        ::testing::Values(0, 1), // Gzip or Zlib.
+        ::testing::Values(1, 3), // number of threads.
+        ::testing::Values(0, 999, 1000, 12345) // number of bytes.
+    )
+);
+
+TEST(ParallelZlibWriter, WriteMatrix) {
+    const int NR = 400, NC = 250;
+    auto sim = tatami_test::simulate_compressed_sparse<double>(NC, NR, {});
+    tatami::CompressedSparseMatrix<
+        double,
+        int,
+        std::vector<double>,
+        std::vector<int>,
+        std::vector<std::size_t>
+    > mat(NR, NC, std::move(sim.data), std::move(sim.index), std::move(sim.indptr), false);
+
+    tatami_mtx::WriteMatrixOptions opt;
+    opt.compression_threads = 4;
+
+    auto path = temp_file_path("tatami_mtx-test-parallel_zlib_writer");
+    tatami_mtx::write_matrix_to_gzip_file(mat, path.c_str(), opt);
+    auto reloaded = tatami_mtx::load_matrix_from_gzip_file<double, int>(path.c_str(), {});
+    tatami_test::test_simple_column_access(*reloaded, mat);
+
+    auto buffer = tatami_mtx::write_matrix_to_zlib_buffer(mat, byteme::ZlibCompressionMode::ZLIB, opt);
+    auto reloaded2 = tatami_mtx::load_matrix_from_zlib_buffer<double, int>(buffer.data(), buffer.size(), {});
+    tatami_test::test_simple_row_access(*reloaded2, mat);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/load_matrix.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <filesystem>
+
+class StatisticsTest : public ::testing::TestWithParam<int> {
+protected:
+    inline static const int NR = 50, NC = 20;
+    inline static std::shared_ptr<tatami::Matrix<double, int> > ref;
+
+    static void SetUpTestSuite() {
+        auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.2;
+            return opt;
+        }());
+        ref.reset(new tatami::DenseMatrix<double, int, std::vector<double> >(NR, NC, std::move(vec), true));
+    }
+};
+
+TEST_P(StatisticsTest, Coordinate) {
+    const int num_threads = GetParam();
+    auto path = temp_file_path("tatami_mtx-test-statistics");
+
+    tatami_mtx::WriteStatistics wstats;
+    unsigned long long last_written = 0;
+    int num_flushes = 0;
+    wstats.progress = [&](unsigned long long n) -> void {
+        EXPECT_GT(n, last_written);
+        last_written = n;
+        ++num_flushes;
+    };
+
+    tatami_mtx::WriteMatrixOptions wopt;
+    wopt.coordinate = true;
+    wopt.buffer_size = 100;
+    wopt.num_threads = num_threads;
+    wopt.statistics = &wstats;
+    tatami_mtx::write_matrix_to_text_file(*ref, path.c_str(), wopt);
+
+    const unsigned long long file_size = std::filesystem::file_size(path);
+    EXPECT_EQ(wstats.bytes_written, file_size);
+    EXPECT_EQ(last_written, file_size);
+    EXPECT_GT(num_flushes, 1);
+    EXPECT_GE(wstats.total_time, wstats.count_time);
+
+    unsigned long long nnz = 0;
+    {
+        auto ext = ref->dense_row();
+        std::vector<double> buffer(NC);
+        for (int r = 0; r < NR; ++r) {
+            auto ptr = ext->fetch(r, buffer.data());
+            for (int c = 0; c < NC; ++c) {
+                nnz += (ptr[c] != 0);
+            }
+        }
+    }
+    EXPECT_EQ(wstats.lines_written, NR * NC); // dense matrices are written in full unless skip_zeros = true.
+
+    tatami_mtx::LoadStatistics lstats;
+    unsigned long long last_read = 0;
+    lstats.progress = [&](unsigned long long n) -> void {
+        EXPECT_GE(n, last_read);
+        last_read = n;
+    };
+
+    tatami_mtx::LoadMatrixOptions lopt;
+    lopt.buffer_size = 100;
+    lopt.num_threads = num_threads;
+    lopt.statistics = &lstats;
+    auto loaded = tatami_mtx::load_matrix_from_text_file<double, int, double, std::uint8_t>(path.c_str(), lopt);
+    tatami_test::test_simple_row_access(*loaded, *ref);
+
+    EXPECT_EQ(lstats.bytes_read, file_size);
+    EXPECT_EQ(last_read, file_size);
+    EXPECT_EQ(lstats.lines_parsed, NR * NC);
+    EXPECT_GE(lstats.preamble_time, 0);
+    EXPECT_GE(lstats.parse_time, 0);
+    EXPECT_GE(lstats.read_time, 0);
+    EXPECT_GE(lstats.compress_time, 0);
+    EXPECT_GE(lstats.construct_time, 0);
+    EXPECT_EQ(lstats.value_bytes, NR * NC * sizeof(double));
+    EXPECT_EQ(lstats.primary_bytes, NR * NC * sizeof(std::uint8_t));
+    EXPECT_EQ(lstats.secondary_bytes, NR * NC * sizeof(std::uint8_t));
+    EXPECT_GE(lstats.pointer_bytes, (NR + 1) * sizeof(std::size_t));
+
+    // Statistics are reset for each call, but the callback is preserved.
+    wopt.skip_zeros = true;
+    last_written = 0;
+    tatami_mtx::write_matrix_to_text_file(*ref, path.c_str(), wopt);
+    EXPECT_EQ(wstats.lines_written, nnz);
+    EXPECT_EQ(wstats.bytes_written, std::filesystem::file_size(path));
+    EXPECT_TRUE(static_cast<bool>(wstats.progress));
+
+    lopt.delta_varint_indices = true;
+    last_read = 0;
+    loaded = tatami_mtx::load_matrix_from_text_file<double, int>(path.c_str(), lopt);
+    tatami_test::test_simple_row_access(*loaded, *ref);
+    EXPECT_EQ(lstats.lines_parsed, nnz);
+    EXPECT_EQ(lstats.bytes_read, std::filesystem::file_size(path));
+    EXPECT_TRUE(static_cast<bool>(lstats.progress));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Statistics,
+    StatisticsTest,
+    ::testing::Values(1, 3) // number of threads
+);
+
+TEST(Statistics, Array) {
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(7, 3, std::vector<double>(21, 2), false);
+    tatami_mtx::WriteStatistics wstats;
+    tatami_mtx::WriteMatrixOptions wopt;
+    wopt.statistics = &wstats;
+
+    byteme::RawBufferWriter writer({});
+    tatami_mtx::write_matrix(mat, writer, wopt);
+    writer.finish();
+    EXPECT_EQ(wstats.lines_written, 21);
+    EXPECT_EQ(wstats.count_time, 0);
+    EXPECT_EQ(wstats.bytes_written, writer.get_output().size());
+
+    tatami_mtx::LoadStatistics lstats;
+    tatami_mtx::LoadMatrixOptions lopt;
+    lopt.statistics = &lstats;
+    const auto& contents = writer.get_output();
+    auto loaded = tatami_mtx::load_matrix_from_text_buffer<double, int>(contents.data(), contents.size(), lopt);
+    tatami_test::test_simple_row_access(*loaded, mat);
+    EXPECT_EQ(lstats.lines_parsed, 21);
+    EXPECT_EQ(lstats.bytes_read, contents.size());
+    EXPECT_EQ(lstats.value_bytes, 21 * sizeof(double));
+    EXPECT_EQ(lstats.compress_time, 0);
+    EXPECT_EQ(lstats.primary_bytes, 0);
+}
+
+TEST(Statistics, Symmetric) {
+    // Mirrored elements are not counted as extra lines.
+    std::string contents = "%%MatrixMarket matrix coordinate integer symmetric\n4 4 3\n1 1 5\n3 1 2\n4 2 7\n";
+    tatami_mtx::LoadStatistics lstats;
+    tatami_mtx::LoadMatrixOptions lopt;
+    lopt.statistics = &lstats;
+    auto loaded = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), lopt);
+    EXPECT_EQ(loaded->nrow(), 4);
+    EXPECT_EQ(lstats.lines_parsed, 3);
+    EXPECT_EQ(lstats.bytes_read, contents.size());
+}
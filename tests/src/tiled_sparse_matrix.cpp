@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/tiled_sparse_matrix.hpp"
+#include "tatami_mtx/load_matrix.hpp"
+#include "tatami_mtx/write_matrix.hpp"
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <tuple>
+#include <cstdint>
+#include <algorithm>
+
+class TiledSparseMatrixTest : public ::testing::TestWithParam<std::tuple<bool, std::size_t, std::size_t, int> > {
+protected:
+    inline static const int NR = 87, NC = 53;
+    inline static std::shared_ptr<tatami::Matrix<double, int> > ref;
+    inline static std::vector<unsigned char> contents;
+
+    static void SetUpTestSuite() {
+        auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.2;
+            return opt;
+        }());
+        ref.reset(new tatami::DenseMatrix<double, int, std::vector<double> >(NR, NC, std::move(vec), true));
+
+        byteme::RawBufferWriter writer({});
+        tatami_mtx::WriteMatrixOptions wopt;
+        wopt.coordinate = true;
+        wopt.by_row = false; // so that the triplets are not already in row-major order.
+        tatami_mtx::write_matrix(*ref, writer, wopt);
+        writer.finish();
+        contents = writer.get_output();
+    }
+};
+
+TEST_P(TiledSparseMatrixTest, Load) {
+    const auto& params = GetParam();
+    tatami_mtx::LoadMatrixOptions opt;
+    opt.row = std::get<0>(params);
+    opt.tiled = true;
+    opt.tile_nrow = std::get<1>(params);
+    opt.tile_ncol = std::get<2>(params);
+    opt.num_threads = std::get<3>(params);
+
+    auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(contents.data(), contents.size(), opt);
+    auto tiled = dynamic_cast<const tatami_mtx::TiledSparseMatrix<double, int>*>(out.get());
+    ASSERT_TRUE(tiled != NULL);
+    EXPECT_TRUE(tiled->is_sparse());
+    EXPECT_EQ(tiled->prefer_rows(), opt.row);
+
+    // Tiles that are larger than the matrix are truncated.
+    const int tile_nrow = std::min<std::size_t>(opt.tile_nrow, NR), tile_ncol = std::min<std::size_t>(opt.tile_ncol, NC);
+    EXPECT_EQ(tiled->tile_nrow(), tile_nrow);
+    EXPECT_EQ(tiled->tile_ncol(), tile_ncol);
+    EXPECT_EQ(tiled->num_tile_rows(), (NR + tile_nrow - 1) / tile_nrow);
+    EXPECT_EQ(tiled->num_tile_columns(), (NC + tile_ncol - 1) / tile_ncol);
+
+    // Each tile should contain the corresponding submatrix of the reference.
+    for (int r = 0; r < tiled->num_tile_rows(); ++r) {
+        for (int c = 0; c < tiled->num_tile_columns(); ++c) {
+            const auto& current = tiled->tile(r, c);
+            EXPECT_TRUE(current->is_sparse());
+            EXPECT_EQ(current->prefer_rows(), opt.row);
+            auto rsub = tatami::make_DelayedSubsetBlock<double, int>(ref, r * tile_nrow, current->nrow(), true);
+            auto csub = tatami::make_DelayedSubsetBlock<double, int>(std::move(rsub), c * tile_ncol, current->ncol(), false);
+            tatami_test::test_simple_row_access(*current, *csub);
+        }
+    }
+
+    tatami_test::test_simple_row_access(*out, *ref);
+    tatami_test::test_simple_column_access(*out, *ref);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TiledSparseMatrix,
+    TiledSparseMatrixTest,
+    ::testing::Combine(
+        ::testing::Values(true, false), // row or column compression within each tile.
+        ::testing::Values(1, 10, 87, 1000), // tile rows.
+        ::testing::Values(7, 53, 100), // tile columns.
+        ::testing::Values(1, 3) // number of threads.
+    )
+);
+
+TEST(TiledSparseMatrix, Empty) {
+    for (int i = 0; i < 2; ++i) {
+        const int NR = (i ? 10 : 0), NC = (i ? 0 : 10);
+        std::string contents = "%%MatrixMarket matrix coordinate integer general\n" + std::to_string(NR) + " " + std::to_string(NC) + " 0\n";
+
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.tiled = true;
+        opt.tile_nrow = 3;
+        opt.tile_ncol = 4;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+        EXPECT_EQ(out->nrow(), NR);
+        EXPECT_EQ(out->ncol(), NC);
+
+        auto tiled = dynamic_cast<const tatami_mtx::TiledSparseMatrix<double, int>*>(out.get());
+        ASSERT_TRUE(tiled != NULL);
+        EXPECT_EQ(tiled->num_tile_rows(), (i ? 4 : 1));
+        EXPECT_EQ(tiled->num_tile_columns(), (i ? 1 : 3));
+    }
+}
+
+TEST(TiledSparseMatrix, EmptyTiles) {
+    // Only the non-empty tiles have their own pointers.
+    std::string contents = "%%MatrixMarket matrix coordinate integer general\n10 10 4\n1 1 5\n3 7 2\n10 10 9\n3 7 1\n";
+    for (int row = 0; row < 2; ++row) {
+        tatami_mtx::LoadStatistics stats;
+        tatami_mtx::LoadMatrixOptions opt;
+        opt.row = row;
+        opt.tiled = true;
+        opt.tile_nrow = 2;
+        opt.tile_ncol = 3;
+        opt.statistics = &stats;
+        auto out = tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+        EXPECT_EQ(stats.pointer_bytes, (row ? 3 + 3 + 3 : 4 + 4 + 2) * sizeof(std::uint32_t)); // the last band of columns only has one column.
+
+        auto tiled = dynamic_cast<const tatami_mtx::TiledSparseMatrix<double, int>*>(out.get());
+        ASSERT_TRUE(tiled != NULL);
+        EXPECT_EQ(tiled->num_tile_rows(), 5);
+        EXPECT_EQ(tiled->num_tile_columns(), 4);
+        EXPECT_EQ(tiled->tile(0, 1)->nrow(), 2);
+        EXPECT_EQ(tiled->tile(0, 1)->ncol(), 3);
+        EXPECT_EQ(tiled->tile(4, 3)->ncol(), 1);
+
+        // Both copies of the duplicated element are retained in the tile.
+        auto dup = tiled->tile(1, 2)->sparse(row, tatami::Options());
+        std::vector<double> vbuffer(3);
+        std::vector<int> ibuffer(3);
+        auto range = dup->fetch(0, vbuffer.data(), ibuffer.data());
+        ASSERT_EQ(range.number, 2);
+        EXPECT_EQ(range.index[0], 0);
+        EXPECT_EQ(range.index[1], 0);
+        EXPECT_EQ(std::min(range.value[0], range.value[1]), 1);
+        EXPECT_EQ(std::max(range.value[0], range.value[1]), 2);
+
+        auto ext = out->dense_row();
+        std::vector<double> buffer(10);
+        auto ptr = ext->fetch(0, buffer.data());
+        EXPECT_EQ(ptr[0], 5);
+        EXPECT_EQ(std::count(ptr, ptr + 10, 0), 9);
+        ptr = ext->fetch(9, buffer.data());
+        EXPECT_EQ(ptr[9], 9);
+        EXPECT_EQ(std::count(ptr, ptr + 10, 0), 9);
+    }
+}
+
+TEST(TiledSparseMatrix, Errors) {
+    std::vector<std::shared_ptr<const tatami::Matrix<double, int> > > tiles;
+    tiles.emplace_back(new tatami::DenseMatrix<double, int, std::vector<double> >(2, 3, std::vector<double>(6), true));
+    tiles.emplace_back(new tatami::DenseMatrix<double, int, std::vector<double> >(2, 1, std::vector<double>(2), true));
+
+    tatami_test::throws_error([&]() {
+        tatami_mtx::TiledSparseMatrix<double, int>(2, 4, 0, 3, tiles);
+    }, "positive");
+    tatami_test::throws_error([&]() {
+        tatami_mtx::TiledSparseMatrix<double, int>(4, 4, 2, 3, tiles);
+    }, "number of tiles");
+    tatami_test::throws_error([&]() {
+        tatami_mtx::TiledSparseMatrix<double, int>(2, 5, 2, 3, tiles);
+    }, "dimensions of tile (0, 1)");
+
+    tatami_mtx::TiledSparseMatrix<double, int> mat(2, 4, 2, 3, tiles);
+    EXPECT_FALSE(mat.is_sparse());
+    EXPECT_EQ(mat.num_tile_columns(), 2);
+
+    tatami_mtx::LoadMatrixOptions opt;
+    opt.tiled = true;
+    std::string contents = "%%MatrixMarket matrix array integer general\n1 1\n5\n";
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+    }, "coordinate format");
+
+    opt.tile_ncol = 0;
+    contents = "%%MatrixMarket matrix coordinate integer general\n1 1 1\n1 1 5\n";
+    tatami_test::throws_error([&]() {
+        tatami_mtx::load_matrix_from_text_buffer<double, int>(reinterpret_cast<const unsigned char*>(contents.data()), contents.size(), opt);
+    }, "positive");
+}
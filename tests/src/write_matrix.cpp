@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include <numeric>
 
 TEST(WriteConvert, Integer) {
     std::vector<char> buffer(1);
@@ -69,6 +70,44 @@ TEST(WriteConvert, Float) {
     }
 }
 
+TEST(WriteIndexDictionary, Basic) {
+    for (unsigned long long limit : { 0, 5, 100, 65536 }) {
+        const int max_index = 123456;
+        tatami_mtx::internal::IndexDictionary<int> dict(max_index, limit);
+
+        byteme::RawBufferWriter writer({});
+        {
+            byteme::SerialBufferedWriter<char, byteme::Writer*> bufwriter(&writer, 100);
+            for (int i = 0; i < max_index; ++i) {
+                dict.write(bufwriter, i);
+                bufwriter.write('\n');
+            }
+            bufwriter.flush();
+        }
+
+        const auto& output = writer.get_output();
+        std::string expected;
+        for (int i = 0; i < max_index; ++i) {
+            expected += std::to_string(i + 1);
+            expected += '\n';
+        }
+        EXPECT_EQ(std::string(output.begin(), output.end()), expected);
+    }
+}
+
+TEST(WriteMatrix, LargeIndices) {
+    // Checking that the split formatting of large indices is correct.
+    const int NR = 3, NC = 200000;
+    std::vector<double> values { 1, 2, 3, 4, 5 };
+    std::vector<int> indices { 0, 9999, 10000, 99999, 199999 };
+    std::vector<std::size_t> indptr { 0, 2, 2, 5 };
+    tatami::CompressedSparseMatrix<double, int, std::vector<double>, std::vector<int>, std::vector<std::size_t> > mat(NR, NC, values, indices, indptr, true);
+
+    auto buf = tatami_mtx::write_matrix_to_text_buffer(mat, {});
+    std::string contents(buf.begin(), buf.end());
+    EXPECT_EQ(contents, "%%MatrixMarket matrix coordinate real general\n3\t200000\t5\n1\t1\t1\n1\t10000\t2\n3\t10001\t3\n3\t100000\t4\n3\t200000\t5\n");
+}
+
 TEST(WriteMatrix, DenseArray) {
     const int NR = 40, NC = 25;
     auto vec = tatami_test::simulate_vector<double>(NR * NC, {});
@@ -101,6 +140,40 @@ TEST(WriteMatrix, DenseArray) {
     }
 }
 
+TEST(WriteMatrix, DenseArrayBlocked) {
+    const int NR = 77, NC = 53;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, {});
+
+    for (int i = 0; i < 2; ++i) {
+        tatami::DenseMatrix<double, int, std::vector<double> > mat(NR, NC, vec, /* row_major = */ i == 0);
+
+        // Forcing multiple blocks of columns, including a final partial block.
+        for (std::size_t bufsize : { 0, 200, 1000, 100000 }) {
+            auto buf = tatami_mtx::write_matrix_to_text_buffer(mat, [&]{
+                tatami_mtx::WriteMatrixOptions opt;
+                opt.transpose_buffer_size = bufsize;
+                return opt;
+            }());
+
+            auto reloaded = tatami_mtx::load_matrix_from_text_buffer<double, int>(buf.data(), buf.size(), {});
+            EXPECT_FALSE(reloaded->is_sparse());
+            EXPECT_EQ(reloaded->nrow(), NR);
+            EXPECT_EQ(reloaded->ncol(), NC);
+
+            auto ext = reloaded->dense_row();
+            auto refext = mat.dense_row();
+            std::vector<double> buffer(NC), refbuffer(NC);
+            for (int r = 0; r < NR; ++r) {
+                auto ptr = ext->fetch(r, buffer.data());
+                auto refptr = refext->fetch(r, refbuffer.data());
+                for (int c = 0; c < NC; ++c) {
+                    EXPECT_FLOAT_EQ(ptr[c], refptr[c]);
+                }
+            }
+        }
+    }
+}
+
 class WriteMatrixCoordinateTest : public ::testing::TestWithParam<int> {};
 
 TEST_P(WriteMatrixCoordinateTest, Dense) {
@@ -193,6 +266,55 @@ TEST_P(WriteMatrixCoordinateTest, Sparse) {
     }
 }
 
+TEST_P(WriteMatrixCoordinateTest, DenseSkipZeros) {
+    const int NR = 40, NC = 25;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(NR, NC, vec, true);
+
+    const auto scenario = GetParam(); // 0 = automatic, 1 = by column, 2 = by row.
+    auto path = temp_file_path("tatami_mtx-test-write_matrix");
+    tatami_mtx::write_matrix_to_text_file(mat, path.c_str(), [&](){
+        tatami_mtx::WriteMatrixOptions opt;
+        opt.coordinate = true;
+        opt.skip_zeros = true;
+        opt.num_threads = 2;
+        if (scenario) {
+            opt.by_row = (scenario == 2);
+        }
+        return opt;
+    }());
+
+    { 
+        byteme::RawFileReader reader(path.c_str(), {});
+        eminem::Parser<decltype(&reader), int> parser(&reader, {});
+        parser.scan_preamble();
+        eminem::LineIndex expected = 0;
+        for (auto v : vec) {
+            expected += (v != 0);
+        }
+        EXPECT_EQ(parser.get_nlines(), expected);
+        EXPECT_LT(parser.get_nlines(), vec.size());
+    }
+
+    auto reloaded = tatami_mtx::load_matrix_from_text_file<double, int>(path.c_str(), {});
+    EXPECT_TRUE(reloaded->is_sparse());
+    EXPECT_EQ(reloaded->nrow(), NR);
+    EXPECT_EQ(reloaded->ncol(), NC);
+
+    auto ext = reloaded->dense_row();
+    std::vector<double> buffer(NC);
+    for (int r = 0; r < NR; ++r) {
+        auto ptr = ext->fetch(r, buffer.data());
+        for (int c = 0; c < NC; ++c) {
+            EXPECT_FLOAT_EQ(ptr[c], vec[sanisizer::nd_offset<std::size_t>(c, NC, r)]);
+        }
+    }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     WriteMatrix,
     WriteMatrixCoordinateTest,
@@ -243,6 +365,364 @@ TEST(WriteMatrix, SparseParallel) {
     }
 }
 
+class WriteMatrixSymmetricTest : public ::testing::TestWithParam<std::tuple<bool, int> > {
+protected:
+    static std::vector<double> simulate_symmetric(int N) {
+        auto vec = tatami_test::simulate_vector<double>(N * N, [&]{
+            tatami_test::SimulateVectorOptions opt;
+            opt.density = 0.2;
+            return opt;
+        }());
+        for (int r = 0; r < N; ++r) {
+            for (int c = 0; c < r; ++c) {
+                vec[sanisizer::nd_offset<std::size_t>(c, N, r)] = vec[sanisizer::nd_offset<std::size_t>(r, N, c)];
+            }
+        }
+        return vec;
+    }
+};
+
+TEST_P(WriteMatrixSymmetricTest, Basic) {
+    auto param = GetParam();
+    const bool sparse = std::get<0>(param);
+    const auto scenario = std::get<1>(param); // 0 = automatic, 1 = by column, 2 = by row.
+
+    const int N = 50;
+    auto vec = simulate_symmetric(N);
+    std::shared_ptr<tatami::Matrix<double, int> > mat(new tatami::DenseMatrix<double, int, std::vector<double> >(N, N, vec, true));
+    if (sparse) {
+        mat = tatami::convert_to_compressed_sparse<double, int>(*mat, false, {});
+    }
+
+    eminem::LineIndex expected_lower = 0;
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c <= r; ++c) {
+            expected_lower += (vec[sanisizer::nd_offset<std::size_t>(c, N, r)] != 0);
+        }
+    }
+
+    for (int detect = 0; detect < 2; ++detect) {
+        auto buf = tatami_mtx::write_matrix_to_text_buffer(*mat, [&]{
+            tatami_mtx::WriteMatrixOptions opt;
+            opt.coordinate = true;
+            opt.skip_zeros = true;
+            opt.num_threads = 3;
+            if (detect) {
+                opt.symmetric.reset();
+            } else {
+                opt.symmetric = true;
+            }
+            if (scenario) {
+                opt.by_row = (scenario == 2);
+            }
+            return opt;
+        }());
+
+        {
+            byteme::RawBufferReader reader(buf.data(), buf.size());
+            eminem::Parser<decltype(&reader), int> parser(&reader, {});
+            parser.scan_preamble();
+            EXPECT_EQ(parser.get_banner().symmetry, eminem::Symmetry::SYMMETRIC);
+            EXPECT_EQ(parser.get_nlines(), expected_lower);
+        }
+
+        auto reloaded = tatami_mtx::load_matrix_from_text_buffer<double, int>(buf.data(), buf.size(), {});
+        tatami_test::test_simple_row_access(*reloaded, *mat);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    WriteMatrix,
+    WriteMatrixSymmetricTest,
+    ::testing::Combine(
+        ::testing::Values(false, true), // sparse or not.
+        ::testing::Values(0, 1, 2) // 0 = automatic, 1 = by column, 2 = by row.
+    )
+);
+
+TEST(WriteMatrix, SymmetricDetection) {
+    const int N = 20;
+    auto vec = tatami_test::simulate_vector<double>(N * N, {});
+
+    {
+        tatami::DenseMatrix<double, int, std::vector<double> > mat(N, N, vec, true);
+        EXPECT_FALSE(tatami_mtx::internal::is_symmetric(mat, 2));
+        auto sparse = tatami::convert_to_compressed_sparse<double, int>(mat, true, {});
+        EXPECT_FALSE(tatami_mtx::internal::is_symmetric(*sparse, 2));
+    }
+
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < r; ++c) {
+            vec[sanisizer::nd_offset<std::size_t>(c, N, r)] = vec[sanisizer::nd_offset<std::size_t>(r, N, c)];
+        }
+    }
+
+    {
+        tatami::DenseMatrix<double, int, std::vector<double> > mat(N, N, vec, true);
+        EXPECT_TRUE(tatami_mtx::internal::is_symmetric(mat, 2));
+        auto sparse = tatami::convert_to_compressed_sparse<double, int>(mat, true, {});
+        EXPECT_TRUE(tatami_mtx::internal::is_symmetric(*sparse, 2));
+
+        // Dense array format ignores the symmetry.
+        auto buf = tatami_mtx::write_matrix_to_text_buffer(mat, [&]{
+            tatami_mtx::WriteMatrixOptions opt;
+            opt.symmetric.reset();
+            return opt;
+        }());
+        std::string header(buf.begin(), buf.begin() + 47);
+        EXPECT_EQ(header, "%%MatrixMarket matrix array real general\n20\t20\n");
+    }
+
+    {
+        tatami::DenseMatrix<double, int, std::vector<double> > mat(N, N - 1, std::vector<double>(N * (N - 1)), true);
+        EXPECT_FALSE(tatami_mtx::internal::is_symmetric(mat, 2));
+        tatami_test::throws_error([&]() {
+            tatami_mtx::write_matrix_to_text_buffer(mat, [&]{
+                tatami_mtx::WriteMatrixOptions opt;
+                opt.coordinate = true;
+                opt.symmetric = true;
+                return opt;
+            }());
+        }, "square");
+    }
+}
+
+TEST(WriteMatrix, Pattern) {
+    const int NR = 30, NC = 40;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.1;
+        return opt;
+    }());
+    for (auto& v : vec) {
+        if (v) {
+            v = 1;
+        }
+    }
+
+    tatami::DenseMatrix<double, int, std::vector<double> > dense(NR, NC, vec, true);
+    auto sparse = tatami::convert_to_compressed_sparse<double, int>(dense, false, {});
+
+    for (int s = 0; s < 2; ++s) {
+        const tatami::Matrix<double, int>& mat = (s ? static_cast<const tatami::Matrix<double, int>&>(*sparse) : dense);
+        for (int mode = 0; mode < 2; ++mode) {
+            auto buf = tatami_mtx::write_matrix_to_text_buffer(mat, [&]{
+                tatami_mtx::WriteMatrixOptions opt;
+                opt.coordinate = true;
+                opt.skip_zeros = true;
+                if (mode) {
+                    opt.pattern = true;
+                } else {
+                    opt.pattern.reset();
+                }
+                return opt;
+            }());
+
+            std::string header(buf.begin(), buf.begin() + 49);
+            EXPECT_EQ(header, "%%MatrixMarket matrix coordinate pattern general\n");
+
+            auto reloaded = tatami_mtx::load_matrix_from_text_buffer<double, int>(buf.data(), buf.size(), {});
+            tatami_test::test_simple_row_access(*reloaded, dense);
+            tatami_test::test_simple_column_access(*reloaded, dense);
+        }
+    }
+
+    // Detection fails if any value is not 1.
+    vec[0] = 2;
+    tatami::DenseMatrix<double, int, std::vector<double> > dense2(NR, NC, vec, true);
+    auto sparse2 = tatami::convert_to_compressed_sparse<double, int>(dense2, true, {});
+    for (int s = 0; s < 2; ++s) {
+        const tatami::Matrix<double, int>& mat = (s ? static_cast<const tatami::Matrix<double, int>&>(*sparse2) : dense2);
+        auto buf = tatami_mtx::write_matrix_to_text_buffer(mat, [&]{
+            tatami_mtx::WriteMatrixOptions opt;
+            opt.coordinate = true;
+            opt.skip_zeros = true;
+            opt.pattern.reset();
+            return opt;
+        }());
+        std::string header(buf.begin(), buf.begin() + 46);
+        EXPECT_EQ(header, "%%MatrixMarket matrix coordinate real general\n");
+    }
+}
+
+TEST(WriteMatrix, Prefetch) {
+    const int NR = 53, NC = 38;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+
+    tatami::DenseMatrix<double, int, std::vector<double> > dense(NR, NC, vec, false);
+    auto sparse_row = tatami::convert_to_compressed_sparse<double, int>(dense, true, {});
+    auto sparse_col = tatami::convert_to_compressed_sparse<double, int>(dense, false, {});
+    std::vector<const tatami::Matrix<double, int>*> matrices { &dense, sparse_row.get(), sparse_col.get() };
+
+    for (auto mat : matrices) {
+        for (int coordinate = 0; coordinate < 2; ++coordinate) {
+            for (int by_row = 0; by_row < 2; ++by_row) {
+                tatami_mtx::WriteMatrixOptions opt;
+                opt.coordinate = coordinate;
+                opt.by_row = by_row;
+                auto ref = tatami_mtx::write_matrix_to_text_buffer(*mat, opt);
+
+                opt.prefetch = 1;
+                opt.prefetch_block_size = 1;
+                EXPECT_EQ(ref, tatami_mtx::write_matrix_to_text_buffer(*mat, opt));
+
+                opt.prefetch = 3;
+                opt.prefetch_block_size = 7;
+                EXPECT_EQ(ref, tatami_mtx::write_matrix_to_text_buffer(*mat, opt));
+
+                opt.prefetch = 2;
+                opt.prefetch_block_size = 1000;
+                EXPECT_EQ(ref, tatami_mtx::write_matrix_to_text_buffer(*mat, opt));
+            }
+        }
+    }
+}
+
+class WriteMatrixSubsetTest : public ::testing::TestWithParam<std::tuple<int, bool, bool, int> > {};
+
+TEST_P(WriteMatrixSubsetTest, Basic) {
+    const auto& params = GetParam();
+    const int mode = std::get<0>(params);
+    const bool coordinate = std::get<1>(params);
+    const bool by_row = std::get<2>(params);
+    const int prefetch = std::get<3>(params);
+
+    const int NR = 47, NC = 36;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+    tatami::DenseMatrix<double, int, std::vector<double> > dense(NR, NC, vec, true);
+    std::shared_ptr<tatami::Matrix<double, int> > mat;
+    if (mode == 0) {
+        mat.reset(new tatami::DenseMatrix<double, int, std::vector<double> >(NR, NC, vec, true));
+    } else {
+        mat = tatami::convert_to_compressed_sparse<double, int>(dense, mode == 1, {});
+    }
+
+    std::vector<std::size_t> row_sub, col_sub;
+    for (int r = 1; r < NR; r += 3) {
+        row_sub.push_back(r);
+    }
+    for (int c = 0; c < NC; c += 2) {
+        col_sub.push_back(c);
+    }
+
+    for (int choice = 0; choice < 3; ++choice) {
+        tatami_mtx::WriteMatrixOptions opt;
+        opt.coordinate = coordinate;
+        opt.by_row = by_row;
+        opt.prefetch = prefetch;
+        opt.transpose_buffer_size = 50;
+        if (choice != 1) {
+            opt.row_subset = row_sub;
+        }
+        if (choice != 0) {
+            opt.column_subset = col_sub;
+        }
+        auto buf = tatami_mtx::write_matrix_to_text_buffer(*mat, opt);
+
+        std::vector<int> rows, cols;
+        if (opt.row_subset.has_value()) {
+            rows.insert(rows.end(), row_sub.begin(), row_sub.end());
+        } else {
+            rows.resize(NR);
+            std::iota(rows.begin(), rows.end(), 0);
+        }
+        if (opt.column_subset.has_value()) {
+            cols.insert(cols.end(), col_sub.begin(), col_sub.end());
+        } else {
+            cols.resize(NC);
+            std::iota(cols.begin(), cols.end(), 0);
+        }
+
+        std::vector<double> expected;
+        for (auto r : rows) {
+            for (auto c : cols) {
+                expected.push_back(vec[sanisizer::nd_offset<std::size_t>(c, NC, r)]);
+            }
+        }
+        tatami::DenseMatrix<double, int, std::vector<double> > ref(rows.size(), cols.size(), std::move(expected), true);
+
+        auto reloaded = tatami_mtx::load_matrix_from_text_buffer<double, int>(buf.data(), buf.size(), {});
+        EXPECT_EQ(reloaded->nrow(), static_cast<int>(rows.size()));
+        EXPECT_EQ(reloaded->ncol(), static_cast<int>(cols.size()));
+        tatami_test::test_simple_row_access(*reloaded, ref);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    WriteMatrix,
+    WriteMatrixSubsetTest,
+    ::testing::Combine(
+        ::testing::Values(0, 1, 2), // dense, sparse row, sparse column
+        ::testing::Values(false, true), // coordinate
+        ::testing::Values(false, true), // by row
+        ::testing::Values(0, 2) // prefetch
+    )
+);
+
+TEST(WriteMatrix, SubsetSymmetric) {
+    const int N = 20;
+    auto vec = tatami_test::simulate_vector<double>(N * N, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.3;
+        return opt;
+    }());
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < r; ++c) {
+            vec[sanisizer::nd_offset<std::size_t>(c, N, r)] = vec[sanisizer::nd_offset<std::size_t>(r, N, c)];
+        }
+    }
+    tatami::DenseMatrix<double, int, std::vector<double> > dense(N, N, vec, true);
+    auto sparse = tatami::convert_to_compressed_sparse<double, int>(dense, true, {});
+
+    std::vector<std::size_t> sub { 0, 3, 4, 9, 15, 19 };
+    std::vector<double> expected;
+    for (auto r : sub) {
+        for (auto c : sub) {
+            expected.push_back(vec[sanisizer::nd_offset<std::size_t>(c, N, r)]);
+        }
+    }
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(sub.size(), sub.size(), std::move(expected), true);
+
+    tatami_mtx::WriteMatrixOptions opt;
+    opt.symmetric = true;
+    opt.row_subset = sub;
+    opt.column_subset = sub;
+    auto buf = tatami_mtx::write_matrix_to_text_buffer(*sparse, opt);
+    std::string header(buf.begin(), buf.begin() + 48);
+    EXPECT_EQ(header, "%%MatrixMarket matrix coordinate real symmetric\n");
+    auto reloaded = tatami_mtx::load_matrix_from_text_buffer<double, int>(buf.data(), buf.size(), {});
+    tatami_test::test_simple_row_access(*reloaded, ref);
+
+    opt.column_subset = std::vector<std::size_t>{ 1, 3, 4, 9, 15, 19 };
+    tatami_test::throws_error([&]() {
+        tatami_mtx::write_matrix_to_text_buffer(*sparse, opt);
+    }, "should be the same");
+}
+
+TEST(WriteMatrix, SubsetErrors) {
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(5, 4, std::vector<double>(20), true);
+
+    tatami_test::throws_error([&]() {
+        tatami_mtx::WriteMatrixOptions opt;
+        opt.row_subset = std::vector<std::size_t>{ 1, 5 };
+        tatami_mtx::write_matrix_to_text_buffer(mat, opt);
+    }, "out-of-range");
+
+    tatami_test::throws_error([&]() {
+        tatami_mtx::WriteMatrixOptions opt;
+        opt.column_subset = std::vector<std::size_t>{ 2, 2 };
+        tatami_mtx::write_matrix_to_text_buffer(mat, opt);
+    }, "sorted and unique");
+}
+
 TEST(WriteMatrix, EmptyCoordinate) {
     for (int i = 0; i < 2; ++i) {
         const auto current_nrow = (i == 0 ? 10 : 0);
@@ -377,3 +857,127 @@ TEST(WriteMatrix, ZlibBuffer) {
         }
     }
 }
+
+TEST(MatrixMarketStreamWriter, Basic) {
+    const int NR = 57, NC = 32;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(NR, NC, vec, true);
+
+    for (int by_row = 0; by_row < 2; ++by_row) {
+        auto path = temp_file_path("tatami_mtx-test-write_matrix");
+        tatami_mtx::MatrixMarketStreamWriter<double, int> stream(path.c_str(), NR, NC, {});
+
+        const int primary = (by_row ? NR : NC), secondary = (by_row ? NC : NR);
+        auto ext = tatami::consecutive_extractor<true>(ref, static_cast<bool>(by_row), 0, primary);
+        std::vector<double> vbuffer(secondary);
+        std::vector<int> ibuffer(secondary);
+        for (int p = 0; p < primary; ++p) {
+            auto range = ext->fetch(vbuffer.data(), ibuffer.data());
+            if (by_row) {
+                stream.append_row(range.value, range.index, range.number);
+            } else {
+                stream.append_column(range.value, range.index, range.number);
+            }
+        }
+        stream.finish();
+
+        auto reloaded = tatami_mtx::load_matrix_from_text_file<double, int>(path.c_str(), {});
+        EXPECT_TRUE(reloaded->sparse());
+        tatami_test::test_simple_row_access(*reloaded, ref);
+        tatami_test::test_simple_column_access(*reloaded, ref);
+    }
+}
+
+TEST(MatrixMarketStreamWriter, Partial) {
+    auto path = temp_file_path("tatami_mtx-test-write_matrix");
+    tatami_mtx::MatrixMarketStreamWriter<int, int> stream(path.c_str(), 5, 3, [&]{
+        tatami_mtx::WriteMatrixOptions opt;
+        opt.skip_zeros = true;
+        return opt;
+    }());
+
+    std::vector<int> vals { 5, 0, 2 };
+    std::vector<int> idx { 0, 2, 4 };
+    stream.append_column(vals.data(), idx.data(), 3);
+    stream.append_column(vals.data(), idx.data(), 0);
+    EXPECT_EQ(stream.num_written(), 2);
+
+    tatami_test::throws_error([&]() {
+        stream.append_row(vals.data(), idx.data(), 3);
+    }, "after appending columns");
+    tatami_test::throws_error([&]() {
+        std::vector<int> bad { 5 };
+        stream.append_column(vals.data(), bad.data(), 1);
+    }, "out of range");
+
+    stream.finish();
+    tatami_test::throws_error([&]() {
+        stream.finish();
+    }, "finished");
+
+    auto reloaded = tatami_mtx::load_matrix_from_text_file<double, int>(path.c_str(), {});
+    std::vector<double> expected { 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0 };
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(5, 3, expected, true);
+    tatami_test::test_simple_row_access(*reloaded, ref);
+
+    byteme::RawFileReader reader(path.c_str(), {});
+    eminem::Parser<decltype(&reader), int> parser(&reader, {});
+    parser.scan_preamble();
+    EXPECT_EQ(parser.get_banner().field, eminem::Field::INTEGER);
+    EXPECT_EQ(parser.get_nlines(), 2);
+}
+
+TEST(MatrixMarketStreamWriter, Pattern) {
+    auto path = temp_file_path("tatami_mtx-test-write_matrix");
+    tatami_mtx::MatrixMarketStreamWriter<double, int> stream(path.c_str(), 3, 4, [&]{
+        tatami_mtx::WriteMatrixOptions opt;
+        opt.pattern = true;
+        return opt;
+    }());
+
+    std::vector<int> idx { 1, 3 };
+    stream.append_row(NULL, idx.data(), 2);
+    stream.append_row(NULL, idx.data(), 1);
+    stream.finish();
+
+    auto reloaded = tatami_mtx::load_matrix_from_text_file<double, int>(path.c_str(), {});
+    std::vector<double> expected { 0, 1, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0 };
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(3, 4, expected, true);
+    tatami_test::test_simple_row_access(*reloaded, ref);
+}
+
+TEST(MatrixMarketStreamWriter, Unfinished) {
+    auto path = temp_file_path("tatami_mtx-test-write_matrix");
+    {
+        tatami_mtx::MatrixMarketStreamWriter<int, int> stream(path.c_str(), 4, 3, [&]{
+            tatami_mtx::WriteMatrixOptions opt;
+            opt.skip_zeros = true;
+            return opt;
+        }());
+
+        std::vector<int> vals { 1, 0, 3 };
+        std::vector<int> idx { 0, 1, 3 };
+        stream.append_column(vals.data(), idx.data(), 3);
+
+        // Indices are validated even if the values would be skipped.
+        tatami_test::throws_error([&]() {
+            std::vector<int> bad { 4 };
+            stream.append_column(vals.data() + 1, bad.data(), 1);
+        }, "out of range");
+    }
+
+    // Destructor fills in the header, even without an explicit finish().
+    auto reloaded = tatami_mtx::load_matrix_from_text_file<double, int>(path.c_str(), {});
+    std::vector<double> expected { 1, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0 };
+    tatami::DenseMatrix<double, int, std::vector<double> > ref(4, 3, expected, true);
+    tatami_test::test_simple_row_access(*reloaded, ref);
+
+    byteme::RawFileReader reader(path.c_str(), {});
+    eminem::Parser<decltype(&reader), int> parser(&reader, {});
+    parser.scan_preamble();
+    EXPECT_EQ(parser.get_nlines(), 2);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "tatami_test/tatami_test.hpp"
+
+#include "tatami_mtx/load_matrix.hpp"
+#include "tatami_mtx/write_matrix_sharded.hpp"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+class WriteMatrixShardedTest : public ::testing::TestWithParam<std::tuple<bool, int, bool, int> > {};
+
+TEST_P(WriteMatrixShardedTest, Basic) {
+    const auto& params = GetParam();
+    const bool by_row = std::get<0>(params);
+    const int num_shards = std::get<1>(params);
+    const bool gzip = std::get<2>(params);
+    const int num_threads = std::get<3>(params);
+
+    const int NR = 31, NC = 17;
+    auto vec = tatami_test::simulate_vector<double>(NR * NC, [&]{
+        tatami_test::SimulateVectorOptions opt;
+        opt.density = 0.2;
+        return opt;
+    }());
+    tatami::DenseMatrix<double, int, std::vector<double> > dense(NR, NC, std::move(vec), true);
+    auto ref = tatami::convert_to_compressed_sparse<double, int>(dense, !by_row, {});
+
+    auto prefix = temp_file_path("tatami_mtx-test-write_matrix_sharded");
+    auto manifest = tatami_mtx::write_matrix_sharded(*ref, prefix, [&]{
+        tatami_mtx::WriteMatrixShardedOptions opt;
+        opt.num_shards = num_shards;
+        opt.by_row = by_row;
+        opt.gzip = gzip;
+        opt.num_threads = num_threads;
+        return opt;
+    }());
+
+    EXPECT_EQ(manifest.nrow, NR);
+    EXPECT_EQ(manifest.ncol, NC);
+    EXPECT_EQ(manifest.by_row, by_row);
+    EXPECT_EQ(manifest.boundaries.size(), static_cast<std::size_t>(num_shards + 1));
+    EXPECT_EQ(manifest.boundaries.back(), by_row ? NR : NC);
+
+    auto reread = tatami_mtx::read_shard_manifest<int>(prefix + ".manifest");
+    EXPECT_EQ(reread.nrow, NR);
+    EXPECT_EQ(reread.ncol, NC);
+    EXPECT_EQ(reread.by_row, by_row);
+    EXPECT_EQ(reread.boundaries, manifest.boundaries);
+    EXPECT_EQ(reread.paths, manifest.paths);
+
+    std::shared_ptr<const tatami::Matrix<double, int> > cref(ref);
+    for (int s = 0; s < num_shards; ++s) {
+        const int start = manifest.boundaries[s], length = manifest.boundaries[s + 1] - start;
+        tatami::DelayedSubsetBlock<double, int> expected(cref, start, length, by_row);
+
+        std::shared_ptr<tatami::Matrix<double, int> > loaded;
+        if (gzip) {
+            loaded = tatami_mtx::load_matrix_from_gzip_file<double, int>(manifest.paths[s].c_str(), {});
+        } else {
+            loaded = tatami_mtx::load_matrix_from_text_file<double, int>(manifest.paths[s].c_str(), {});
+        }
+        EXPECT_EQ(loaded->nrow(), expected.nrow());
+        EXPECT_EQ(loaded->ncol(), expected.ncol());
+        if (length) {
+            tatami_test::test_simple_row_access(*loaded, expected);
+            tatami_test::test_simple_column_access(*loaded, expected);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    WriteMatrixSharded,
+    WriteMatrixShardedTest,
+    ::testing::Combine(
+        ::testing::Values(true, false), // by row
+        ::testing::Values(1, 4, 40), // number of shards
+        ::testing::Values(false, true), // gzip
+        ::testing::Values(1, 3) // number of threads
+    )
+);
+
+TEST(WriteMatrixSharded, Errors) {
+    tatami::DenseMatrix<double, int, std::vector<double> > mat(5, 5, std::vector<double>(25), true);
+    auto prefix = temp_file_path("tatami_mtx-test-write_matrix_sharded");
+    tatami_test::throws_error([&]() {
+        tatami_mtx::write_matrix_sharded(mat, prefix, [&]{
+            tatami_mtx::WriteMatrixShardedOptions opt;
+            opt.num_shards = 0;
+            return opt;
+        }());
+    }, "positive");
+
+    tatami_test::throws_error([&]() {
+        tatami_mtx::read_shard_manifest<int>(prefix + ".manifest");
+    }, "failed to open");
+}